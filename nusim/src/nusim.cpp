@@ -1,39 +1,74 @@
 /// \file nusim.cpp
 /// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
-/// \brief This node simulates the turtlebot in a world
+/// \brief This node simulates a fleet of turtlebots in a world
 ///
 /// PUBLISHERS:
 ///     ~/timestep: [std_msgs/msg/UInt64]                 Current timestep
 ///     ~/walls:    [visualization_msgs/msg/MarkerArray]  Wall markers
 ///     ~/obstacles: [visualization_msgs/msg/MarkerArray] Obstacle markers
+///     ~/map:      [nav_msgs/msg/OccupancyGrid]          The occupancy map of the world
+///     /clock:     [rosgraph_msgs/msg/Clock]             The simulated time, in headless mode only
+///     <robot>/sensor_data: [nuturtlebot_msgs/msg/SensorData] Wheel encoders of every robot
+///     scan:       [sensor_msgs/msg/LaserScan]           Lidar scan, <robot>/scan for a fleet
+///     obs_pos:    [nuturtle_interfaces/msg/ObstacleMeasurements] Fake sensor, <robot>/obs_pos
+///                                                       for a fleet
+///     ~/timer_stats: [nuturtle_interfaces/msg/TimerStats] Jitter and overruns of the timers
+///
+/// SUBSCRIBERS:
+///     <robot>/wheel_cmd: [nuturtlebot_msgs/msg/WheelCommands] Wheel commands of every robot
 ///
 /// SERVICES:
 ///     ~/reset:    [std_srvs/srv/Empty] Reset the turtlebot
-///     ~/teleport: [nusim/srv/Teleport] Teleport the turtlebot
+///     ~/teleport: [nusim/srv/Teleport] Teleport the first turtlebot
+///     ~/step:     [nuturtle_interfaces/srv/Step] Advance a lock-step simulation by some ticks
 ///
 /// PARAMETERS:
 ///     \param rate                   (double)    The rate of the simulator
-///     \param x0                     (double)    Tnitial x value
-///     \param y0                     (double)    Initial y value
-///     \param theta0                 (double)    Initial theta value
+///     \param x0                     (double)    Initial x value without robots/x0
+///     \param y0                     (double)    Initial y value without robots/y0
+///     \param theta0                 (double)    Initial theta value without robots/theta0
 ///     \param arena_x_length         (double)    Length of arena in x direction
 ///     \param arena_y_length         (double)    Length of arena in y direction
+///     \param walls/x1               (double[])  Start x coordinates of the walls, the arena if empty
+///     \param walls/y1               (double[])  Start y coordinates of the walls
+///     \param walls/x2               (double[])  End x coordinates of the walls
+///     \param walls/y2               (double[])  End y coordinates of the walls
+///     \param map_yaml               (string)    map_server YAML of an occupancy map, none if empty
 ///     \param obstacles/x            (double[])  X coordinates of obstacles
 ///     \param obstacles/y            (double[])  Y coordinates of obstacles
 ///     \param obstacles/r            (double)    Radius of obstacles
+///     \param obstacles/cell_size    (double)    Cell size of the obstacle grid index
 ///     \param wheel_radius           (double)    Radius of the wheel
 ///     \param track_width            (double)    Distance between two wheels
 ///     \param motor_cmd_max          (int)       Maximum motor command velocity
 ///     \param motor_cmd_per_rad_sec  (double)    motor command per rad/s
 ///     \param encoder_ticks_per_rad  (double)    Encoder ticks per radian of rotation
+///     \param headless               (bool)      Run on simulated time published on /clock
+///     \param speedup                (double)    Simulated seconds per wall second when headless,
+///                                               as fast as possible if 0
+///     \param lockstep               (bool)      Advance only on ~/step, on simulated time
+///     \param step/ack_topics        (string[])  Topics that answer every tick of ~/step
+///     \param step/sensor_ack_topics (string[])  Topics that answer the ticks publishing sensors
+///     \param step/ack_timeout       (double)    Longest wait for the answers to a tick in seconds
+///     \param robots/names           (string[])  Names of the simulated robots
+///     \param robots/x0              (double[])  Starting x coordinates of the robots, x0 if empty
+///     \param robots/y0              (double[])  Starting y coordinates of the robots, y0 if empty
+///     \param robots/theta0          (double[])  Starting headings of the robots, theta0 if empty
+///     \param lidar_threads          (int)       Threads casting the lidars besides the timer
+///     \param seed                   (int)       Seed of the noise
 ///
 /// \version 0.1
 /// \date 2024-01-22
 ///
 /// \copyright Copyright (c) 2024
+#include <algorithm>
 #include <chrono>
-#include <random>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <iterator>
 #include <limits>
+#include <memory>
 
 #include <rclcpp/rclcpp.hpp>
 #include <tf2_ros/transform_broadcaster.h>
@@ -45,17 +80,27 @@
 #include <visualization_msgs/msg/marker_array.hpp>
 #include <visualization_msgs/msg/marker.hpp>
 #include <nav_msgs/msg/path.hpp>
+#include <nav_msgs/msg/occupancy_grid.hpp>
 #include <sensor_msgs/msg/laser_scan.hpp>
+#include <rosgraph_msgs/msg/clock.hpp>
 #include "nuturtlebot_msgs/msg/wheel_commands.hpp"
 #include "nuturtlebot_msgs/msg/sensor_data.hpp"
 
 #include <std_srvs/srv/empty.hpp>
 #include "nuturtle_interfaces/srv/teleport.hpp"
+#include "nuturtle_interfaces/srv/step.hpp"
 #include "nuturtle_interfaces/msg/obstacle_measurements.hpp"
 #include "nuturtle_interfaces/msg/measurement.hpp"
+#include "nuturtle_interfaces/msg/timer_stats.hpp"
 
-#include "turtlelib/diff_drive.hpp"
+#include "turtlelib/mailbox.hpp"
+#include "turtlelib/worker_pool.hpp"
+#include "turtlelib/world_sim.hpp"
 #include "turtlelib/trig2d.hpp"
+#include "turtlelib/obstacle_grid.hpp"
+#include "turtlelib/segment_bvh.hpp"
+#include "turtlelib/occupancy_map.hpp"
+#include "turtlelib/distance_field.hpp"
 #include "turtlelib/se2d.hpp"
 
 
@@ -71,430 +116,428 @@ using geometry_msgs::msg::PoseStamped;
 using visualization_msgs::msg::Marker;
 using visualization_msgs::msg::MarkerArray;
 using nav_msgs::msg::Path;
+using nav_msgs::msg::OccupancyGrid;
 using sensor_msgs::msg::LaserScan;
+using rosgraph_msgs::msg::Clock;
 using nuturtlebot_msgs::msg::WheelCommands;
 using nuturtlebot_msgs::msg::SensorData;
 using nuturtle_interfaces::msg::Measurement;
 using nuturtle_interfaces::msg::ObstacleMeasurements;
+using nuturtle_interfaces::msg::TimerStats;
 
 /// services
 using std_srvs::srv::Empty;
 using nuturtle_interfaces::srv::Teleport;
-
-/// \brief The state of the wall
-enum WallState
-{
-  /// \brief The up side of the wall
-  NORTH,
-
-  /// \brief The down side of the wall
-  SOUTH,
-
-  /// \brief The left side of the wall
-  WEST,
-
-  /// \brief The right side of the wall
-  EAST
-};
+using nuturtle_interfaces::srv::Step;
 
 /// \brief Simulate the turtlebot in a rviz world.
 class NuSim : public Node
 {
 private:
-  /// \brief Timer callback funcrion of the nusim node, calls at every cycle
-  void timer_callback_()
+  /// \brief The robot states the sensors see, handed over by the steps
+  struct SensorSnapshot
   {
-    current_time_ = get_clock()->now();
+    /// \brief The time of the states
+    rclcpp::Time stamp;
 
-    if (!draw_only_) {
-      UInt64 msg_timestep;
-      msg_timestep.data = timestep_++;
-      pub_timestep_->publish(msg_timestep);
-
-      if (++count_ >= static_cast<int>(0.2 / period_)) {
-        generate_sensor_obs_pos_();
-        publish_laser_scan_();
-        // publish_obstacle_markers_();
-        publish_fake_sensor_();
-        count_ = 0;
+    /// \brief The states and the tick keying the noise
+    turtlelib::SimSnapshot sim;
+  };
+
+  /// \brief The timing of a timer callback over a report window of about one second
+  struct TimerTiming
+  {
+    /// \brief The name of the timer in the reports
+    std::string name;
+
+    /// \brief The nominal period in seconds, 0 when it fires as fast as possible
+    double period = 0.0;
+
+    /// \brief The start of the previous callback and of the report window
+    std::chrono::steady_clock::time_point last_start;
+    std::chrono::steady_clock::time_point window_start;
+
+    /// \brief The statistics of the window
+    uint64_t count = 0;
+    uint64_t overruns = 0;
+    uint64_t missed = 0;
+    double duration_sum = 0.0;
+    double max_duration = 0.0;
+    double max_jitter = 0.0;
+
+    /// \brief Record the start of a callback
+    /// \return The start time
+    std::chrono::steady_clock::time_point start()
+    {
+      const auto now = std::chrono::steady_clock::now();
+
+      /// The first callback has no interval yet
+      if (last_start == std::chrono::steady_clock::time_point{}) {
+        window_start = now;
+      } else {
+        const auto interval = std::chrono::duration<double>(now - last_start).count();
+        max_jitter = std::max(max_jitter, std::abs(interval - period));
+
+        if (period > 0.0 && interval > 1.5 * period) {
+          ++missed;
+        }
       }
 
-      update_turtlebot_pos_();
-      publish_sensor_data_();
-      publish_path_();
-      broadcast_tf_();
+      last_start = now;
+      return now;
     }
-  }
 
-  /// @brief Get the fake sensor scan data about obstacle positions
-  void generate_sensor_obs_pos_()
-  {
-    obstacle_pos_sensor_.clear();
+    /// \brief Record the end of a callback
+    /// \param start The start time of the callback
+    /// \return Whether the report window is over
+    bool stop(std::chrono::steady_clock::time_point start)
+    {
+      const auto now = std::chrono::steady_clock::now();
+      const auto duration = std::chrono::duration<double>(now - start).count();
 
-    for (size_t i = 0; i < obstacles_x_.size(); ++i) {
-      const auto obs_x = obstacles_x_.at(i) + distribution_sensor_(generator_);
-      const auto obs_y = obstacles_y_.at(i) + distribution_sensor_(generator_);
+      ++count;
+      duration_sum += duration;
+      max_duration = std::max(max_duration, duration);
 
-      turtlelib::Point2D obs_pos{obs_x, obs_y};
-      obstacle_pos_sensor_.push_back(obs_pos);
+      if (period > 0.0 && duration > period) {
+        ++overruns;
+      }
+
+      return now - window_start >= std::chrono::seconds(1);
     }
-  }
 
-  /// @brief Update the position of the turtlebot
-  void update_turtlebot_pos_()
-  {
-    double left_wheel_speed = wheel_cmd_.left_velocity * motor_cmd_per_rad_sec_;
-    double right_wheel_speed = wheel_cmd_.right_velocity * motor_cmd_per_rad_sec_;
-    /// ##### Generating gaussian noice
-    /// CITE: https://stackoverflow.com/questions/32889309/adding-gaussian-noise
-    const auto left_wheel_noice = distribution_input_(generator_);
-    const auto right_wheel_noice = distribution_input_(generator_);
-
-    RCLCPP_DEBUG_STREAM(get_logger(), "noice: " << left_wheel_noice);
-    if (
-      !turtlelib::almost_equal(left_wheel_speed, 0.0, 1e-2) ||
-      !turtlelib::almost_equal(right_wheel_speed, 0.0, 1e-2))
+    /// \brief Start the next report window
+    void clear()
     {
-      left_wheel_speed += left_wheel_noice;
-      right_wheel_speed += right_wheel_noice;
+      count = 0;
+      overruns = 0;
+      missed = 0;
+      duration_sum = 0.0;
+      max_duration = 0.0;
+      max_jitter = 0.0;
+      window_start = std::chrono::steady_clock::now();
     }
-    /// ##### END CITATION
-    const auto phi_left_new = turtlebot_.left_wheel() + left_wheel_speed * period_;
-    const auto phi_right_new = turtlebot_.right_wheel() + right_wheel_speed * period_;
-
-    const auto ita_left = distribution_slip_(generator_);
-    const auto ita_right = distribution_slip_(generator_);
+  };
 
-    const auto phi_left_slip = turtlebot_.left_wheel() + left_wheel_speed * period_ *
-      (1.0 + ita_left);
-    const auto phi_right_slip = turtlebot_.right_wheel() + right_wheel_speed * period_ *
-      (1.0 + ita_right);
+  /// \brief Timer callback funcrion of the nusim node, calls at every cycle
+  void timer_callback_()
+  {
+    const auto start = kinematics_timing_.start();
 
-    turtlebot_.compute_fk(phi_left_slip, phi_right_slip);
-    turtlebot_.update_wheel(phi_left_new, phi_right_new);
+    advance_clock_();
 
-    check_collision_(turtle_x_, turtle_y_);
+    if (!draw_only_) {
+      step_simulation_();
+    }
 
-    turtle_x_ = turtlebot_.config_x();
-    turtle_y_ = turtlebot_.config_y();
-    turtle_theta_ = turtlebot_.config_theta();
+    if (kinematics_timing_.stop(start)) {
+      publish_timer_stats_(kinematics_timing_);
+    }
   }
 
-  /// @brief Check if turtlebot has collided with one of the obstacles
-  /// @param pre_x previous x position
-  /// @param pre_y previous y position
-  void check_collision_(double pre_x, double pre_y)
+  /// \brief Timer callback of the sensors, running beside the steps in its own callback group
+  void sensor_timer_callback_()
   {
-    const auto robot_x = turtlebot_.config_x();
-    const auto robot_y = turtlebot_.config_y();
+    const auto start = sensor_timing_.start();
 
-    for (std::size_t i = 0; i < obstacles_x_.size(); ++i) {
-      const auto obs_x = obstacles_x_.at(i);
-      const auto obs_y = obstacles_y_.at(i);
-      const auto dist = sqrt(pow(obs_x - robot_x, 2.0) + pow(obs_y - robot_y, 2.0));
+    /// Without a newer snapshot, the sensors see the robots where they were last
+    auto snapshot = snapshots_.take();
+    if (snapshot) {
+      sensor_snapshot_ = std::move(snapshot);
+    }
 
-      if (dist < collision_radius_ + obstacle_radius_) {
-        const auto dx = obs_x - robot_x;
-        const auto dy = obs_y - robot_y;
+    if (sensor_snapshot_) {
+      publish_sensors_(*sensor_snapshot_);
+    }
 
-        const auto theta_new = atan2(dy, dx);
-        turtlebot_.update_config(pre_x, pre_y, theta_new);
-        break;
-      }
+    if (sensor_timing_.stop(start)) {
+      publish_timer_stats_(sensor_timing_);
     }
   }
 
-  /// @brief broadcast the transform
-  void broadcast_tf_()
+  /// \brief Set current_time_ for the next step, publishing the simulated time when headless
+  void advance_clock_()
   {
-    TransformStamped tf;
-    tf.header.stamp = current_time_;
-    tf.header.frame_id = world_frame_id_;
-    tf.child_frame_id = body_frame_id_;
-
-    tf.transform.translation.x = turtle_x_;
-    tf.transform.translation.y = turtle_y_;
-    tf.transform.translation.z = 0.0;
-
-    tf.transform.rotation.x = 0.0;
-    tf.transform.rotation.y = 0.0;
-    tf.transform.rotation.z = sin(turtle_theta_ / 2.0);
-    tf.transform.rotation.w = cos(turtle_theta_ / 2.0);
-
-    tf_broadcaster_->sendTransform(tf);
+    if (headless_) {
+      /// Simulated time advances by one period per step, however long the step took
+      sim_time_ += rclcpp::Duration::from_seconds(period_);
+      current_time_ = sim_time_;
+
+      Clock msg_clock;
+      msg_clock.clock = sim_time_;
+      pub_clock_->publish(msg_clock);
+    } else {
+      current_time_ = get_clock()->now();
+    }
   }
 
-  /// \brief publish lidar data on laser scan message
-  void publish_laser_scan_()
+  /// \brief Advance the simulation by one period at current_time_ and publish its outputs
+  ///
+  /// In real time, the robot states are handed to the sensor timer after every step.
+  /// On simulated time, the sensors run here every 0.2 s so that a run is reproducible.
+  /// \return Whether the sensors were published in this step, at 5 Hz
+  bool step_simulation_()
   {
-    LaserScan msg;
-    msg.header.stamp = current_time_;
-    msg.header.frame_id = scan_frame_id_;
+    UInt64 msg_timestep;
+    msg_timestep.data = timestep_++;
+    pub_timestep_->publish(msg_timestep);
+
+    auto sensed = false;
+    if (headless_ && ++count_ >= static_cast<int>(0.2 / period_)) {
+      publish_sensors_(*make_snapshot_());
+      count_ = 0;
+      sensed = true;
+    }
 
-    msg.angle_min = -turtlelib::PI;
-    msg.angle_max = turtlelib::PI;
-    msg.angle_increment = lidar_resolution_;
+    update_fleet_pos_();
 
-    msg.range_max = lidar_range_max_;
-    msg.range_min = lidar_range_min_;
+    for (size_t i = 0; i < robots_.size(); ++i) {
+      publish_sensor_data_(i);
+
+      /// Nobody watches a headless run, so the growing path is not kept
+      if (!headless_) {
+        publish_path_(i);
+      }
+    }
 
-    WallState wall = WallState::EAST;
+    broadcast_tf_();
 
-    if (turtle_theta_ >= -turtlelib::PI / 4.0 && turtle_theta_ < turtlelib::PI / 4.0) {
-      wall = WallState::WEST;
-    } else if (turtle_theta_ >= turtlelib::PI / 4.0 && turtle_theta_ < turtlelib::PI * 0.75) {
-      wall = WallState::SOUTH;
-    } else if (turtle_theta_ >= turtlelib::PI * 0.75 || turtle_theta_ < -turtlelib::PI * 0.75) {
-      wall = WallState::EAST;
-    } else {
-      wall = WallState::NORTH;
+    if (!headless_) {
+      snapshots_.put(make_snapshot_());
     }
 
-    std::vector<turtlelib::Obstacle> obstacles;
-    const turtlelib::Transform2D T_sb({0.032, 0.0}, 0.0);
-    const turtlelib::Transform2D T_wb({turtle_x_, turtle_y_}, turtle_theta_);
-    const turtlelib::Transform2D T_bw = T_wb.inv();
-    const turtlelib::Transform2D T_sw = T_sb * T_bw;
-    const turtlelib::Transform2D T_ws = T_sw.inv();
-    RCLCPP_DEBUG_STREAM(get_logger(), "T_bs: " << T_bw);
+    return sensed;
+  }
 
-    const auto x_scan = T_ws.translation().x;
-    const auto y_scan = T_ws.translation().y;
-    const auto theta_scan = T_ws.rotation();
+  /// \brief Copy the robot states at current_time_ for the sensors
+  /// \return The snapshot
+  std::unique_ptr<SensorSnapshot> make_snapshot_() const
+  {
+    return std::make_unique<SensorSnapshot>(SensorSnapshot{current_time_, sim_.snapshot()});
+  }
 
-    for (size_t i = 0; i < obstacles_x_.size(); ++i) {
-      const turtlelib::Point2D pw{obstacles_x_.at(i), obstacles_y_.at(i)};
-      const turtlelib::Point2D ps = T_sw(pw);
-      obstacles.push_back({ps.x, ps.y, obstacle_radius_});
-      RCLCPP_DEBUG_STREAM(get_logger(), "Ps: " << ps);
+  /// \brief Simulate and publish the lidar and the fake sensor of every robot
+  ///
+  /// Only reads the snapshot and sensor_sim_, never sim_, so it can run beside the steps.
+  /// \param snapshot The robot states to sense from
+  void publish_sensors_(const SensorSnapshot & snapshot)
+  {
+    sensor_sim_.restore(snapshot.sim);
+
+    for (size_t i = 0; i < robots_.size(); ++i) {
+      auto & robot = robots_.at(i);
+      sensor_sim_.sense_obstacles(i, robot.obstacle_pos_sensor, robot.sensed_obstacles);
     }
 
-    RCLCPP_DEBUG_STREAM(get_logger(), "theta: " << turtle_theta_);
-    for (int i = 0; i < static_cast<int>(turtlelib::PI * 2.0 / lidar_resolution_); ++i) {
-      const auto alpha = lidar_resolution_ * i - turtlelib::PI;
-      std::vector<double> obs_dists;
+    publish_laser_scans_(snapshot.stamp);
+    // publish_obstacle_markers_();
+    for (size_t i = 0; i < robots_.size(); ++i) {
+      publish_fake_sensor_(i, snapshot.stamp);
+    }
+  }
 
-      for (size_t j = 0; j < obstacles.size(); ++j) {
-        const auto obs = obstacles.at(j);
+  /// \brief Publish the timing of a timer and start its next report window
+  /// \param timing The timing of the timer
+  void publish_timer_stats_(TimerTiming & timing)
+  {
+    TimerStats msg;
+    msg.name = timing.name;
+    msg.period = timing.period;
+    msg.count = timing.count;
+    msg.mean_duration = timing.count > 0 ? timing.duration_sum / timing.count : 0.0;
+    msg.max_duration = timing.max_duration;
+    msg.max_jitter = timing.max_jitter;
+    msg.overruns = timing.overruns;
+    msg.missed = timing.missed;
+    pub_timer_stats_->publish(msg);
+
+    timing.clear();
+  }
 
-        if (turtlelib::can_intersect(alpha, obs)) {
-          const auto obs_dist = turtlelib::find_distance(alpha, obs);
-          RCLCPP_DEBUG_STREAM(get_logger(), "distance: " << obs_dist);
-          obs_dists.push_back(obs_dist + distribution_laser_(generator_));
-        }
-      }
+  /// @brief Update the positions of every turtlebot of the fleet
+  void update_fleet_pos_()
+  {
+    {
+      std::lock_guard<std::mutex> lock(wheel_cmd_mutex_);
 
-      if (!obs_dists.empty()) {
-        double min_dist = std::numeric_limits<double>::max();
+      for (size_t i = 0; i < robots_.size(); ++i) {
+        left_cmd_.at(i) = robots_.at(i).wheel_cmd.left_velocity;
+        right_cmd_.at(i) = robots_.at(i).wheel_cmd.right_velocity;
+      }
+    }
 
-        for (size_t j = 0; j < obs_dists.size(); ++j) {
-          const auto dist = obs_dists.at(j);
+    /// Wheel noise, slip and collisions are modelled in turtlelib::WorldSim
+    sim_.step(left_cmd_, right_cmd_);
+  }
 
-          if (dist < min_dist) {
-            min_dist = dist;
-          }
-        }
+  /// @brief broadcast the transforms of every robot
+  void broadcast_tf_()
+  {
+    const auto & fleet = sim_.fleet();
+    std::vector<TransformStamped> tfs;
 
-        msg.ranges.push_back(min_dist);
-      } else {
-        switch (wall) {
-          case WallState::EAST:
-            {
-              const auto d = arena_x_length_ / 2.0 - x_scan;
-              const auto beta = turtlelib::normalize_angle(alpha + theta_scan);
-              const auto range = d / cos(beta) + distribution_laser_(generator_);
-              msg.ranges.push_back(range);
-
-              const auto py = y_scan + d * tan(beta);
-              if (py > arena_y_length_ / 2.0) {
-                wall = WallState::NORTH;
-              }
-              break;
-            }
+    for (size_t i = 0; i < robots_.size(); ++i) {
+      const auto theta = fleet.theta.at(i);
 
-          case WallState::NORTH:
-            {
-              const auto d = arena_y_length_ / 2.0 - y_scan;
-              const auto beta = turtlelib::normalize_angle(alpha + theta_scan) -
-                turtlelib::PI / 2.0;
-              const auto range = d / cos(beta) + distribution_laser_(generator_);
-              msg.ranges.push_back(range);
-
-              const auto px = x_scan - d * tan(beta);
-              if (px < -arena_x_length_ / 2.0) {
-                wall = WallState::WEST;
-              }
-              break;
-            }
+      TransformStamped tf;
+      tf.header.stamp = current_time_;
+      tf.header.frame_id = world_frame_id_;
+      tf.child_frame_id = robots_.at(i).body_frame_id;
 
-          case WallState::WEST:
-            {
-              const auto d = arena_x_length_ / 2.0 + x_scan;
-              const auto beta = turtlelib::normalize_angle(alpha + theta_scan) - turtlelib::PI;
-              const auto range = d / cos(beta) + distribution_laser_(generator_);
-              msg.ranges.push_back(range);
-
-              const auto py = y_scan - d * tan(beta);
-              if (py < -arena_y_length_ / 2.0) {
-                wall = WallState::SOUTH;
-              }
-              break;
-            }
+      tf.transform.translation.x = fleet.x.at(i);
+      tf.transform.translation.y = fleet.y.at(i);
+      tf.transform.translation.z = 0.0;
 
-          case WallState::SOUTH:
-            {
-              const auto d = arena_y_length_ / 2.0 + y_scan;
-              const auto beta = turtlelib::normalize_angle(alpha + theta_scan) +
-                turtlelib::PI / 2.0;
-              const auto range = d / cos(beta) + distribution_laser_(generator_);
-              msg.ranges.push_back(range);
-
-              const auto px = x_scan + d * tan(beta);
-              if (px > arena_x_length_ / 2.0) {
-                wall = WallState::EAST;
-              }
-              break;
-            }
+      tf.transform.rotation.x = 0.0;
+      tf.transform.rotation.y = 0.0;
+      tf.transform.rotation.z = sin(theta / 2.0);
+      tf.transform.rotation.w = cos(theta / 2.0);
 
-          default:
-            {
-              RCLCPP_ERROR_STREAM(get_logger(), "Invalid state");
-              throw std::logic_error("Invalid wall state");
-              break;
-            }
-        }
-      }
+      tfs.push_back(tf);
     }
 
-    pub_laser_scan_->publish(msg);
+    tf_broadcaster_->sendTransform(tfs);
+  }
+
+  /// \brief Compute the lidar scans of every robot in parallel and publish them
+  /// \param stamp The time of the scans
+  void publish_laser_scans_(const rclcpp::Time & stamp)
+  {
+    /// The world is only read, so the robots cast at once
+    pool_->parallel_for(
+      robots_.size(), [this, &stamp](size_t i, size_t) {
+        generate_laser_scan_(i, stamp);
+      });
+
+    for (const auto & robot : robots_) {
+      robot.pub_laser_scan->publish(robot.scan);
+    }
     RCLCPP_DEBUG_STREAM(get_logger(), "laser published");
   }
 
+  /// \brief Compute the lidar scan of a robot into its scan message
+  /// \param i The index of the robot
+  /// \param stamp The time of the scan
+  void generate_laser_scan_(size_t i, const rclcpp::Time & stamp)
+  {
+    auto & robot = robots_.at(i);
+    auto & msg = robot.scan;
+    msg.header.stamp = stamp;
+    msg.header.frame_id = robot.scan_frame_id;
+
+    msg.angle_min = -turtlelib::PI;
+    msg.angle_max = turtlelib::PI;
+    msg.angle_increment = lidar_resolution_;
+
+    msg.range_max = lidar_range_max_;
+    msg.range_min = lidar_range_min_;
+
+    /// The noise is keyed by the tick, the robot and the beam, whichever thread casts it
+    sensor_sim_.scan(i, msg.ranges);
+  }
+
   /// @brief publish a path message that displays the of the robot on rviz
-  void publish_path_()
+  /// @param i The index of the robot
+  void publish_path_(size_t i)
   {
+    auto & robot = robots_.at(i);
+    const auto & fleet = sim_.fleet();
+    const auto theta = fleet.theta.at(i);
     PoseStamped pose_curr;
 
     pose_curr.header.stamp = current_time_;
     pose_curr.header.frame_id = world_frame_id_;
 
-    pose_curr.pose.position.x = turtle_x_;
-    pose_curr.pose.position.y = turtle_y_;
+    pose_curr.pose.position.x = fleet.x.at(i);
+    pose_curr.pose.position.y = fleet.y.at(i);
     pose_curr.pose.position.z = 0.0;
 
     pose_curr.pose.orientation.x = 0.0;
     pose_curr.pose.orientation.y = 0.0;
-    pose_curr.pose.orientation.z = sin(turtle_theta_ / 2.0);
-    pose_curr.pose.orientation.w = cos(turtle_theta_ / 2.0);
+    pose_curr.pose.orientation.z = sin(theta / 2.0);
+    pose_curr.pose.orientation.w = cos(theta / 2.0);
 
-    poses_.push_back(pose_curr);
+    robot.poses.push_back(pose_curr);
 
     Path msg_path;
 
     msg_path.header.stamp = current_time_;
     msg_path.header.frame_id = world_frame_id_;
-    msg_path.poses = poses_;
+    msg_path.poses = robot.poses;
 
-    pub_path_->publish(msg_path);
+    robot.pub_path->publish(msg_path);
   }
 
-  /// @brief publish the sensor data of the turtlebot
-  void publish_sensor_data_()
+  /// @brief publish the sensor data of a turtlebot
+  /// @param i The index of the robot
+  void publish_sensor_data_(size_t i)
   {
     SensorData msg_sensor;
 
     msg_sensor.stamp = current_time_;
-    msg_sensor.left_encoder = (int32_t) (turtlebot_.left_wheel() * encoder_ticks_per_rad_);
-    msg_sensor.right_encoder = (int32_t) (turtlebot_.right_wheel() * encoder_ticks_per_rad_);
+    msg_sensor.left_encoder = sim_.left_encoder(i);
+    msg_sensor.right_encoder = sim_.right_encoder(i);
 
-    pub_sensor_data_->publish(msg_sensor);
+    robots_.at(i).pub_sensor_data->publish(msg_sensor);
   }
 
   /// \brief publish the markers to display wall on rviz
   void publish_wall_markers_()
   {
-    Marker m1;
-    Marker m2;
-    Marker m3;
-    Marker m4;
     MarkerArray m_array;
 
-    /// first wall
-    m1.header.stamp = current_time_;
-    m1.header.frame_id = world_frame_id_;
-    m1.id = 1;
-    m1.type = Marker::CUBE;
-    m1.action = Marker::ADD;
-    m1.pose.position.x = arena_x_length_ / 2.0 + wall_thickness_ / 2.0;
-    m1.pose.position.y = wall_thickness_ / 2.0;
-    m1.pose.position.z = wall_height_ / 2.0;
-    m1.scale.x = wall_thickness_;
-    m1.scale.y = arena_y_length_ + wall_thickness_;
-    m1.scale.z = wall_height_;
-    m1.color.r = wall_r_;
-    m1.color.g = wall_g_;
-    m1.color.b = wall_b_;
-    m1.color.a = 1.0;
-
-    /// second wall
-    m2.header.stamp = current_time_;
-    m2.header.frame_id = world_frame_id_;
-    m2.id = 2;
-    m2.type = Marker::CUBE;
-    m2.action = Marker::ADD;
-    m2.pose.position.x = -wall_thickness_ / 2.0;
-    m2.pose.position.y = arena_y_length_ / 2.0 + wall_thickness_ / 2.0;
-    m2.pose.position.z = wall_height_ / 2.0;
-    m2.scale.x = arena_x_length_ + wall_thickness_;
-    m2.scale.y = wall_thickness_;
-    m2.scale.z = wall_height_;
-    m2.color.r = wall_r_;
-    m2.color.g = wall_g_;
-    m2.color.b = wall_b_;
-    m2.color.a = 1.0;
-
-    /// third wall
-    m3.header.stamp = current_time_;
-    m3.header.frame_id = world_frame_id_;
-    m3.id = 3;
-    m3.type = Marker::CUBE;
-    m3.action = Marker::ADD;
-    m3.pose.position.x = -arena_x_length_ / 2.0 - wall_thickness_ / 2.0;
-    m3.pose.position.y = -wall_thickness_ / 2.0;
-    m3.pose.position.z = wall_height_ / 2.0;
-    m3.scale.x = wall_thickness_;
-    m3.scale.y = arena_y_length_ + wall_thickness_;
-    m3.scale.z = wall_height_;
-    m3.color.r = wall_r_;
-    m3.color.g = wall_g_;
-    m3.color.b = wall_b_;
-    m3.color.a = 1.0;
-
-    /// fourth wall
-    m4.header.stamp = current_time_;
-    m4.header.frame_id = world_frame_id_;
-    m4.id = 4;
-    m4.type = Marker::CUBE;
-    m4.action = Marker::ADD;
-    m4.pose.position.x = wall_thickness_ / 2.0;
-    m4.pose.position.y = -arena_y_length_ / 2.0 - wall_thickness_ / 2.0;
-    m4.pose.position.z = wall_height_ / 2.0;
-    m4.scale.x = arena_x_length_ + wall_thickness_;
-    m4.scale.y = wall_thickness_;
-    m4.scale.z = wall_height_;
-    m4.color.r = wall_r_;
-    m4.color.g = wall_g_;
-    m4.color.b = wall_b_;
-    m4.color.a = 1.0;
-
-    m_array.markers.push_back(m1);
-    m_array.markers.push_back(m2);
-    m_array.markers.push_back(m3);
-    m_array.markers.push_back(m4);
+    const auto & walls = sim_.world().walls.segments();
+
+    for (size_t i = 0; i < walls.size(); ++i) {
+      const auto & wall = walls.at(i);
+      const auto dx = wall.x2 - wall.x1;
+      const auto dy = wall.y2 - wall.y1;
+      const auto yaw = atan2(dy, dx);
+
+      Marker m;
+      m.header.stamp = current_time_;
+      m.header.frame_id = world_frame_id_;
+      m.id = i + 1;
+      m.type = Marker::CUBE;
+      m.action = Marker::ADD;
+      m.pose.position.x = (wall.x1 + wall.x2) / 2.0;
+      m.pose.position.y = (wall.y1 + wall.y2) / 2.0;
+      m.pose.position.z = wall_height_ / 2.0;
+      m.pose.orientation.z = sin(yaw / 2.0);
+      m.pose.orientation.w = cos(yaw / 2.0);
+      m.scale.x = sqrt(dx * dx + dy * dy) + wall_thickness_;
+      m.scale.y = wall_thickness_;
+      m.scale.z = wall_height_;
+      m.color.r = wall_r_;
+      m.color.g = wall_g_;
+      m.color.b = wall_b_;
+      m.color.a = 1.0;
+
+      m_array.markers.push_back(m);
+    }
 
     pub_wall_markers_->publish(m_array);
   }
 
+  /// \brief publish the occupancy map of the world
+  /// \param map The map
+  void publish_map_(const turtlelib::OccupancyMap & map)
+  {
+    OccupancyGrid msg;
+    msg.header.stamp = get_clock()->now();
+    msg.header.frame_id = world_frame_id_;
+    msg.info.map_load_time = msg.header.stamp;
+    msg.info.resolution = map.resolution;
+    msg.info.width = map.width;
+    msg.info.height = map.height;
+    msg.info.origin.position.x = map.origin_x;
+    msg.info.origin.position.y = map.origin_y;
+    msg.info.origin.orientation.w = 1.0;
+    msg.data = map.data;
+
+    pub_map_->publish(msg);
+  }
+
   /// \brief publish marker to display obstacle on rviz
   void publish_obstacle_markers_()
   {
@@ -528,32 +571,36 @@ private:
     pub_obstacle_markers_->publish(m_array_obs);
   }
 
-  void publish_fake_sensor_()
+  /// \brief publish the obstacles sensed by a robot, in its body frame
+  /// \param j The index of the robot
+  /// \param stamp The time of the measurements
+  void publish_fake_sensor_(size_t j, const rclcpp::Time & stamp)
   {
+    auto & robot = robots_.at(j);
 
     // MarkerArray m_array_obs;
     MarkerArray m_array_sensor;
     ObstacleMeasurements m_measurements;
 
-    turtlelib::Transform2D Tsb(turtlelib::Vector2D{turtle_x_, turtle_y_}, turtle_theta_);
+    const auto & fleet = sensor_sim_.fleet();
+    turtlelib::Transform2D Tsb(
+      turtlelib::Vector2D{fleet.x.at(j), fleet.y.at(j)}, fleet.theta.at(j));
     turtlelib::Transform2D Tbs = Tsb.inv();
 
-    for (std::size_t i = 0; i < obstacles_x_.size(); ++i) {
-      const auto x_pos = obstacles_x_.at(i);
-      const auto y_pos = obstacles_y_.at(i);
-      const auto dist = sqrt(pow(x_pos - turtle_x_, 2.0) + pow(y_pos - turtle_y_, 2.0));
-
-      const auto ps = obstacle_pos_sensor_.at(i);
+    for (std::size_t k = 0; k < robot.sensed_obstacles.size(); ++k) {
+      const auto i = robot.sensed_obstacles.at(k);
+      const auto ps = robot.obstacle_pos_sensor.at(k);
       const auto pb = Tbs(ps);
 
       Marker m_sensor;
       Measurement m_measure;
 
       /// Sensor marker
-      m_sensor.header.stamp = current_time_;
-      m_sensor.header.frame_id = body_frame_id_;
+      m_sensor.header.stamp = stamp;
+      m_sensor.header.frame_id = robot.body_frame_id;
       m_sensor.id = i + 20;
       m_sensor.type = Marker::CYLINDER;
+      m_sensor.action = Marker::ADD;
       m_sensor.pose.position.x = pb.x;
       m_sensor.pose.position.y = pb.y;
       m_sensor.pose.position.z = obstacle_height_ / 2.0;
@@ -565,33 +612,44 @@ private:
       m_sensor.color.b = 0.0;
       m_sensor.color.a = 1.0;
 
-      if (dist < max_range_) {
-        m_sensor.action = Marker::ADD;
+      m_measure.x = pb.x;
+      m_measure.y = pb.y;
+      m_measure.uid = i;
 
-        m_measure.x = pb.x;
-        m_measure.y = pb.y;
-        m_measure.uid = i;
-      } else {
-        m_sensor.action = Marker::DELETE;
+      m_array_sensor.markers.push_back(m_sensor);
+      m_measurements.measurements.push_back(m_measure);
+    }
 
-        m_measure.x = 1e4;
-        m_measure.y = 1e4;
-        m_measure.uid = i;
-      }
+    /// Only the obstacles leaving the range are deleted, both lists are in increasing order
+    std::vector<size_t> left;
+    std::set_difference(
+      robot.shown_obstacles.begin(), robot.shown_obstacles.end(),
+      robot.sensed_obstacles.begin(), robot.sensed_obstacles.end(), std::back_inserter(left));
 
+    for (const auto i : left) {
+      Marker m_sensor;
+      m_sensor.header.stamp = stamp;
+      m_sensor.header.frame_id = robot.body_frame_id;
+      m_sensor.id = i + 20;
+      m_sensor.action = Marker::DELETE;
       m_array_sensor.markers.push_back(m_sensor);
-      m_measurements.measurements.push_back(m_measure);
     }
 
-    pub_fake_sensor_markers_->publish(m_array_sensor);
-    pub_obstacles_->publish(m_measurements);
+    robot.shown_obstacles = robot.sensed_obstacles;
+
+    if (!headless_) {
+      robot.pub_fake_sensor_markers->publish(m_array_sensor);
+    }
+    robot.pub_obstacles->publish(m_measurements);
   }
 
-  /// \brief reset the position of the turtlebot.
-  void reset_turtle_pose_()
+  /// \brief reset the positions of the turtlebots to their starts, with their wheels at 0
+  void reset_fleet_pose_()
   {
-    turtlebot_.update_config(x0_, y0_, theta0_);
-    turtlebot_ = turtlelib::DiffDrive(track_width_, wheel_radius_);
+    for (size_t i = 0; i < robots_.size(); ++i) {
+      const auto & robot = robots_.at(i);
+      sim_.reset_robot(i, robot.x0, robot.y0, robot.theta0);
+    }
   }
 
   /// \brief Callback function for reset service, reset the position of turtlebot and timestep
@@ -604,11 +662,11 @@ private:
     (void) request;
     (void) response;
 
-    reset_turtle_pose_();
+    reset_fleet_pose_();
     timestep_ = 0;
   }
 
-  /// \brief Callback function of the teleport service, teleport the turtlebot to a place
+  /// \brief Callback function of the teleport service, teleport the first turtlebot to a place
   /// \param request The request object
   /// \param response The response object
   void srv_teleport_callback_(
@@ -619,37 +677,197 @@ private:
     const auto y = request->y;
     const auto theta = request->theta;
 
-    turtlebot_.update_config(x, y, theta);
+    sim_.place_robot(0, x, y, theta);
 
     response->result = true;
   }
 
-  /// @brief Callback function of the wheel_cmd message
+  /// @brief Callback function of the wheel_cmd message of a robot
+  /// @param i The index of the robot
   /// @param msg the wheel_cmd message
-  void sub_wheel_cmd_callback_(WheelCommands::SharedPtr msg)
+  void sub_wheel_cmd_callback_(size_t i, WheelCommands::SharedPtr msg)
+  {
+    std::lock_guard<std::mutex> lock(wheel_cmd_mutex_);
+    robots_.at(i).wheel_cmd = *msg;
+  }
+
+  /// \brief Subscribe to the acknowledging topics that have appeared since the last call
+  /// \return Whether every acknowledging topic was found
+  bool subscribe_acks_()
+  {
+    auto found_all = true;
+    const auto graph = get_topic_names_and_types();
+
+    for (size_t i = 0; i < ack_topics_.size(); ++i) {
+      auto & ack = ack_topics_.at(i);
+
+      if (ack.subscription) {
+        continue;
+      }
+
+      /// The type of the topic is taken from its publisher
+      const auto name = get_node_topics_interface()->resolve_topic_name(ack.name);
+      const auto topic = graph.find(name);
+
+      if (topic == graph.end() || topic->second.empty()) {
+        RCLCPP_WARN_STREAM(get_logger(), "No publisher of " << name << " to acknowledge steps");
+        found_all = false;
+        continue;
+      }
+
+      rclcpp::SubscriptionOptions options;
+      options.callback_group = ack_group_;
+      ack.subscription = create_generic_subscription(
+        name, topic->second.front(), 10,
+        [this, i](std::shared_ptr<rclcpp::SerializedMessage>) {
+          {
+            std::lock_guard<std::mutex> lock(ack_mutex_);
+            ++ack_counts_.at(i);
+          }
+          ack_cv_.notify_all();
+        },
+        options);
+    }
+
+    return found_all;
+  }
+
+  /// \brief Callback function of the step service, advance a lock-step simulation tick by tick
+  /// \param request The request object
+  /// \param response The response object
+  void srv_step_callback_(
+    std::shared_ptr<Step::Request> request,
+    std::shared_ptr<Step::Response> response)
   {
-    wheel_cmd_ = *msg;
+    response->result = subscribe_acks_();
+    response->timeouts = 0;
+
+    const auto timeout = std::chrono::duration<double>(ack_timeout_);
+    const auto start = std::chrono::steady_clock::now();
+    auto latency_sum = 0.0;
+    auto latency_max = 0.0;
+    uint32_t answered = 0;
+
+    for (uint32_t n = 0; n < request->ticks; ++n) {
+      std::unique_lock<std::mutex> lock(ack_mutex_);
+      const auto counts = ack_counts_;
+      lock.unlock();
+
+      advance_clock_();
+      const auto tick_start = std::chrono::steady_clock::now();
+      const auto sensed = step_simulation_();
+
+      /// Wait until every topic due in this tick published again
+      lock.lock();
+      const auto acked = ack_cv_.wait_for(
+        lock, timeout, [this, &counts, sensed]() {
+          for (size_t i = 0; i < ack_topics_.size(); ++i) {
+            const auto & ack = ack_topics_.at(i);
+            const auto due = ack.subscription && (sensed || !ack.sensor_only);
+
+            if (due && ack_counts_.at(i) == counts.at(i)) {
+              return false;
+            }
+          }
+          return true;
+        });
+      lock.unlock();
+
+      if (!acked) {
+        ++response->timeouts;
+        continue;
+      }
+
+      const auto latency = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - tick_start).count();
+      latency_sum += latency;
+      latency_max = std::max(latency_max, latency);
+      ++answered;
+    }
+
+    response->result = response->result && response->timeouts == 0;
+    response->timestep = timestep_;
+    response->sim_time = sim_time_.seconds();
+    response->wall_time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+    response->mean_latency = answered > 0 ? latency_sum / answered : 0.0;
+    response->max_latency = latency_max;
   }
 
-  /// timer
+  /// \brief A topic acknowledging the ticks of the step service
+  struct AckTopic
+  {
+    /// \brief The name of the topic
+    std::string name;
+
+    /// \brief Whether only the ticks publishing the sensors are acknowledged
+    bool sensor_only;
+
+    /// \brief The subscription, created once the topic has a publisher
+    rclcpp::GenericSubscription::SharedPtr subscription;
+  };
+
+  /// \brief The topics and sensor buffers of a simulated robot, its state lives in sim_
+  struct Robot
+  {
+    /// \brief The name of the robot, which prefixes its topics and frames
+    std::string name;
+
+    /// \brief The frame of the robot body
+    std::string body_frame_id;
+
+    /// \brief The frame of the robot lidar
+    std::string scan_frame_id;
+
+    /// \brief The starting pose of the robot
+    double x0;
+    double y0;
+    double theta0;
+
+    /// \brief The latest wheel command, guarded by wheel_cmd_mutex_
+    WheelCommands wheel_cmd;
+
+    /// \brief The poses of the path so far
+    std::vector<PoseStamped> poses;
+
+    /// \brief The noisy positions of the sensed obstacles and their indices
+    std::vector<turtlelib::Point2D> obstacle_pos_sensor;
+    std::vector<size_t> sensed_obstacles;
+    std::vector<size_t> shown_obstacles;
+
+    /// \brief The latest lidar scan
+    LaserScan scan;
+
+    rclcpp::Subscription<WheelCommands>::SharedPtr sub_wheel_cmd;
+    rclcpp::Publisher<SensorData>::SharedPtr pub_sensor_data;
+    rclcpp::Publisher<MarkerArray>::SharedPtr pub_fake_sensor_markers;
+    rclcpp::Publisher<Path>::SharedPtr pub_path;
+    rclcpp::Publisher<LaserScan>::SharedPtr pub_laser_scan;
+    rclcpp::Publisher<ObstacleMeasurements>::SharedPtr pub_obstacles;
+  };
+
+  /// timers
   rclcpp::TimerBase::SharedPtr timer_;
+  rclcpp::TimerBase::SharedPtr sensor_timer_;
+
+  /// Callback group of the wheel commands and the acknowledgements, which run while a step blocks
+  rclcpp::CallbackGroup::SharedPtr ack_group_;
+
+  /// Callback group of the sensor timer, which runs beside the steps
+  rclcpp::CallbackGroup::SharedPtr sensor_group_;
 
   /// services
   rclcpp::Service<Empty>::SharedPtr srv_reset_;
   rclcpp::Service<Teleport>::SharedPtr srv_teleport_;
-
-  /// subscribers
-  rclcpp::Subscription<WheelCommands>::SharedPtr sub_wheel_cmd_;
+  rclcpp::Service<Step>::SharedPtr srv_step_;
 
   /// publishers
   rclcpp::Publisher<UInt64>::SharedPtr pub_timestep_;
   rclcpp::Publisher<MarkerArray>::SharedPtr pub_wall_markers_;
   rclcpp::Publisher<MarkerArray>::SharedPtr pub_obstacle_markers_;
-  rclcpp::Publisher<MarkerArray>::SharedPtr pub_fake_sensor_markers_;
-  rclcpp::Publisher<SensorData>::SharedPtr pub_sensor_data_;
-  rclcpp::Publisher<Path>::SharedPtr pub_path_;
-  rclcpp::Publisher<LaserScan>::SharedPtr pub_laser_scan_;
-  rclcpp::Publisher<ObstacleMeasurements>::SharedPtr pub_obstacles_;
+  rclcpp::Publisher<OccupancyGrid>::SharedPtr pub_map_;
+  rclcpp::Publisher<Clock>::SharedPtr pub_clock_;
+  rclcpp::Publisher<TimerStats>::SharedPtr pub_timer_stats_;
 
   /// transform broadcasters
   std::unique_ptr<TransformBroadcaster> tf_broadcaster_;
@@ -661,14 +879,20 @@ private:
   /// Time stamp
   rclcpp::Time current_time_;
 
-  /// subscribed messages
-  WheelCommands wheel_cmd_;
+  /// The simulated time of a headless run
+  rclcpp::Time sim_time_;
+
+  /// subscribed wheel commands of every robot
+  std::mutex wheel_cmd_mutex_;
+
+  /// step acknowledgements, counted per topic
+  std::vector<AckTopic> ack_topics_;
+  std::vector<uint64_t> ack_counts_;
+  std::mutex ack_mutex_;
+  std::condition_variable ack_cv_;
 
   /// parameters
   double rate_;
-  double x0_;
-  double y0_;
-  double theta0_;
   double arena_x_length_;
   double arena_y_length_;
   std::vector<double> obstacles_x_;
@@ -689,14 +913,15 @@ private:
   double lidar_accuracy_;
   double lidar_resolution_;
   bool draw_only_;
+  bool headless_;
+  double speedup_;
+  bool lockstep_;
+  double ack_timeout_;
 
   /// other attributes
   int count_;
   double period_;
   uint64_t timestep_;
-  double turtle_x_;
-  double turtle_y_;
-  double turtle_theta_;
   double wall_r_;
   double wall_g_;
   double wall_b_;
@@ -704,24 +929,27 @@ private:
   double wall_thickness_;
   double obstacle_height_;
   std::string world_frame_id_;
-  std::string body_frame_id_;
-  std::string scan_frame_id_;
-  turtlelib::DiffDrive turtlebot_;
-  std::vector<PoseStamped> poses_;
-  std::default_random_engine generator_;
-  std::normal_distribution<double> distribution_input_;
-  std::uniform_real_distribution<double> distribution_slip_;
-  std::normal_distribution<double> distribution_sensor_;
-  std::normal_distribution<double> distribution_laser_;
-  std::vector<turtlelib::Point2D> obstacle_pos_sensor_;
+  std::vector<Robot> robots_;
+  turtlelib::WorldSim sim_;
+  std::vector<double> left_cmd_;
+  std::vector<double> right_cmd_;
+  std::unique_ptr<turtlelib::WorkerPool> pool_;
+
+  /// The sensors sense a copy of sim_ restored from the newest snapshot of the steps
+  turtlelib::LatestMailbox<SensorSnapshot> snapshots_;
+  std::unique_ptr<SensorSnapshot> sensor_snapshot_;
+  turtlelib::WorldSim sensor_sim_;
+
+  /// timing of the timers
+  TimerTiming kinematics_timing_;
+  TimerTiming sensor_timing_;
 
 public:
   /// \brief Initialize the nusim node
   NuSim()
   : Node("nusim"), marker_qos_(10), laser_qos_(10), count_(0), timestep_(0), wall_r_(1.0),
     wall_g_(0.0), wall_b_(0.0), wall_height_(0.25), wall_thickness_(0.1), obstacle_height_(0.25),
-    world_frame_id_("nusim/world"), body_frame_id_("red/base_footprint"),
-    scan_frame_id_("red/base_scan")
+    world_frame_id_("nusim/world")
   {
     /// parameter descriptions
     ParameterDescriptor rate_des;
@@ -730,9 +958,15 @@ public:
     ParameterDescriptor theta0_des;
     ParameterDescriptor arena_x_des;
     ParameterDescriptor arena_y_des;
+    ParameterDescriptor walls_x1_des;
+    ParameterDescriptor walls_y1_des;
+    ParameterDescriptor walls_x2_des;
+    ParameterDescriptor walls_y2_des;
+    ParameterDescriptor map_yaml_des;
     ParameterDescriptor obs_x_des;
     ParameterDescriptor obs_y_des;
     ParameterDescriptor obs_r_des;
+    ParameterDescriptor obs_cell_size_des;
     ParameterDescriptor wheel_radius_des;
     ParameterDescriptor track_width_des;
     ParameterDescriptor motor_cmd_max_des;
@@ -748,15 +982,33 @@ public:
     ParameterDescriptor lidar_accuracy_des;
     ParameterDescriptor lidar_resolution_des;
     ParameterDescriptor draw_only_des;
+    ParameterDescriptor headless_des;
+    ParameterDescriptor speedup_des;
+    ParameterDescriptor lockstep_des;
+    ParameterDescriptor ack_topics_des;
+    ParameterDescriptor sensor_ack_topics_des;
+    ParameterDescriptor ack_timeout_des;
+    ParameterDescriptor robot_names_des;
+    ParameterDescriptor robot_x0_des;
+    ParameterDescriptor robot_y0_des;
+    ParameterDescriptor robot_theta0_des;
+    ParameterDescriptor lidar_threads_des;
+    ParameterDescriptor seed_des;
     rate_des.description = "The rate of the simulator";
     x0_des.description = "The initial x location";
     y0_des.description = "The initial y location";
     theta0_des.description = "The initial theta pose";
     arena_x_des.description = "The wall length in x direction";
     arena_y_des.description = "The wall length in y direction";
+    walls_x1_des.description = "The start x coordinates of the walls, the arena if empty";
+    walls_y1_des.description = "The start y coordinates of the walls";
+    walls_x2_des.description = "The end x coordinates of the walls";
+    walls_y2_des.description = "The end y coordinates of the walls";
+    map_yaml_des.description = "The map_server YAML file of an occupancy map, none if empty";
     obs_x_des.description = "The list of x coordinates of the obstacles";
     obs_y_des.description = "The list of y coordinates of the obstacles";
     obs_r_des.description = "The radius of the obstacles";
+    obs_cell_size_des.description = "The cell size of the obstacle grid index";
     wheel_radius_des.description = "The radius of the wheel";
     track_width_des.description = "The width of the track";
     motor_cmd_max_des.description = "The maximum motor command";
@@ -772,6 +1024,19 @@ public:
     lidar_accuracy_des.description = "The accuracy of the lidar";
     lidar_resolution_des.description = "The angular resolution of the lidar";
     draw_only_des.description = "Whether this is behave as draw only";
+    headless_des.description = "Whether to run on simulated time published on /clock";
+    speedup_des.description =
+      "Simulated seconds per wall second when headless, as fast as possible if 0";
+    lockstep_des.description = "Whether to advance only on ~/step, on simulated time";
+    ack_topics_des.description = "The topics that answer every tick of ~/step";
+    sensor_ack_topics_des.description = "The topics that answer the ticks publishing sensors";
+    ack_timeout_des.description = "The longest wait for the answers to a tick in seconds";
+    robot_names_des.description = "The names of the simulated robots";
+    robot_x0_des.description = "The starting x coordinates of the robots, x0 if empty";
+    robot_y0_des.description = "The starting y coordinates of the robots, y0 if empty";
+    robot_theta0_des.description = "The starting headings of the robots, theta0 if empty";
+    lidar_threads_des.description = "Number of threads casting the lidars besides the timer";
+    seed_des.description = "The seed of the noise, the same seed gives the same noise";
 
     /// declare parameters
     declare_parameter<double>("rate", 100.0, rate_des);
@@ -780,6 +1045,11 @@ public:
     declare_parameter<double>("theta0", 0.0, theta0_des);
     declare_parameter<double>("arena_x_length", 10.0, arena_x_des);
     declare_parameter<double>("arena_y_length", 10.0, arena_y_des);
+    declare_parameter<std::vector<double>>("walls/x1", std::vector<double>{}, walls_x1_des);
+    declare_parameter<std::vector<double>>("walls/y1", std::vector<double>{}, walls_y1_des);
+    declare_parameter<std::vector<double>>("walls/x2", std::vector<double>{}, walls_x2_des);
+    declare_parameter<std::vector<double>>("walls/y2", std::vector<double>{}, walls_y2_des);
+    declare_parameter<std::string>("map_yaml", "", map_yaml_des);
     declare_parameter<std::vector<double>>(
       "obstacles/x",
       std::vector<double>{1.2, 2.3},
@@ -791,6 +1061,7 @@ public:
       obs_y_des
     );
     declare_parameter<double>("obstacles/r", 0.05, obs_r_des);
+    declare_parameter<double>("obstacles/cell_size", 0.5, obs_cell_size_des);
     declare_parameter<double>("wheel_radius", 0.033, wheel_radius_des);
     declare_parameter<double>("track_width", 0.16, track_width_des);
     declare_parameter<int64_t>("motor_cmd_max", 265, motor_cmd_max_des);
@@ -806,12 +1077,25 @@ public:
     declare_parameter<double>("lidar_accuracy", 0.015, lidar_accuracy_des);
     declare_parameter<double>("lidar_resolution", 0.02, lidar_resolution_des);
     declare_parameter<bool>("draw_only", false, draw_only_des);
+    declare_parameter<bool>("headless", false, headless_des);
+    declare_parameter<double>("speedup", 0.0, speedup_des);
+    declare_parameter<bool>("lockstep", false, lockstep_des);
+    declare_parameter<std::vector<std::string>>(
+      "step/ack_topics", std::vector<std::string>{}, ack_topics_des);
+    declare_parameter<std::vector<std::string>>(
+      "step/sensor_ack_topics", std::vector<std::string>{}, sensor_ack_topics_des);
+    declare_parameter<double>("step/ack_timeout", 1.0, ack_timeout_des);
+    declare_parameter<std::vector<std::string>>(
+      "robots/names", std::vector<std::string>{"red"}, robot_names_des);
+    declare_parameter<std::vector<double>>("robots/x0", std::vector<double>{}, robot_x0_des);
+    declare_parameter<std::vector<double>>("robots/y0", std::vector<double>{}, robot_y0_des);
+    declare_parameter<std::vector<double>>(
+      "robots/theta0", std::vector<double>{}, robot_theta0_des);
+    declare_parameter<int>("lidar_threads", 3, lidar_threads_des);
+    declare_parameter<int64_t>("seed", 0, seed_des);
 
     /// get parameter values
     rate_ = get_parameter("rate").as_double();
-    x0_ = get_parameter("x0").as_double();
-    y0_ = get_parameter("y0").as_double();
-    theta0_ = get_parameter("theta0").as_double();
     arena_x_length_ = get_parameter("arena_x_length").as_double();
     arena_y_length_ = get_parameter("arena_y_length").as_double();
     obstacles_x_ = get_parameter("obstacles/x").as_double_array();
@@ -832,8 +1116,70 @@ public:
     lidar_accuracy_ = get_parameter("lidar_accuracy").as_double();
     lidar_resolution_ = get_parameter("lidar_resolution").as_double();
     draw_only_ = get_parameter("draw_only").as_bool();
+    headless_ = get_parameter("headless").as_bool();
+    speedup_ = get_parameter("speedup").as_double();
+    lockstep_ = get_parameter("lockstep").as_bool();
+    ack_timeout_ = get_parameter("step/ack_timeout").as_double();
+
+    /// A lock-step simulation runs on its own simulated time like a headless one
+    headless_ = headless_ || lockstep_;
+
+    for (const auto & name : get_parameter("step/ack_topics").as_string_array()) {
+      ack_topics_.push_back({name, false, nullptr});
+    }
+
+    for (const auto & name : get_parameter("step/sensor_ack_topics").as_string_array()) {
+      ack_topics_.push_back({name, true, nullptr});
+    }
+
+    ack_counts_.assign(ack_topics_.size(), 0);
+
+    if (speedup_ < 0.0) {
+      RCLCPP_ERROR_STREAM(get_logger(), "The speedup should not be negative");
+      throw std::invalid_argument("The speedup should not be negative");
+    }
 
 
+    const auto robot_names = get_parameter("robots/names").as_string_array();
+    auto robot_x0 = get_parameter("robots/x0").as_double_array();
+    auto robot_y0 = get_parameter("robots/y0").as_double_array();
+    auto robot_theta0 = get_parameter("robots/theta0").as_double_array();
+    const auto lidar_threads = get_parameter("lidar_threads").as_int();
+
+    /// Without starting poses, the robots start at the single robot pose x0, y0, theta0
+    if (robot_x0.empty() && robot_y0.empty() && robot_theta0.empty()) {
+      robot_x0.assign(robot_names.size(), get_parameter("x0").as_double());
+      robot_y0.assign(robot_names.size(), get_parameter("y0").as_double());
+      robot_theta0.assign(robot_names.size(), get_parameter("theta0").as_double());
+    }
+
+    if (
+      robot_names.empty() || robot_x0.size() != robot_names.size() ||
+      robot_y0.size() != robot_names.size() || robot_theta0.size() != robot_names.size())
+    {
+      RCLCPP_ERROR_STREAM(get_logger(), "Every robot needs a name, x0, y0 and theta0");
+      throw std::invalid_argument("Every robot needs a name, x0, y0 and theta0");
+    }
+
+    if (lidar_threads < 0) {
+      RCLCPP_ERROR_STREAM(get_logger(), "Invalid lidar_threads");
+      throw std::invalid_argument("Invalid lidar_threads");
+    }
+
+    /// A single robot keeps the shared topic names, a fleet prefixes them with the robot names
+    for (size_t i = 0; i < robot_names.size(); ++i) {
+      const auto & name = robot_names.at(i);
+
+      Robot robot;
+      robot.name = name;
+      robot.body_frame_id = name + "/base_footprint";
+      robot.scan_frame_id = name + "/base_scan";
+      robot.x0 = robot_x0.at(i);
+      robot.y0 = robot_y0.at(i);
+      robot.theta0 = robot_theta0.at(i);
+      robots_.push_back(robot);
+    }
+
     /// check for x y length
     if (obstacles_x_.size() != obstacles_y_.size()) {
       RCLCPP_ERROR_STREAM(
@@ -844,23 +1190,123 @@ public:
       exit(EXIT_FAILURE);
     }
 
+    const auto walls_x1 = get_parameter("walls/x1").as_double_array();
+    const auto walls_y1 = get_parameter("walls/y1").as_double_array();
+    const auto walls_x2 = get_parameter("walls/x2").as_double_array();
+    const auto walls_y2 = get_parameter("walls/y2").as_double_array();
+
+    if (
+      walls_y1.size() != walls_x1.size() || walls_x2.size() != walls_x1.size() ||
+      walls_y2.size() != walls_x1.size())
+    {
+      RCLCPP_ERROR_STREAM(get_logger(), "Every wall needs x1, y1, x2 and y2");
+      throw std::invalid_argument("Every wall needs x1, y1, x2 and y2");
+    }
+
+    /// The occupancy map is loaded once and turned into its distance field
+    const auto map_yaml = get_parameter("map_yaml").as_string();
+    turtlelib::OccupancyMap map;
+    auto world = std::make_shared<turtlelib::World>();
+
+    if (!map_yaml.empty()) {
+      try {
+        map = turtlelib::load_occupancy_map(map_yaml);
+      } catch (const std::exception & e) {
+        RCLCPP_ERROR_STREAM(get_logger(), "Failed to load map " << map_yaml << ": " << e.what());
+        throw;
+      }
+
+      world->map = turtlelib::DistanceField(map);
+      RCLCPP_INFO_STREAM(
+        get_logger(), "Loaded a " << map.width << "x" << map.height << " map from " << map_yaml);
+    }
+
+    /// Without walls or a map, the world is the rectangular arena
+    std::vector<turtlelib::Segment> walls;
+    for (size_t i = 0; i < walls_x1.size(); ++i) {
+      walls.push_back({walls_x1.at(i), walls_y1.at(i), walls_x2.at(i), walls_y2.at(i)});
+    }
+
+    if (walls.empty() && map_yaml.empty()) {
+      walls = turtlelib::arena_walls(arena_x_length_, arena_y_length_);
+    }
+
+    world->walls = turtlelib::SegmentBVH(walls);
+
+    /// The obstacles never move, so their grid is built once
+    turtlelib::Obstacles obstacles;
+    obstacles.x = obstacles_x_;
+    obstacles.y = obstacles_y_;
+    obstacles.r.assign(obstacles_x_.size(), obstacle_radius_);
+    world->obstacles = turtlelib::ObstacleGrid(
+      obstacles, get_parameter("obstacles/cell_size").as_double());
+
+    /// initialize attributes
+    period_ = 1.0 / rate_;
+
+    turtlelib::SimParams sim_params;
+    sim_params.period = period_;
+    sim_params.track_width = track_width_;
+    sim_params.wheel_radius = wheel_radius_;
+    sim_params.motor_cmd_per_rad_sec = motor_cmd_per_rad_sec_;
+    sim_params.encoder_ticks_per_rad = encoder_ticks_per_rad_;
+    sim_params.collision_radius = collision_radius_;
+    sim_params.input_noice = input_noice_;
+    sim_params.slip_fraction = slip_fraction_;
+    sim_params.basic_sensor_variance = basic_sensor_variance_;
+    sim_params.max_range = max_range_;
+    sim_params.lidar_range_min = lidar_range_min_;
+    sim_params.lidar_range_max = lidar_range_max_;
+    sim_params.lidar_accuracy = lidar_accuracy_;
+    sim_params.lidar_resolution = lidar_resolution_;
+    sim_ = turtlelib::WorldSim(
+      sim_params, world, static_cast<uint64_t>(get_parameter("seed").as_int()));
+
     if (!draw_only_) {
-      /// initialize attributes
-      period_ = 1.0 / rate_;
-      distribution_input_ = std::normal_distribution<double>(0.0, sqrt(input_noice_));
-      distribution_slip_ = std::uniform_real_distribution<double>(-slip_fraction_, slip_fraction_);
-      distribution_sensor_ = std::normal_distribution<double>(0.0, sqrt(basic_sensor_variance_));
-      distribution_laser_ = std::normal_distribution<double>(0.0, lidar_accuracy_ / 6.0);
-      reset_turtle_pose_();
+      for (const auto & robot : robots_) {
+        sim_.add_robot(robot.x0, robot.y0, robot.theta0);
+      }
+
+      sensor_sim_ = sim_;
+      left_cmd_.assign(robots_.size(), 0.0);
+      right_cmd_.assign(robots_.size(), 0.0);
+      pool_ = std::make_unique<turtlelib::WorkerPool>(static_cast<size_t>(lidar_threads));
 
       // set marker qos policy
       marker_qos_.transient_local();
       laser_qos_.transient_local();
 
-      /// timer
-      timer_ = create_wall_timer(
-        std::chrono::duration<long double>{period_},
-        std::bind(&NuSim::timer_callback_, this));
+      /// timer, a zero period fires on every spin so that commands are still taken between steps
+      auto timer_period = period_;
+      if (headless_) {
+        timer_period = speedup_ > 0.0 ? period_ / speedup_ : 0.0;
+        sim_time_ = rclcpp::Time(0, 0, RCL_ROS_TIME);
+        pub_clock_ = create_publisher<Clock>("/clock", 10);
+      }
+
+      if (lockstep_) {
+        srv_step_ = create_service<Step>(
+          "~/step",
+          std::bind(
+            &NuSim::srv_step_callback_, this, std::placeholders::_1,
+            std::placeholders::_2));
+      } else {
+        kinematics_timing_.name = "kinematics";
+        kinematics_timing_.period = timer_period;
+        timer_ = create_wall_timer(
+          std::chrono::duration<long double>{timer_period},
+          std::bind(&NuSim::timer_callback_, this));
+      }
+
+      /// In real time the sensors run on their own timer, so a slow scan never delays a step
+      if (!headless_) {
+        sensor_timing_.name = "sensors";
+        sensor_timing_.period = 0.2;
+        sensor_group_ = create_callback_group(rclcpp::CallbackGroupType::MutuallyExclusive);
+        sensor_timer_ = create_wall_timer(
+          std::chrono::duration<long double>{sensor_timing_.period},
+          std::bind(&NuSim::sensor_timer_callback_, this), sensor_group_);
+      }
 
       /// services
       srv_reset_ = create_service<Empty>(
@@ -876,27 +1322,47 @@ public:
           std::placeholders::_2));
 
       // subscribers
-      sub_wheel_cmd_ =
-        create_subscription<WheelCommands>(
-        "red/wheel_cmd", 10,
-        std::bind(&NuSim::sub_wheel_cmd_callback_, this, std::placeholders::_1));
+      ack_group_ = create_callback_group(rclcpp::CallbackGroupType::Reentrant);
+      rclcpp::SubscriptionOptions wheel_cmd_options;
+      wheel_cmd_options.callback_group = ack_group_;
+
+      for (size_t i = 0; i < robots_.size(); ++i) {
+        auto & robot = robots_.at(i);
+        const auto prefix = robots_.size() > 1 ? robot.name + "/" : std::string{};
+
+        robot.sub_wheel_cmd =
+          create_subscription<WheelCommands>(
+          robot.name + "/wheel_cmd", 10,
+          [this, i](WheelCommands::SharedPtr msg) {sub_wheel_cmd_callback_(i, msg);},
+          wheel_cmd_options);
+
+        // publishers
+        robot.pub_sensor_data = create_publisher<SensorData>(robot.name + "/sensor_data", 10);
+        robot.pub_fake_sensor_markers =
+          create_publisher<MarkerArray>(prefix + "fake_sensor", marker_qos_);
+        robot.pub_path = create_publisher<Path>("~/" + prefix + "path", 10);
+        robot.pub_laser_scan = create_publisher<LaserScan>(prefix + "scan", laser_qos_);
+        robot.pub_obstacles = create_publisher<ObstacleMeasurements>(prefix + "obs_pos", 10);
+      }
 
-      // publishers
       pub_timestep_ = create_publisher<UInt64>("~/timestep", 10);
-      pub_sensor_data_ = create_publisher<SensorData>("red/sensor_data", 10);
-      pub_fake_sensor_markers_ = create_publisher<MarkerArray>("fake_sensor", marker_qos_);
-      pub_path_ = create_publisher<Path>("~/path", 10);
-      pub_laser_scan_ = create_publisher<LaserScan>("scan", laser_qos_);
-      pub_obstacles_ = create_publisher<ObstacleMeasurements>("obs_pos", 10);
+      pub_timer_stats_ = create_publisher<TimerStats>("~/timer_stats", 10);
     }
     pub_wall_markers_ = create_publisher<MarkerArray>("~/walls", marker_qos_);
     pub_obstacle_markers_ = create_publisher<MarkerArray>("~/obstacles", marker_qos_);
+    pub_map_ = create_publisher<OccupancyGrid>("~/map", rclcpp::QoS(1).transient_local());
 
     /// transform broadcasters
     tf_broadcaster_ = std::make_unique<TransformBroadcaster>(*this);
 
-    publish_wall_markers_();
-    publish_obstacle_markers_();
+    if (!headless_) {
+      publish_wall_markers_();
+      publish_obstacle_markers_();
+    }
+
+    if (!map_yaml.empty()) {
+      publish_map_(map);
+    }
   }
 };
 
@@ -908,7 +1374,11 @@ int main(int argc, char ** argv)
 {
   rclcpp::init(argc, argv);
   auto node_nusim = std::make_shared<NuSim>();
-  rclcpp::spin(node_nusim);
+
+  /// The steps, the sensors and the wheel commands or acknowledgements each need a thread
+  rclcpp::executors::MultiThreadedExecutor executor(rclcpp::ExecutorOptions(), 3);
+  executor.add_node(node_nusim);
+  executor.spin();
 
   rclcpp::shutdown();
   return 0;
@@ -6,35 +6,59 @@
 ///
 /// PARAMETERS:
 ///   \param scan_frame_id  [sensor_msgs/msg/LaserScan]           Frame id of the scanned frame
+///   \param fit_threads    [int]                                 Threads fitting circles besides the callback
+///   \param parallel_threshold [int]                             Smallest number of clusters fitted in parallel
+///   \param min_radius     [double]                              Smallest radius of a detected circle
+///   \param max_radius     [double]                              Largest radius of a detected circle
+///   \param fit_mode       [string]                              Circle fit, algebraic or ransac
+///   \param ransac_threshold [double]                            Largest distance of a RANSAC inlier
+///   \param ransac_iterations [int]                              Budget of RANSAC iterations per cluster
+///   \param adaptive_breakpoint [bool]                           Split clusters at a range dependent distance
+///   \param breakpoint_lambda [double]                           Smallest angle between a surface and a beam
+///   \param range_sigma    [double]                              Standard deviation of the range noise
+///   \param tracking       [bool]                                Track circles over scans with odometry
+///   \param track_gate     [double]                              Largest distance of a cluster to its track
+///   \param track_iterations [int]                               Refinement iterations of a tracked circle
 ///
 /// SUBSCRIPTIONS:
 ///   scan                  [sensor_msgs/msg/LaserScan]           Scanned laser scan data
+///   odom                  [nav_msgs/msg/Odometry]               Odometry predicting tracked circles
 ///
 /// PUBLISHERS:
 ///   ~/detect              [visualization_msgs/msg/MarkerArray]  Detected landmarks
 ///   detect/circles        [nuturtle_interfaces/msg/Circles]     Position of the detected circles.
+///   ~/dropped_scans       [std_msgs/msg/UInt64]                 Scans replaced by a newer one before detection
 ///
 /// \copyright Copyright (c) 2024
-#include <armadillo>
-#include <iostream>
-#include <limits>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
-#include <iterator>
 
 #include <rclcpp/rclcpp.hpp>
 
 #include <rcl_interfaces/msg/parameter_descriptor.hpp>
 #include <sensor_msgs/msg/laser_scan.hpp>
+#include <nav_msgs/msg/odometry.hpp>
+#include <std_msgs/msg/u_int64.hpp>
 #include <visualization_msgs/msg/marker_array.hpp>
 #include <visualization_msgs/msg/marker.hpp>
 #include "nuturtle_interfaces/msg/circle.hpp"
 #include "nuturtle_interfaces/msg/circles.hpp"
 
 #include "turtlelib/detect.hpp"
-#include "turtlelib/ekf_slam.hpp"
+#include "turtlelib/circle_tracker.hpp"
+#include "turtlelib/mailbox.hpp"
+#include "turtlelib/scan_segment.hpp"
+#include "turtlelib/worker_pool.hpp"
 
 using rcl_interfaces::msg::ParameterDescriptor;
 using sensor_msgs::msg::LaserScan;
+using nav_msgs::msg::Odometry;
+using std_msgs::msg::UInt64;
 using visualization_msgs::msg::MarkerArray;
 using visualization_msgs::msg::Marker;
 using nuturtle_interfaces::msg::Circle;
@@ -44,178 +68,175 @@ using nuturtle_interfaces::msg::Circles;
 class Landmark : public rclcpp::Node
 {
 private:
-  /// @brief Callback function of the scan message
+  /// @brief Callback function of the scan message, handing the scan to the detection thread
   /// @param msg The subcribed scan message
-  void sub_scan_callback_(LaserScan::SharedPtr msg)
+  void sub_scan_callback_(LaserScan::UniquePtr msg)
   {
-    scan_frame_id_ = msg->header.frame_id;
-    const auto angle_min = msg->angle_min;
-    const auto angle_inc = msg->angle_increment;
-    const auto data = msg->ranges;
-    const auto range_min = msg->range_min;
-    const auto range_max = msg->range_max;
+    mailbox_.put(std::move(msg));
 
-    bool detect_flag = false;
-    bool on_start = true;
-
-    std::vector<turtlelib::Point2D> data_points;
-    std::vector<turtlelib::Point2D> start_points;
-    data_points.clear();
-
-    turtlelib::Point2D pre_data{1e10, 1e10};
-
-    for (size_t i = 0; i < data.size(); ++i) {
-      const auto theta = angle_min + i * angle_inc;
-      const auto range = data.at(i);
-
-      const auto x = range * cos(theta);
-      const auto y = range * sin(theta);
-
-
-      if (range > range_min && range < range_max) {
-
-        const turtlelib::Point2D point{x, y};
-
-        if ((turtlelib::almost_equal(pre_data.x, 1e10) &&
-          turtlelib::almost_equal(pre_data.y, 1e10)))
-        {
-          // pre_index = i;
-          pre_data.x = point.x;
-          pre_data.y = point.y;
-          continue;
-        }
+    /// Passing through the lock keeps the wake up from falling between check and wait
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+    }
+    wake_cv_.notify_one();
+  }
 
-        if (on_start) {
-          start_points.push_back(pre_data);
-        } else {
-          data_points.push_back(pre_data);
-        }
-        const auto dist = sqrt(pow(pre_data.x - point.x, 2.0) + pow(pre_data.y - point.y, 2.0));
+  /// @brief Detect circles in the newest scan until the node stops
+  void detect_loop_()
+  {
+    uint64_t dropped_reported = 0;
 
-        if (dist >= 0.5) {
-          if (data_points.size() >= 4) {
-            detect_flag = true;
-          } else {
-            data_points.clear();
-          }
-        }
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_cv_.wait(lock, [this]() {return stop_ || !mailbox_.empty();});
 
-        // pre_data = point;
-        pre_data.x = point.x;
-        pre_data.y = point.y;
-        // pre_index = i;
-        RCLCPP_DEBUG_STREAM(get_logger(), i << ": " << point << " dist: " << dist);
-      } else {
-        if (on_start) {
-          on_start = false;
-        } else if (i == data.size() - 1) {
-          data_points.insert(
-            data_points.end(),
-            std::make_move_iterator(start_points.begin()),
-            std::make_move_iterator(start_points.end())
-          );
-
-          if (data_points.size() >= 4) {
-            detect_flag = true;
-          }
-        } else if (data_points.size() >= 4) {
-          RCLCPP_DEBUG_STREAM(get_logger(), data_points.size() << " " << i);
-          detect_flag = true;
-          pre_data.x = 1e10;
-          pre_data.y = 1e10;
-        } else {
-          on_start = false;
-          if (data_points.size() > 0) {
-            RCLCPP_WARN_STREAM(
-              get_logger(),
-              "Ignoring data with size of " << data_points.size() << " at index of " << i);
-          }
-          data_points.clear();
-          detect_flag = false;
+        if (stop_) {
+          return;
         }
       }
 
+      const auto scan = mailbox_.take();
 
-      if (detect_flag) {
-        RCLCPP_DEBUG_STREAM(get_logger(), "Start detecting " << data_points.size() << " ...");
-        detection_.update_data(data_points);
-
-        const double x_hat = detection_.compute_x_mean();
-        const double y_hat = detection_.compute_y_mean();
-
-        detection_.shift_coordinate(x_hat, y_hat);
-        const double z_bar = detection_.compute_z_mean();
+      if (!scan) {
+        continue;
+      }
 
-        const arma::mat Z_mat = detection_.construct_Z_mat();
-        const arma::mat M_mat = detection_.compute_M_mat(Z_mat);
-        const arma::mat H_mat = detection_.construct_H_mat(z_bar);
-        const arma::mat H_inv = H_mat.i();
+      /// An exception would otherwise end the thread and the node with it
+      try {
+        detect_(*scan);
+      } catch (const std::exception & e) {
+        RCLCPP_ERROR_STREAM(get_logger(), "Detection failed: " << e.what());
+      }
 
-        RCLCPP_DEBUG_STREAM(get_logger(), "Z_mat: " << std::endl << Z_mat);
+      const auto dropped = mailbox_.dropped();
 
-        arma::mat U_mat;
-        arma::vec sigma_vec;
-        arma::mat V_mat;
+      if (dropped != dropped_reported) {
+        UInt64 msg_dropped;
+        msg_dropped.data = dropped;
+        pub_dropped_scans_->publish(msg_dropped);
+        dropped_reported = dropped;
+      }
+    }
+  }
 
-        arma::svd(U_mat, sigma_vec, V_mat, Z_mat);
-        const arma::mat Sigma_mat = arma::diagmat(sigma_vec);
+  /// @brief Detect the circles of a scan and publish them
+  /// @param msg The scan
+  void detect_(const LaserScan & msg)
+  {
+    scan_frame_id_ = msg.header.frame_id;
 
-        RCLCPP_DEBUG_STREAM(get_logger(), "sigma_vec: " << std::endl << sigma_vec);
-        RCLCPP_DEBUG_STREAM(get_logger(), "Sigma_mat: " << std::endl << Sigma_mat);
+    /// Move the tracked circles into this scan by the odometry since the last scan
+    turtlelib::Transform2D Tob;
+    {
+      std::lock_guard<std::mutex> lock(odom_mutex_);
+      Tob = Tob_;
+    }
 
-        const double sigma_min = sigma_vec.min();
-        RCLCPP_DEBUG_STREAM(get_logger(), "sigma_min: " << sigma_min);
+    const auto Tos = Tob * Tbs_;
+    tracker_.predict(Tos.inv() * Tos_prev_);
+    Tos_prev_ = Tos;
+
+    const auto & clusters = segmenter_.segment(
+      msg.ranges,
+      msg.angle_min,
+      msg.angle_increment,
+      msg.range_min,
+      msg.range_max);
+
+    /// Every cluster writes its own slot, so the circles keep the scan order
+    fits_.resize(clusters.size());
+    matches_.assign(clusters.size(), -1);
+
+    const auto fit = [this, &clusters](size_t index, size_t worker) {
+        const auto & cluster = clusters[index];
+        const auto x = segmenter_.x().data() + cluster.begin;
+        const auto y = segmenter_.y().data() + cluster.begin;
+        const auto num = cluster.end - cluster.begin;
+
+        if (tracking_) {
+          const auto track = tracker_.match(x, y, num);
+
+          if (track != -1) {
+            /// Warm start from the predicted circle instead of fitting from scratch
+            const auto circle = turtlelib::refine_circle(
+              x, y, num, tracker_.tracks().at(track).circle, track_iterations_);
+
+            if (
+              classifier_.in_radius_gate(circle) &&
+              turtlelib::geometric_residual(x, y, num, circle) <= track_gate_)
+            {
+              fits_[index] = {circle, turtlelib::fit_quality(x, y, num, circle), {0.0, 0.0}, true};
+              matches_[index] = track;
+              return;
+            }
+          }
+        }
 
-        arma::mat A_vec;
-        if (sigma_min < 1e-12) {
-          A_vec = V_mat.col(3);
+        if (ransac_.empty()) {
+          fits_[index] = classifier_.fit(x, y, num);
         } else {
-          const arma::mat Y_mat = V_mat * Sigma_mat * V_mat.t();
-          const arma::mat Q_mat = Y_mat * H_inv * Y_mat;
-
-          arma::vec eig_val;
-          arma::mat eig_vec;
-          arma::eig_sym(eig_val, eig_vec, Q_mat);
-          RCLCPP_DEBUG_STREAM(get_logger(), "Eigen value: " << std::endl << eig_vec << eig_val);
-
-          const int min_eig_ind = eig_val.index_min();
-          const arma::vec A_star_vec = eig_vec.col(min_eig_ind);
-
-          A_vec = arma::solve(Y_mat, A_star_vec);
+          /// Seeded by the cluster index, so the circles do not depend on the scheduling
+          fits_[index] = classifier_.fit(
+            x, y, num, ransac_[worker], static_cast<uint32_t>(index));
         }
+      };
 
-        RCLCPP_DEBUG_STREAM(get_logger(), "A_vec: " << std::endl << A_vec);
+    if (clusters.size() >= parallel_threshold_) {
+      pool_->parallel_for(clusters.size(), fit);
+    } else {
+      for (size_t i = 0; i < clusters.size(); ++i) {
+        fit(i, 0);
+      }
+    }
 
-        const double A1 = A_vec(0);
-        const double A2 = A_vec(1);
-        const double A3 = A_vec(2);
-        const double A4 = A_vec(3);
+    landmark_matches_.clear();
+    landmark_qualities_.clear();
 
-        const double a = -A2 / (2.0 * A1);
-        const double b = -A3 / (2.0 * A1);
-        const double R2 = (pow(A2, 2.0) + pow(A3, 2.0) - 4.0 * A1 * A4) / (4.0 * pow(A1, 2.0));
+    for (size_t i = 0; i < fits_.size(); ++i) {
+      const auto & cluster_fit = fits_[i];
 
-        const double center_x = a + x_hat;
-        const double center_y = b + y_hat;
-        const double R = sqrt(R2);
+      if (!cluster_fit.is_circle) {
+        RCLCPP_DEBUG_STREAM(
+          get_logger(), "rejected cluster, inscribed angle " << cluster_fit.angles.mean <<
+            " +- " << cluster_fit.angles.stddev << ", radius " << cluster_fit.circle.r);
+        continue;
+      }
 
-        const turtlelib::Point2D center{center_x, center_y};
-        RCLCPP_DEBUG_STREAM(get_logger(), "fit center: " << center);
-        RCLCPP_DEBUG_STREAM(get_logger(), "fit radius: " << R);
-        landmarks_.push_back({center_x, center_y, R});
+      const auto & landmark = cluster_fit.circle;
+      RCLCPP_DEBUG_STREAM(
+        get_logger(), "fit center: " << turtlelib::Point2D{landmark.x, landmark.y});
+      RCLCPP_DEBUG_STREAM(get_logger(), "fit radius: " << landmark.r);
+      landmarks_.push_back(landmark);
+      landmark_matches_.push_back(matches_[i]);
+      landmark_qualities_.push_back(cluster_fit.quality);
+    }
 
-        data_points.clear();
-        detect_flag = false;
-      }
+    if (tracking_) {
+      landmark_ids_ = tracker_.update(landmarks_, landmark_matches_);
+    } else {
+      landmark_ids_.assign(landmarks_.size(), -1);
     }
 
     if (landmarks_.size() > 0) {
-      publish_markers_(msg->header.stamp);
+      publish_markers_(msg.header.stamp);
       publish_measurements_();
       landmarks_.clear();
     }
   }
 
+  /// @brief Callback function of the odometry message
+  /// @param msg The subcribed odometry message
+  void sub_odom_callback_(Odometry::SharedPtr msg)
+  {
+    const auto & q = msg->pose.pose.orientation;
+    const auto theta = atan2(2.0 * (q.w * q.z + q.x * q.y), 1.0 - 2.0 * (q.y * q.y + q.z * q.z));
+
+    std::lock_guard<std::mutex> lock(odom_mutex_);
+    Tob_ = turtlelib::Transform2D(
+      {msg->pose.pose.position.x, msg->pose.pose.position.y}, theta);
+  }
+
   /// @brief Publish detected circles as markers
   /// @param time_stamp The timestamp of the marker
   void publish_markers_(rclcpp::Time time_stamp)
@@ -264,6 +285,10 @@ private:
       msg_circle.x = pb.x;
       msg_circle.y = pb.y;
       msg_circle.r = landmark.r;
+      msg_circle.id = landmark_ids_.at(i);
+      msg_circle.residual = landmark_qualities_.at(i).residual;
+      msg_circle.num_points = landmark_qualities_.at(i).num_points;
+      msg_circle.angular_span = landmark_qualities_.at(i).angular_span;
 
       msg_circles.circles.push_back(msg_circle);
     }
@@ -274,13 +299,42 @@ private:
   rclcpp::QoS marker_qos_;
 
   rclcpp::Subscription<LaserScan>::SharedPtr sub_scan_;
+  rclcpp::Subscription<Odometry>::SharedPtr sub_odom_;
 
   rclcpp::Publisher<MarkerArray>::SharedPtr pub_detect_marker_;
   rclcpp::Publisher<Circles>::SharedPtr pub_detect_circle_;
+  rclcpp::Publisher<UInt64>::SharedPtr pub_dropped_scans_;
+
+  /// Detection thread, fed the newest scan through the mailbox
+  turtlelib::LatestMailbox<LaserScan> mailbox_;
+  std::thread detect_thread_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  bool stop_;
 
   std::string scan_frame_id_;
 
-  turtlelib::CircleDetect detection_;
+  turtlelib::ScanSegmenter segmenter_;
+  std::unique_ptr<turtlelib::WorkerPool> pool_;
+  size_t parallel_threshold_;
+  turtlelib::CircleClassifier classifier_;
+  std::vector<turtlelib::ClusterFit> fits_;
+
+  /// One RANSAC fit per worker, empty for the algebraic fit
+  std::vector<turtlelib::RansacCircleFit> ransac_;
+
+  /// Circle tracking
+  bool tracking_;
+  double track_gate_;
+  size_t track_iterations_;
+  turtlelib::CircleTracker tracker_;
+  std::mutex odom_mutex_;
+  turtlelib::Transform2D Tob_;
+  turtlelib::Transform2D Tos_prev_;
+  std::vector<int> matches_;
+  std::vector<int> landmark_matches_;
+  std::vector<int> landmark_ids_;
+  std::vector<turtlelib::FitQuality> landmark_qualities_;
   std::vector<turtlelib::Landmark> landmarks_;
   double marker_radius_;
   double marker_height_;
@@ -288,18 +342,116 @@ private:
 
 public:
   Landmark()
-  : rclcpp::Node("landmark"), marker_qos_(10), marker_radius_(0.038), marker_height_(0.25),
+  : rclcpp::Node("landmark"), marker_qos_(10), stop_(false), marker_radius_(0.038),
+    marker_height_(0.25),
     Tbs_({-0.032, 0.0}, 0.0)
   {
     ParameterDescriptor scan_frame_id_des;
+    ParameterDescriptor fit_threads_des;
+    ParameterDescriptor parallel_threshold_des;
+    ParameterDescriptor min_radius_des;
+    ParameterDescriptor max_radius_des;
+    ParameterDescriptor fit_mode_des;
+    ParameterDescriptor ransac_threshold_des;
+    ParameterDescriptor ransac_iterations_des;
+    ParameterDescriptor adaptive_breakpoint_des;
+    ParameterDescriptor breakpoint_lambda_des;
+    ParameterDescriptor range_sigma_des;
+    ParameterDescriptor tracking_des;
+    ParameterDescriptor track_gate_des;
+    ParameterDescriptor track_iterations_des;
 
     scan_frame_id_des.description = "Frame id of the scan frame";
+    fit_threads_des.description = "Number of threads fitting circles besides the scan callback";
+    parallel_threshold_des.description =
+      "Smallest number of clusters in a scan to fit them in parallel";
+    min_radius_des.description = "Smallest radius of a detected circle";
+    max_radius_des.description = "Largest radius of a detected circle";
+    fit_mode_des.description =
+      "Circle fit: algebraic, or ransac for clusters mixing an obstacle and a wall";
+    ransac_threshold_des.description = "Largest distance of a RANSAC inlier from the circle";
+    ransac_iterations_des.description = "Largest number of RANSAC iterations per cluster";
+    adaptive_breakpoint_des.description =
+      "Whether to split clusters at a distance growing with the range instead of 0.5 m";
+    breakpoint_lambda_des.description =
+      "Smallest angle between a surface and a beam for the adaptive breakpoint (rad)";
+    range_sigma_des.description = "Standard deviation of the range noise (m)";
+    tracking_des.description = "Whether to track circles over scans and publish their track ids";
+    track_gate_des.description =
+      "Largest root mean square distance of a cluster to its predicted circle";
+    track_iterations_des.description = "Number of refinement iterations of a tracked circle";
 
     /// Parameters
     declare_parameter("scan_frame_id", "scan", scan_frame_id_des);
+    declare_parameter<int>("fit_threads", 3, fit_threads_des);
+    declare_parameter<int>("parallel_threshold", 8, parallel_threshold_des);
+    declare_parameter<double>("min_radius", 0.01, min_radius_des);
+    declare_parameter<double>("max_radius", 0.1, max_radius_des);
+    declare_parameter<std::string>("fit_mode", "algebraic", fit_mode_des);
+    declare_parameter<double>("ransac_threshold", 0.01, ransac_threshold_des);
+    declare_parameter<int>("ransac_iterations", 100, ransac_iterations_des);
+    declare_parameter<bool>("adaptive_breakpoint", true, adaptive_breakpoint_des);
+    declare_parameter<double>("breakpoint_lambda", 0.17, breakpoint_lambda_des);
+    declare_parameter<double>("range_sigma", 0.015, range_sigma_des);
+    declare_parameter<bool>("tracking", true, tracking_des);
+    declare_parameter<double>("track_gate", 0.03, track_gate_des);
+    declare_parameter<int>("track_iterations", 3, track_iterations_des);
 
     // Parameter values
     scan_frame_id_ = get_parameter("scan_frame_id").as_string();
+    const auto fit_threads = get_parameter("fit_threads").as_int();
+    const auto parallel_threshold = get_parameter("parallel_threshold").as_int();
+
+    if (fit_threads < 0 || parallel_threshold < 1) {
+      RCLCPP_ERROR_STREAM(get_logger(), "Invalid fit_threads or parallel_threshold");
+      throw std::invalid_argument("Invalid fit_threads or parallel_threshold");
+    }
+
+    pool_ = std::make_unique<turtlelib::WorkerPool>(static_cast<size_t>(fit_threads));
+    parallel_threshold_ = static_cast<size_t>(parallel_threshold);
+
+    /// Default inscribed angle thresholds with the configured radius gate
+    classifier_ = turtlelib::CircleClassifier(
+      turtlelib::deg2rad(90.0), turtlelib::deg2rad(135.0), 0.15,
+      get_parameter("min_radius").as_double(), get_parameter("max_radius").as_double());
+
+    const auto fit_mode = get_parameter("fit_mode").as_string();
+
+    if (fit_mode == "ransac") {
+      const auto ransac_iterations = get_parameter("ransac_iterations").as_int();
+
+      if (ransac_iterations < 1) {
+        RCLCPP_ERROR_STREAM(get_logger(), "Invalid ransac_iterations");
+        throw std::invalid_argument("Invalid ransac_iterations");
+      }
+
+      ransac_.assign(
+        pool_->num_workers(),
+        turtlelib::RansacCircleFit(
+          get_parameter("ransac_threshold").as_double(),
+          static_cast<size_t>(ransac_iterations), 0.99));
+    } else if (fit_mode != "algebraic") {
+      RCLCPP_ERROR_STREAM(get_logger(), "Invalid fit_mode " << fit_mode);
+      throw std::invalid_argument("Invalid fit_mode");
+    }
+
+    if (get_parameter("adaptive_breakpoint").as_bool()) {
+      segmenter_.use_adaptive_threshold(
+        get_parameter("breakpoint_lambda").as_double(),
+        get_parameter("range_sigma").as_double());
+    }
+
+    tracking_ = get_parameter("tracking").as_bool();
+    track_gate_ = get_parameter("track_gate").as_double();
+    const auto track_iterations = get_parameter("track_iterations").as_int();
+
+    if (track_gate_ <= 0.0 || track_iterations < 1) {
+      RCLCPP_ERROR_STREAM(get_logger(), "Invalid track_gate or track_iterations");
+      throw std::invalid_argument("Invalid track_gate or track_iterations");
+    }
+
+    track_iterations_ = static_cast<size_t>(track_iterations);
+    tracker_ = turtlelib::CircleTracker(track_gate_, 3);
 
     /// QoS
     marker_qos_.transient_local();
@@ -309,10 +461,27 @@ public:
       create_subscription<LaserScan>(
       "scan", 10,
       std::bind(&Landmark::sub_scan_callback_, this, std::placeholders::_1));
+    sub_odom_ =
+      create_subscription<Odometry>(
+      "odom", 10,
+      std::bind(&Landmark::sub_odom_callback_, this, std::placeholders::_1));
 
     /// Publishers
     pub_detect_marker_ = create_publisher<MarkerArray>("~/detect", marker_qos_);
     pub_detect_circle_ = create_publisher<Circles>("detect/circles", 10);
+    pub_dropped_scans_ = create_publisher<UInt64>("~/dropped_scans", 10);
+
+    detect_thread_ = std::thread(&Landmark::detect_loop_, this);
+  }
+
+  ~Landmark()
+  {
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+      stop_ = true;
+    }
+    wake_cv_.notify_one();
+    detect_thread_.join();
   }
 };
 
@@ -323,6 +492,8 @@ int main(int argc, char ** argv)
   auto node_landmark = std::make_shared<Landmark>();
   rclcpp::spin(node_landmark);
 
+  /// The destructor joins the detection thread, which still publishes through the context
+  node_landmark.reset();
   rclcpp::shutdown();
-  exit(EXIT_SUCCESS);
+  return 0;
 }
@@ -13,6 +13,17 @@
 ///   \param basic_sensor_variance  [double]  The variance of the sensor
 ///   \param distance_threshold     [double]  The maximum distance to for considering as same landmark.
 ///   \param use_laser_scan         [bool]    Whether to use the laser scan data instead of fake sensor.
+///   \param ground_truth_frame     [string]  The ground truth body frame for NEES, empty to disable.
+///   \param diagnostics_rate       [double]  The rate of publishing the consistency statistics.
+///   \param consistency_window     [int]     The number of samples in the NIS/NEES rolling window.
+///   \param map_file               [string]  The binary map file loaded on start, empty to start blank.
+///   \param mode                   [string]  "slam" to map, or "localize" against the frozen map_file.
+///   \param auto_relocalize        [bool]    Whether to relocalize when the NIS shows divergence.
+///   \param loop_closure           [bool]    Whether to merge landmarks duplicated on a revisit.
+///   \param loop_closure_radius    [double]  The largest distance between a landmark and its duplicate.
+///   \param max_fit_residual       [double]  The largest circle fit residual used for a correction.
+///   \param min_fit_points         [int]     The fewest circle fit points used for a correction.
+///   \param min_fit_span           [double]  The smallest circle fit angular span used for a correction.
 ///
 /// SUBSCRIPTIONS:
 ///   joint_states    [sensor_msgs/msg/JointState]                    The joint state of the robot.
@@ -23,18 +34,28 @@
 ///   odom          [nav_msgs/msg/Odomoetry]                        The odometry of the node.
 ///   path          [nav_msgs//msgPath]                             The path robot follows.
 ///   ~/map         [visualization/msg/MarkerArray]                 The mapped obstacle markers.
+///   /diagnostics  [diagnostic_msgs/msg/DiagnosticArray]           The NIS/NEES filter consistency.
 ///
 /// SERVICES:
 ///   initial_pose [nuturtle_interfaces/srv/InitialPose]            Reset the initial pose.
+///   ~/save_map   [nuturtle_interfaces/srv/MapFile]                Save the map to a binary file.
+///   ~/load_map   [nuturtle_interfaces/srv/MapFile]                Load the map from a binary file.
+///   ~/relocalize [std_srvs/srv/Empty]                             Recover the pose from the last scan.
 ///
 /// \version 0.1
 /// \date 2024-02-15
 ///
 /// \copyright Copyright (c) 2024
+#include <array>
 #include <chrono>
+#include <filesystem>
+#include <unordered_map>
 
 #include <rclcpp/rclcpp.hpp>
 #include <tf2_ros/transform_broadcaster.h>
+#include <tf2_ros/transform_listener.h>
+#include <tf2_ros/buffer.h>
+#include <tf2/exceptions.h>
 #include <rclcpp/qos.hpp>
 
 #include <rcl_interfaces/msg/parameter_descriptor.hpp>
@@ -47,15 +68,25 @@
 #include <geometry_msgs/msg/pose_stamped.hpp>
 #include <visualization_msgs/msg/marker_array.hpp>
 #include <visualization_msgs/msg/marker.hpp>
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <diagnostic_msgs/msg/diagnostic_status.hpp>
+#include <diagnostic_msgs/msg/key_value.hpp>
+#include <std_srvs/srv/empty.hpp>
 #include "nuturtle_interfaces/msg/obstacle_measurements.hpp"
 #include "nuturtle_interfaces/msg/circle.hpp"
 #include "nuturtle_interfaces/msg/circles.hpp"
 
 #include "nuturtle_interfaces/srv/initial_pose.hpp"
+#include "nuturtle_interfaces/srv/map_file.hpp"
 
 #include "turtlelib/diff_drive.hpp"
 #include "turtlelib/ekf_slam.hpp"
 #include "turtlelib/detect.hpp"
+#include "turtlelib/consistency.hpp"
+#include "turtlelib/map_io.hpp"
+#include "turtlelib/pose_ekf.hpp"
+#include "turtlelib/relocalize.hpp"
+#include "turtlelib/loop_closure.hpp"
 
 using namespace std::chrono_literals;
 
@@ -72,12 +103,17 @@ using geometry_msgs::msg::TransformStamped;
 using geometry_msgs::msg::PoseStamped;
 using visualization_msgs::msg::MarkerArray;
 using visualization_msgs::msg::Marker;
+using diagnostic_msgs::msg::DiagnosticArray;
+using diagnostic_msgs::msg::DiagnosticStatus;
+using diagnostic_msgs::msg::KeyValue;
 using nuturtle_interfaces::msg::ObstacleMeasurements;
 using nuturtle_interfaces::msg::Measurement;
 using nuturtle_interfaces::msg::Circle;
 using nuturtle_interfaces::msg::Circles;
 
 using nuturtle_interfaces::srv::InitialPose;
+using nuturtle_interfaces::srv::MapFile;
+using std_srvs::srv::Empty;
 
 /// \brief The slam algorithm based on Extended Kalman Filter
 class Slam : public Node
@@ -134,6 +170,19 @@ private:
   {
     obs_measure_ = *msg;
 
+    last_observations_.clear();
+    last_noise_scales_.clear();
+    for (const auto & measure : msg->measurements) {
+      last_observations_.push_back({measure.x, measure.y});
+      last_noise_scales_.push_back(1.0);
+    }
+
+    if (localize_mode_) {
+      localize_(last_observations_, last_noise_scales_);
+      check_divergence_();
+      return;
+    }
+
     const turtlelib::Transform2D Tob(
       {turtlebot_.config_x(), turtlebot_.config_y()},
       turtlebot_.config_theta()
@@ -185,6 +234,7 @@ private:
         state_curr(3 + 2 * uid + 1) = landmark_pos.y;
 
         ++landmarks_seen_;
+        relocalizer_stale_ = true;
       }
 
       turtlelib::Point2D pm_land{landmark_pos.x, landmark_pos.y};
@@ -210,13 +260,14 @@ private:
       RCLCPP_DEBUG_STREAM(get_logger(), "H_mat: " << std::endl << H_mat);
 
       const arma::mat R_mat = sensor_noice_ * arma::mat(2, 2, arma::fill::eye);
-      const arma::mat K_mat = Sigma_curr * H_mat.t() *
-        (H_mat * Sigma_curr * H_mat.t() + R_mat).i();
+      const arma::mat S_mat = H_mat * Sigma_curr * H_mat.t() + R_mat;
+      const arma::mat K_mat = Sigma_curr * H_mat.t() * S_mat.i();
       RCLCPP_DEBUG_STREAM(get_logger(), "K_mat: " << std::endl << K_mat);
 
       arma::vec dz_vec = z_vec - z_hat;
       dz_vec.at(1) = turtlelib::normalize_angle(dz_vec.at(1));
       RCLCPP_DEBUG_STREAM(get_logger(), "dz_vec: " << std::endl << dz_vec);
+      record_innovation_(dz_vec, S_mat);
 
       arma::vec update = K_mat * dz_vec;
       update.at(0) = turtlelib::normalize_angle(update.at(0));
@@ -238,15 +289,39 @@ private:
 
     update_map_odom_tf_(x_new, y_new, theta_new);
     publish_map_markers();
+    record_estimate_(state_curr, Sigma_curr);
 
     turtle_slam_.update_covariance(Sigma_curr);
     turtle_slam_.update_state(x_new, y_new, theta_new);
+    check_divergence_();
   }
 
   /// @brief Perform the SLAM algorith along with the landmark detection.
   /// @param msg The subcribed circles.
   void sub_detect_circles_callback_(Circles::SharedPtr msg)
   {
+    last_observations_.clear();
+    last_noise_scales_.clear();
+    for (const auto & circle : msg->circles) {
+      const auto quality = fit_quality_of_(circle);
+
+      /// Poorly supported centers are kept out of the pose filter and the relocalizer too
+      if (!fit_gate_.accept(quality)) {
+        continue;
+      }
+
+      last_observations_.push_back({circle.x, circle.y});
+      last_noise_scales_.push_back(fit_gate_.noise_scale(quality));
+    }
+
+    if (localize_mode_) {
+      localize_(last_observations_, last_noise_scales_);
+      check_divergence_();
+      return;
+    }
+
+    const auto landmarks_before = landmarks_seen_;
+
     const turtlelib::Transform2D Tob(
       {turtlebot_.config_x(), turtlebot_.config_y()},
       turtlebot_.config_theta()
@@ -278,7 +353,17 @@ private:
 
     for (size_t i = 0; i < msg->circles.size(); ++i) {
       const auto circle = msg->circles.at(i);
-      const auto uid = get_landmark_id(circle);
+      const auto quality = fit_quality_of_(circle);
+
+      /// A poorly supported center would pull the map more than it tells
+      if (!fit_gate_.accept(quality)) {
+        RCLCPP_DEBUG_STREAM(
+          get_logger(), "Skipped circle, residual " << circle.residual << ", " <<
+            circle.num_points << " points, span " << circle.angular_span);
+        continue;
+      }
+
+      const auto uid = associate_circle_(circle);
       const auto x = circle.x;
       const auto y = circle.y;
       RCLCPP_DEBUG_STREAM(get_logger(), "uid: " << uid);
@@ -298,6 +383,7 @@ private:
         state_curr(3 + 2 * uid + 1) = landmark_pos.y;
 
         ++landmarks_seen_;
+        relocalizer_stale_ = true;
       }
 
       turtlelib::Point2D pm_land{landmark_pos.x, landmark_pos.y};
@@ -322,14 +408,16 @@ private:
       const arma::mat H_mat = turtle_slam_.get_H_mat(est_world, uid);
       RCLCPP_DEBUG_STREAM(get_logger(), "H_mat: " << std::endl << H_mat);
 
-      const arma::mat R_mat = sensor_noice_ * arma::mat(2, 2, arma::fill::eye);
-      const arma::mat K_mat = Sigma_curr * H_mat.t() *
-        (H_mat * Sigma_curr * H_mat.t() + R_mat).i();
+      const arma::mat R_mat = sensor_noice_ * fit_gate_.noise_scale(quality) *
+        arma::mat(2, 2, arma::fill::eye);
+      const arma::mat S_mat = H_mat * Sigma_curr * H_mat.t() + R_mat;
+      const arma::mat K_mat = Sigma_curr * H_mat.t() * S_mat.i();
       RCLCPP_DEBUG_STREAM(get_logger(), "K_mat: " << std::endl << K_mat);
 
       arma::vec dz_vec = z_vec - z_hat;
       dz_vec.at(1) = turtlelib::normalize_angle(dz_vec.at(1));
       RCLCPP_DEBUG_STREAM(get_logger(), "dz_vec: " << std::endl << dz_vec);
+      record_innovation_(dz_vec, S_mat);
 
       arma::vec update = K_mat * dz_vec;
       update.at(0) = turtlelib::normalize_angle(update.at(0));
@@ -351,12 +439,205 @@ private:
 
     update_map_odom_tf_(x_new, y_new, theta_new);
     publish_map_markers();
+    record_estimate_(state_curr, Sigma_curr);
 
     turtle_slam_.update_covariance(Sigma_curr);
     turtle_slam_.update_state(x_new, y_new, theta_new);
+
+    if (loop_closure_ && landmarks_seen_ > landmarks_before) {
+      close_loops_();
+    }
+
+    expire_tracks_();
+    check_divergence_();
   }
 
 
+  /// \brief Correct the robot pose against the frozen map, leaving the landmarks untouched
+  /// \param observations The observed landmarks in the body frame
+  /// \param noise_scales The factor on the sensor noise of every observation
+  void localize_(
+    const std::vector<turtlelib::Point2D> & observations,
+    const std::vector<double> & noise_scales)
+  {
+    const turtlelib::Transform2D Tob(
+      {turtlebot_.config_x(), turtlebot_.config_y()},
+      turtlebot_.config_theta()
+    );
+    const auto Tmb = Tmo_ * Tob;
+
+    const std::array<double, 9> Q{
+      input_noice_, 0.0, 0.0,
+      0.0, input_noice_, 0.0,
+      0.0, 0.0, input_noice_};
+    pose_ekf_.predict({Tmb.rotation(), Tmb.translation().x, Tmb.translation().y}, Q);
+
+    for (size_t i = 0; i < observations.size(); ++i) {
+      const auto & pb = observations.at(i);
+      const auto pose = pose_ekf_.get_robot_state();
+      const turtlelib::Transform2D Tmb_est({pose.x, pose.y}, pose.theta);
+      const auto index = pose_ekf_.associate(Tmb_est(pb));
+
+      if (index == -1) {
+        RCLCPP_DEBUG_STREAM(get_logger(), "No landmark near " << pb);
+        continue;
+      }
+
+      const auto innovation = pose_ekf_.correct(pb, index, sensor_noice_ * noise_scales.at(i));
+      nis_stats_.add(turtlelib::compute_nis(innovation.dz, innovation.S));
+    }
+
+    const auto pose = pose_ekf_.get_robot_state();
+    update_map_odom_tf_(pose.x, pose.y, pose.theta);
+    turtle_slam_.update_state(pose.x, pose.y, pose.theta);
+
+    pose_est_ = {pose.theta, pose.x, pose.y};
+    pose_cov_ = pose_ekf_.get_covariance();
+    pose_est_stamp_ = get_clock()->now();
+    pose_est_pending_ = true;
+  }
+
+  /// \brief Merge the landmarks initialized again when a constellation is revisited
+  void close_loops_()
+  {
+    std::vector<turtlelib::Point2D> landmarks;
+
+    for (int i = 0; i < landmarks_seen_; ++i) {
+      const auto landmark = turtle_slam_.get_landmark_pos(i);
+      landmarks.push_back({landmark.x, landmark.y});
+    }
+
+    const auto matches = loop_closure_detector_.find_duplicates(landmarks);
+
+    /// Matches come in decreasing drop index, so the remaining indices stay valid
+    for (const auto & match : matches) {
+      RCLCPP_INFO_STREAM(
+        get_logger(),
+        "Loop closure: merging landmark " << match.drop << " into " << match.keep <<
+          " (" << match.votes << " matching distances)");
+
+      turtle_slam_.merge_landmarks(match.keep, match.drop);
+      --landmarks_seen_;
+      relocalizer_stale_ = true;
+
+      /// Landmarks after the dropped one move down a slot
+      for (auto & entry : track_uids_) {
+        auto & uid = entry.second.uid;
+
+        if (uid == match.drop) {
+          uid = match.keep;
+        } else if (uid > match.drop) {
+          --uid;
+        }
+      }
+    }
+
+    if (!matches.empty()) {
+      const auto state = turtle_slam_.get_robot_state();
+      update_map_odom_tf_(state.x, state.y, state.theta);
+      publish_map_markers();
+    }
+  }
+
+  /// \brief Relocalize when most recent innovations fall outside the 95% bound
+  void check_divergence_()
+  {
+    if (
+      !auto_relocalize_ ||
+      nis_stats_.window_count() < static_cast<size_t>(consistency_window_) ||
+      nis_stats_.fraction_above() <= RELOCALIZE_FRACTION)
+    {
+      return;
+    }
+
+    if (relocalize_()) {
+      RCLCPP_WARN_STREAM(get_logger(), "Filter diverged, relocalized to " << Tmo_);
+    } else {
+      RCLCPP_DEBUG_STREAM(get_logger(), "Filter diverged, relocalization failed");
+    }
+  }
+
+  /// \brief Find the robot pose in the map from the last scan and re-seed the filter
+  /// \return Whether a pose was found
+  bool relocalize_()
+  {
+    /// The triplet table is only rebuilt when a landmark was added, merged or loaded
+    if (relocalizer_stale_) {
+      std::vector<turtlelib::Point2D> landmarks;
+
+      for (const auto & landmark : turtle_slam_.get_all_landmarks()) {
+        if (landmark.uid != -1) {
+          landmarks.push_back({landmark.x, landmark.y});
+        }
+      }
+
+      relocalizer_.set_map(landmarks);
+      relocalizer_stale_ = false;
+    }
+
+    turtlelib::PoseHypothesis hypothesis;
+    if (
+      !relocalizer_.relocalize(
+        last_observations_, distance_threshold_, MIN_RELOCALIZE_INLIERS, hypothesis))
+    {
+      return false;
+    }
+
+    const auto x = hypothesis.Tmb.translation().x;
+    const auto y = hypothesis.Tmb.translation().y;
+    const auto theta = hypothesis.Tmb.rotation();
+
+    update_map_odom_tf_(x, y, theta);
+    turtle_slam_.update_state(x, y, theta);
+
+    /// The old pose is unrelated to the map after a kidnap, so drop its correlations
+    arma::mat Sigma = turtle_slam_.get_covariance_mat();
+    Sigma.rows(0, 2).zeros();
+    Sigma.cols(0, 2).zeros();
+    Sigma.submat(0, 0, 2, 2) = input_noice_ * arma::mat(3, 3, arma::fill::eye);
+    turtle_slam_.update_covariance(Sigma);
+
+    if (localize_mode_) {
+      freeze_map_();
+    }
+
+    nis_stats_.reset();
+
+    return true;
+  }
+
+  /// \brief Freeze the current SLAM map into the pose only filter
+  void freeze_map_()
+  {
+    const auto Sigma = turtle_slam_.get_covariance_mat();
+    std::vector<turtlelib::MapLandmark> landmarks;
+
+    for (const auto & landmark : turtle_slam_.get_all_landmarks()) {
+      if (landmark.uid == -1) {
+        continue;
+      }
+
+      const auto k = static_cast<arma::uword>(3 + 2 * landmark.uid);
+      landmarks.push_back(
+      {
+        landmark.x,
+        landmark.y,
+        {Sigma.at(k, k), Sigma.at(k, k + 1), Sigma.at(k + 1, k), Sigma.at(k + 1, k + 1)},
+        landmark.uid
+      });
+    }
+
+    std::array<double, 9> pose_cov;
+    for (size_t i = 0; i < 3; ++i) {
+      for (size_t j = 0; j < 3; ++j) {
+        pose_cov.at(3 * i + j) = Sigma.at(i, j);
+      }
+    }
+
+    pose_ekf_.set_map(landmarks);
+    pose_ekf_.reset(turtle_slam_.get_robot_state(), pose_cov);
+  }
+
   /// \brief The initial pose service callback function
   /// \param request The initial pose service request
   /// \param respose The initial pose service response
@@ -374,6 +655,140 @@ private:
     respose->success = true;
   }
 
+  /// \brief The save map service callback function
+  /// \param request The map file service request
+  /// \param response The map file service response
+  void srv_save_map_callback_(
+    std::shared_ptr<MapFile::Request> request,
+    std::shared_ptr<MapFile::Response> response)
+  {
+    const auto filename = request->filename.empty() ? map_file_ : request->filename;
+
+    if (filename.empty()) {
+      response->success = false;
+      response->message = "No map file given";
+      return;
+    }
+
+    try {
+      save_map_(filename);
+      response->success = true;
+      response->message = "Saved map to " + filename;
+    } catch (const std::exception & ex) {
+      response->success = false;
+      response->message = ex.what();
+    }
+
+    RCLCPP_INFO_STREAM(get_logger(), response->message);
+  }
+
+  /// \brief The load map service callback function
+  /// \param request The map file service request
+  /// \param response The map file service response
+  void srv_load_map_callback_(
+    std::shared_ptr<MapFile::Request> request,
+    std::shared_ptr<MapFile::Response> response)
+  {
+    const auto filename = request->filename.empty() ? map_file_ : request->filename;
+
+    if (filename.empty()) {
+      response->success = false;
+      response->message = "No map file given";
+      return;
+    }
+
+    try {
+      load_map_(filename, false);
+      response->success = true;
+      response->message = "Loaded map from " + filename;
+    } catch (const std::exception & ex) {
+      response->success = false;
+      response->message = ex.what();
+    }
+
+    RCLCPP_INFO_STREAM(get_logger(), response->message);
+  }
+
+  /// \brief The relocalize service callback function
+  /// \param request The empty request
+  /// \param response The empty response
+  void srv_relocalize_callback_(
+    std::shared_ptr<Empty::Request> request,
+    std::shared_ptr<Empty::Response> response)
+  {
+    (void) request;
+    (void) response;
+
+    if (relocalize_()) {
+      RCLCPP_INFO_STREAM(get_logger(), "Relocalized, map to odom: " << Tmo_);
+    } else {
+      RCLCPP_WARN_STREAM(get_logger(), "Relocalization failed");
+    }
+  }
+
+  /// \brief Write the current map to a binary file
+  /// \param filename The path of the map file
+  void save_map_(const std::string & filename)
+  {
+    const turtlelib::SlamMap map{
+      Tmo_,
+      turtle_slam_.get_robot_state(),
+      turtle_slam_.get_state_vec(),
+      turtle_slam_.get_covariance_mat()
+    };
+
+    turtlelib::save_map(filename, map);
+  }
+
+  /// \brief Load the map from a binary file and resume from it
+  /// \param filename The path of the map file
+  /// \param odom_reset Whether the odometry restarted since the map was saved, in which case
+  ///                   the robot is assumed to be at the saved pose.
+  void load_map_(const std::string & filename, bool odom_reset)
+  {
+    const auto map = turtlelib::load_map(filename);
+    const auto state_size = static_cast<arma::uword>(3 + 2 * num_obstacles_);
+
+    if (map.state.n_elem != state_size) {
+      throw std::runtime_error(
+              "Map has " + std::to_string((map.state.n_elem - 3) / 2) +
+              " landmarks, expected " + std::to_string(num_obstacles_));
+    }
+
+    turtle_slam_ = turtlelib::EKF(num_obstacles_);
+    turtle_slam_.update_landmark_pos(map.state);
+    turtle_slam_.update_covariance(map.covariance);
+    relocalizer_stale_ = true;
+
+    if (odom_reset) {
+      update_map_odom_tf_(map.robot.x, map.robot.y, map.robot.theta);
+    } else {
+      Tmo_ = map.Tmo;
+    }
+
+    const turtlelib::Transform2D Tob(
+      {turtlebot_.config_x(), turtlebot_.config_y()},
+      turtlebot_.config_theta()
+    );
+    const auto Tmb = Tmo_ * Tob;
+    turtle_slam_.update_state(Tmb.translation().x, Tmb.translation().y, Tmb.rotation());
+
+    track_uids_.clear();
+
+    landmarks_seen_ = 0;
+    for (const auto & landmark : turtle_slam_.get_all_landmarks()) {
+      if (landmark.uid != -1) {
+        ++landmarks_seen_;
+      }
+    }
+
+    if (localize_mode_) {
+      freeze_map_();
+    }
+
+    publish_map_markers();
+  }
+
   /// \brief Publish markers for mapped obstacles
   void publish_map_markers()
   {
@@ -406,6 +821,16 @@ private:
         m.color.b = 0.0;
         m.color.a = 1.0;
 
+        map_array_msg.markers.push_back(m);
+      } else {
+        /// The slot may have been freed by a loop closure
+        Marker m;
+
+        m.header.stamp = get_clock()->now();
+        m.header.frame_id = map_id_;
+        m.id = 30 + i;
+        m.action = Marker::DELETE;
+
         map_array_msg.markers.push_back(m);
       }
     }
@@ -542,6 +967,145 @@ private:
     Tmo_ = Tmb * Tbo;
   }
 
+  /// \brief Record the normalized innovation squared of an accepted measurement
+  /// \param dz_vec The measurement innovation
+  /// \param S_mat The innovation covariance
+  void record_innovation_(const arma::vec & dz_vec, const arma::mat & S_mat)
+  {
+    const double nis = turtlelib::compute_nis(
+      {dz_vec.at(0), dz_vec.at(1)},
+      {S_mat.at(0, 0), S_mat.at(0, 1), S_mat.at(1, 0), S_mat.at(1, 1)});
+
+    nis_stats_.add(nis);
+  }
+
+  /// \brief Keep the latest pose estimate for the NEES computation
+  /// \param state The updated state vector
+  /// \param Sigma The updated covariance matrix
+  void record_estimate_(const arma::vec & state, const arma::mat & Sigma)
+  {
+    for (size_t i = 0; i < 3; ++i) {
+      pose_est_.at(i) = state.at(i);
+
+      for (size_t j = 0; j < 3; ++j) {
+        pose_cov_.at(3 * i + j) = Sigma.at(i, j);
+      }
+    }
+
+    pose_est_stamp_ = get_clock()->now();
+    pose_est_pending_ = true;
+  }
+
+  /// \brief Compute the NEES against the ground truth and publish the statistics
+  void publish_diagnostics_()
+  {
+    if (pose_est_pending_ && !ground_truth_frame_.empty()) {
+      try {
+        const auto tf_truth = tf_buffer_->lookupTransform(
+          map_id_,
+          ground_truth_frame_,
+          pose_est_stamp_);
+
+        const auto & q = tf_truth.transform.rotation;
+        const double theta_true = 2.0 * atan2(q.z, q.w);
+
+        const std::array<double, 3> error{
+          turtlelib::normalize_angle(pose_est_.at(0) - theta_true),
+          pose_est_.at(1) - tf_truth.transform.translation.x,
+          pose_est_.at(2) - tf_truth.transform.translation.y
+        };
+
+        nees_stats_.add(turtlelib::compute_nees(error, pose_cov_));
+        pose_est_pending_ = false;
+      } catch (const tf2::TransformException & ex) {
+        RCLCPP_DEBUG_STREAM(get_logger(), "No ground truth available: " << ex.what());
+      }
+    }
+
+    DiagnosticStatus status;
+    status.name = std::string(get_name()) + ": filter consistency";
+    status.hardware_id = map_id_;
+
+    if (nis_stats_.window_count() == 0) {
+      status.level = DiagnosticStatus::STALE;
+      status.message = "No measurement accepted yet";
+    } else if (nis_stats_.fraction_above() > CONSISTENCY_TOLERANCE) {
+      status.level = DiagnosticStatus::WARN;
+      status.message = "NIS exceeds the 95% bound too often";
+    } else {
+      status.level = DiagnosticStatus::OK;
+      status.message = "Filter consistent";
+    }
+
+    const auto add_value = [&status](const std::string & key, double value) {
+        KeyValue kv;
+        kv.key = key;
+        kv.value = std::to_string(value);
+        status.values.push_back(kv);
+      };
+
+    add_value("nis_window_mean", nis_stats_.window_mean());
+    add_value("nis_fraction_above_95", nis_stats_.fraction_above());
+    add_value("nis_total_mean", nis_stats_.total_mean());
+    add_value("nis_max", nis_stats_.max());
+    add_value("nis_count", static_cast<double>(nis_stats_.total_count()));
+    add_value("nees_window_mean", nees_stats_.window_mean());
+    add_value("nees_fraction_above_95", nees_stats_.fraction_above());
+    add_value("nees_total_mean", nees_stats_.total_mean());
+    add_value("nees_max", nees_stats_.max());
+    add_value("nees_count", static_cast<double>(nees_stats_.total_count()));
+
+    DiagnosticArray msg_diagnostics;
+    msg_diagnostics.header.stamp = get_clock()->now();
+    msg_diagnostics.status.push_back(status);
+
+    pub_diagnostics_->publish(msg_diagnostics);
+  }
+
+  /// \brief Get the fit quality carried by a circle
+  /// \param circle The detected circle
+  /// \return The quality, with 0 points when the detector did not report it
+  static turtlelib::FitQuality fit_quality_of_(const Circle & circle)
+  {
+    return {circle.residual, circle.num_points, circle.angular_span};
+  }
+
+  /// \brief Associate a circle to a landmark, by its track when the track is already known
+  /// \param circle The detected circle
+  /// \return The uid of the landmark, landmarks_seen_ for a new landmark
+  int associate_circle_(const Circle & circle)
+  {
+    if (circle.id < 0) {
+      return get_landmark_id(circle);
+    }
+
+    auto entry = track_uids_.find(circle.id);
+
+    if (entry != track_uids_.end() && entry->second.uid < landmarks_seen_) {
+      entry->second.last_scan = circle_scans_;
+      return entry->second.uid;
+    }
+
+    const auto uid = get_landmark_id(circle);
+    track_uids_[circle.id] = {uid, circle_scans_};
+
+    return uid;
+  }
+
+  /// \brief Forget the tracks that have not been seen for a while
+  void expire_tracks_()
+  {
+    ++circle_scans_;
+
+    for (auto entry = track_uids_.begin(); entry != track_uids_.end(); ) {
+      if (entry->second.last_scan + TRACK_EXPIRY_SCANS < circle_scans_) {
+        entry = track_uids_.erase(entry);
+      } else {
+        ++entry;
+      }
+    }
+  }
+
   int get_landmark_id(Circle circle)
   {
     arma::vec state_vec = turtle_slam_.get_state_vec();
@@ -634,6 +1198,7 @@ private:
 
   /// Timer
   rclcpp::TimerBase::SharedPtr timer_;
+  rclcpp::TimerBase::SharedPtr timer_diagnostics_;
 
   /// Subscriber
   rclcpp::Subscription<JointState>::SharedPtr sub_joint_states_;
@@ -644,12 +1209,20 @@ private:
   rclcpp::Publisher<Odometry>::SharedPtr pub_odometry_;
   rclcpp::Publisher<Path>::SharedPtr pub_path_;
   rclcpp::Publisher<MarkerArray>::SharedPtr pub_map_array_;
+  rclcpp::Publisher<DiagnosticArray>::SharedPtr pub_diagnostics_;
 
   /// TF Broadcaster
   std::unique_ptr<TransformBroadcaster> tf_broadcater_;
 
+  /// TF Listener
+  std::unique_ptr<tf2_ros::Buffer> tf_buffer_;
+  std::shared_ptr<tf2_ros::TransformListener> tf_listener_;
+
   /// Service
   rclcpp::Service<InitialPose>::SharedPtr srv_initial_pose_;
+  rclcpp::Service<MapFile>::SharedPtr srv_save_map_;
+  rclcpp::Service<MapFile>::SharedPtr srv_load_map_;
+  rclcpp::Service<Empty>::SharedPtr srv_relocalize_;
 
   /// QoS
   rclcpp::QoS marker_qos_;
@@ -673,6 +1246,14 @@ private:
   double sensor_noice_;
   double distance_threshold_;
   bool use_laser_scan_;
+  std::string ground_truth_frame_;
+  double diagnostics_rate_;
+  int consistency_window_;
+  std::string map_file_;
+  std::string mode_;
+  bool auto_relocalize_;
+  bool loop_closure_;
+  double loop_closure_radius_;
 
   /// other attributes
   bool joint_states_available_;
@@ -695,9 +1276,43 @@ private:
   turtlelib::Transform2D Tmo_;
   bool landmark_updated_;
   int landmarks_seen_;
+  bool localize_mode_;
+  turtlelib::PoseEKF pose_ekf_;
+  turtlelib::Relocalizer relocalizer_;
+  bool relocalizer_stale_;
+  std::vector<turtlelib::Point2D> last_observations_;
+  std::vector<double> last_noise_scales_;
+
+  /// The landmark of every circle track, and the scan it was last seen in
+  struct TrackAssociation
+  {
+    int uid;
+    size_t last_scan;
+  };
+  std::unordered_map<int32_t, TrackAssociation> track_uids_;
+  size_t circle_scans_;
+  turtlelib::LoopClosure loop_closure_detector_;
+  turtlelib::FitQualityGate fit_gate_;
+  turtlelib::RollingStats nis_stats_;
+  turtlelib::RollingStats nees_stats_;
+  std::array<double, 3> pose_est_;
+  std::array<double, 9> pose_cov_;
+  rclcpp::Time pose_est_stamp_;
+  bool pose_est_pending_;
 
   /// Constants
   const size_t MAX_PATH_LEN = 100;
+  const double CONSISTENCY_TOLERANCE = 0.1;
+  const double RELOCALIZE_FRACTION = 0.5;
+  const size_t MIN_RELOCALIZE_INLIERS = 3;
+  const size_t LOOP_CLOSURE_MIN_MATCHES = 2;
+  const double LOOP_CLOSURE_TOLERANCE = 0.05;
+  const double LOOP_CLOSURE_DESCRIPTOR_RADIUS = 3.5;
+  const size_t TRACK_EXPIRY_SCANS = 10;
+
+  /// Circle fits with a smaller residual and a larger span keep the basic sensor variance
+  const double FIT_REFERENCE_RESIDUAL = 0.01;
+  const double FIT_REFERENCE_SPAN = turtlelib::PI / 2.0;
 
 public:
   /// \brief
@@ -705,7 +1320,8 @@ public:
   : Node("odometry"), marker_qos_(10), joint_states_available_(false), index_left_(SIZE_MAX),
     index_right_(SIZE_MAX), num_obstacles_(20), turtle_slam_(num_obstacles_),
     marker_radius_(0.038), marker_height_(0.25), Tmo_({0.0, 0.0}, 0.0), landmark_updated_(false),
-    landmarks_seen_(0)
+    landmarks_seen_(0), localize_mode_(false), relocalizer_stale_(true), circle_scans_(0),
+    pose_est_pending_(false)
   {
     ParameterDescriptor body_id_des;
     ParameterDescriptor odom_id_des;
@@ -719,6 +1335,17 @@ public:
     ParameterDescriptor marker_radius_des;
     ParameterDescriptor distance_threshold_des;
     ParameterDescriptor use_laser_scan_des;
+    ParameterDescriptor ground_truth_frame_des;
+    ParameterDescriptor diagnostics_rate_des;
+    ParameterDescriptor consistency_window_des;
+    ParameterDescriptor map_file_des;
+    ParameterDescriptor mode_des;
+    ParameterDescriptor auto_relocalize_des;
+    ParameterDescriptor loop_closure_des;
+    ParameterDescriptor loop_closure_radius_des;
+    ParameterDescriptor max_fit_residual_des;
+    ParameterDescriptor min_fit_points_des;
+    ParameterDescriptor min_fit_span_des;
 
     body_id_des.description = "The name of the body frame of the robot.";
     odom_id_des.description = "The name of the odometry frame.";
@@ -732,6 +1359,17 @@ public:
     marker_radius_des.description = "The radius of the marker";
     distance_threshold_des.description = "Distance threshold of the landmark";
     use_laser_scan_des.description = "Whether to use the laser scan data";
+    ground_truth_frame_des.description = "The ground truth body frame, empty to disable NEES";
+    diagnostics_rate_des.description = "The rate of publishing the consistency statistics";
+    consistency_window_des.description = "Number of samples in the NIS/NEES rolling window";
+    map_file_des.description = "The binary map file loaded on start, empty to start blank";
+    mode_des.description = "slam to build the map, localize to track the pose in map_file";
+    auto_relocalize_des.description = "Whether to relocalize when the NIS shows divergence";
+    loop_closure_des.description = "Whether to merge landmarks duplicated on a revisit";
+    loop_closure_radius_des.description = "The largest distance between a landmark and its duplicate";
+    max_fit_residual_des.description = "The largest circle fit residual used for a correction";
+    min_fit_points_des.description = "The fewest circle fit points used for a correction";
+    min_fit_span_des.description = "The smallest circle fit angular span used for a correction";
 
     declare_parameter<std::string>("body_id", "", body_id_des);
     declare_parameter<std::string>("odom_id", "odom", odom_id_des);
@@ -745,6 +1383,17 @@ public:
     declare_parameter<double>("marker_radius", 0.05, marker_radius_des);
     declare_parameter<double>("distance_threshold", 0.1, distance_threshold_des);
     declare_parameter<bool>("use_laser_scan", false, use_laser_scan_des);
+    declare_parameter<std::string>("ground_truth_frame", "", ground_truth_frame_des);
+    declare_parameter<double>("diagnostics_rate", 1.0, diagnostics_rate_des);
+    declare_parameter<int>("consistency_window", 100, consistency_window_des);
+    declare_parameter<std::string>("map_file", "", map_file_des);
+    declare_parameter<std::string>("mode", "slam", mode_des);
+    declare_parameter<bool>("auto_relocalize", true, auto_relocalize_des);
+    declare_parameter<bool>("loop_closure", true, loop_closure_des);
+    declare_parameter<double>("loop_closure_radius", 0.3, loop_closure_radius_des);
+    declare_parameter<double>("max_fit_residual", 0.02, max_fit_residual_des);
+    declare_parameter<int>("min_fit_points", 4, min_fit_points_des);
+    declare_parameter<double>("min_fit_span", 0.3, min_fit_span_des);
 
     body_id_ = get_parameter("body_id").as_string();
     odom_id_ = get_parameter("odom_id").as_string();
@@ -757,6 +1406,30 @@ public:
     sensor_noice_ = get_parameter("basic_sensor_variance").as_double();
     distance_threshold_ = get_parameter("distance_threshold").as_double();
     use_laser_scan_ = get_parameter("use_laser_scan").as_bool();
+    ground_truth_frame_ = get_parameter("ground_truth_frame").as_string();
+    diagnostics_rate_ = get_parameter("diagnostics_rate").as_double();
+    consistency_window_ = get_parameter("consistency_window").as_int();
+    map_file_ = get_parameter("map_file").as_string();
+    mode_ = get_parameter("mode").as_string();
+    auto_relocalize_ = get_parameter("auto_relocalize").as_bool();
+    loop_closure_ = get_parameter("loop_closure").as_bool();
+    loop_closure_radius_ = get_parameter("loop_closure_radius").as_double();
+
+    const auto max_fit_residual = get_parameter("max_fit_residual").as_double();
+    const auto min_fit_points = get_parameter("min_fit_points").as_int();
+    const auto min_fit_span = get_parameter("min_fit_span").as_double();
+
+    if (max_fit_residual <= 0.0 || min_fit_points < 3 || min_fit_span < 0.0) {
+      RCLCPP_ERROR_STREAM(
+        get_logger(),
+        "Invalid fit gate: residual " << max_fit_residual << ", points " << min_fit_points <<
+          ", span " << min_fit_span);
+      exit(EXIT_FAILURE);
+    }
+
+    fit_gate_ = turtlelib::FitQualityGate(
+      max_fit_residual, static_cast<size_t>(min_fit_points), min_fit_span,
+      FIT_REFERENCE_RESIDUAL, FIT_REFERENCE_SPAN);
 
     dist_sensor_ = std::normal_distribution<double>(0.0, sqrt(sensor_noice_));
     turtlebot_ = turtlelib::DiffDrive(track_width_, wheel_radius_);
@@ -785,14 +1458,55 @@ public:
       exit(EXIT_FAILURE);
     }
 
+    if (diagnostics_rate_ <= 0.0 || consistency_window_ <= 0) {
+      RCLCPP_ERROR_STREAM(
+        get_logger(),
+        "Invalid diagnostics rate " << diagnostics_rate_ << " or window " << consistency_window_);
+      exit(EXIT_FAILURE);
+    }
+
+    if (mode_ != "slam" && mode_ != "localize") {
+      RCLCPP_ERROR_STREAM(get_logger(), "Invalid mode: " << mode_);
+      exit(EXIT_FAILURE);
+    }
+
+    localize_mode_ = mode_ == "localize";
+    pose_ekf_ = turtlelib::PoseEKF(distance_threshold_);
+
+    if (loop_closure_radius_ <= 0.0 || loop_closure_radius_ >= LOOP_CLOSURE_DESCRIPTOR_RADIUS) {
+      RCLCPP_ERROR_STREAM(get_logger(), "Invalid loop closure radius: " << loop_closure_radius_);
+      exit(EXIT_FAILURE);
+    }
+
+    loop_closure_detector_ = turtlelib::LoopClosure(
+      LOOP_CLOSURE_MIN_MATCHES,
+      LOOP_CLOSURE_TOLERANCE,
+      loop_closure_radius_,
+      LOOP_CLOSURE_DESCRIPTOR_RADIUS);
+
+    if (localize_mode_ && !std::filesystem::exists(map_file_)) {
+      RCLCPP_ERROR_STREAM(get_logger(), "Localize mode needs an existing map_file: " << map_file_);
+      exit(EXIT_FAILURE);
+    }
+
+    nis_stats_ = turtlelib::RollingStats(consistency_window_, turtlelib::CHI2_95_2DOF);
+    nees_stats_ = turtlelib::RollingStats(consistency_window_, turtlelib::CHI2_95_3DOF);
+
     /// QoS
     marker_qos_.transient_local();
 
     /// Transform broadcaster
     tf_broadcater_ = std::make_unique<TransformBroadcaster>(*this);
 
+    /// Transform listener
+    tf_buffer_ = std::make_unique<tf2_ros::Buffer>(get_clock());
+    tf_listener_ = std::make_shared<tf2_ros::TransformListener>(*tf_buffer_);
+
     /// Timer
     timer_ = create_wall_timer(5ms, std::bind(&Slam::timer_callback_, this));
+    timer_diagnostics_ = create_wall_timer(
+      std::chrono::duration<double>{1.0 / diagnostics_rate_},
+      std::bind(&Slam::publish_diagnostics_, this));
 
     /// Subscriptions
     sub_joint_states_ =
@@ -826,6 +1540,7 @@ public:
     pub_odometry_ = create_publisher<Odometry>("odom", 10);
     pub_path_ = create_publisher<Path>("~/path", 10);
     pub_map_array_ = create_publisher<MarkerArray>("~/map", marker_qos_);
+    pub_diagnostics_ = create_publisher<DiagnosticArray>("/diagnostics", 10);
 
     /// Services
     srv_initial_pose_ =
@@ -836,6 +1551,49 @@ public:
         this,
         std::placeholders::_1,
         std::placeholders::_2));
+    srv_save_map_ =
+      create_service<MapFile>(
+      "~/save_map",
+      std::bind(
+        &Slam::srv_save_map_callback_,
+        this,
+        std::placeholders::_1,
+        std::placeholders::_2));
+    srv_load_map_ =
+      create_service<MapFile>(
+      "~/load_map",
+      std::bind(
+        &Slam::srv_load_map_callback_,
+        this,
+        std::placeholders::_1,
+        std::placeholders::_2));
+    srv_relocalize_ =
+      create_service<Empty>(
+      "~/relocalize",
+      std::bind(
+        &Slam::srv_relocalize_callback_,
+        this,
+        std::placeholders::_1,
+        std::placeholders::_2));
+
+    /// Warm start from the saved map
+    if (!map_file_.empty() && std::filesystem::exists(map_file_)) {
+      try {
+        load_map_(map_file_, true);
+        RCLCPP_INFO_STREAM(
+          get_logger(),
+          "Resumed " << landmarks_seen_ << " landmarks from " << map_file_);
+      } catch (const std::exception & ex) {
+        if (localize_mode_) {
+          RCLCPP_ERROR_STREAM(get_logger(), "Failed to load " << map_file_ << ": " << ex.what());
+          exit(EXIT_FAILURE);
+        }
+
+        RCLCPP_WARN_STREAM(
+          get_logger(),
+          "Failed to load " << map_file_ << ", starting blank: " << ex.what());
+      }
+    }
   }
 };
 
@@ -0,0 +1,85 @@
+/// \file bench_beam_table.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Compare per beam trigonometry with the cached beam table.
+/// \version 0.1
+/// \date 2024-03-29
+///
+/// \copyright Copyright (c) 2024
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "turtlelib/beam_table.hpp"
+#include "turtlelib/geometry2d.hpp"
+
+namespace
+{
+constexpr int REPEATS = 2000;
+constexpr double RANGE_MIN = 0.12;
+constexpr double RANGE_MAX = 3.5;
+
+/// \brief Time a conversion repeated over the same scan
+/// \param convert The conversion
+/// \return The average time of one conversion in nanoseconds
+template<class F>
+double time_ns(F convert)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int k = 0; k < REPEATS; ++k) {
+    convert();
+  }
+
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / REPEATS;
+}
+
+/// \brief Benchmark one scan size
+/// \param count The number of beams
+void run(size_t count)
+{
+  const auto angle_min = -turtlelib::PI;
+  const auto angle_increment = 2.0 * turtlelib::PI / static_cast<double>(count);
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<float> range(0.0f, 4.0f);
+  std::vector<float> ranges(count);
+  for (auto & r : ranges) {
+    r = range(generator);
+  }
+
+  std::vector<double> x(count), y(count);
+  std::vector<uint8_t> valid(count);
+
+  const auto naive = time_ns(
+    [&]() {
+      for (size_t i = 0; i < count; ++i) {
+        const double r = ranges[i];
+        const auto theta = angle_min + static_cast<double>(i) * angle_increment;
+        x[i] = r * std::cos(theta);
+        y[i] = r * std::sin(theta);
+        valid[i] = r > RANGE_MIN && r < RANGE_MAX;
+      }
+    });
+
+  turtlelib::BeamTable table;
+  const auto cached = time_ns(
+    [&]() {
+      table.update(angle_min, angle_increment, count);
+      table.to_cartesian(ranges.data(), RANGE_MIN, RANGE_MAX, x.data(), y.data(), valid.data());
+    });
+
+  std::printf(
+    "%5zu beams: per beam trig %9.1f ns, beam table %9.1f ns, speedup %5.1fx\n",
+    count, naive, cached, naive / cached);
+}
+} // namespace
+
+int main()
+{
+  run(360);
+  run(4096);
+  return 0;
+}
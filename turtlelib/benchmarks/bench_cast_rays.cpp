@@ -0,0 +1,116 @@
+/// \file bench_cast_rays.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Compare per beam obstacle intersection with the batched ray caster.
+/// \version 0.1
+/// \date 2024-04-03
+///
+/// \copyright Copyright (c) 2024
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "turtlelib/beam_table.hpp"
+#include "turtlelib/trig2d.hpp"
+
+namespace
+{
+constexpr int REPEATS = 5;
+constexpr double RESOLUTION = 0.001;
+constexpr double OBSTACLE_RADIUS = 0.038;
+
+/// \brief Time a scan repeated over the same obstacles
+/// \param scan The scan
+/// \return The average time of one scan in milliseconds
+template<class F>
+double time_ms(F scan)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int k = 0; k < REPEATS; ++k) {
+    scan();
+  }
+
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / REPEATS;
+}
+
+/// \brief Benchmark one number of obstacles
+/// \param count The number of obstacles
+void run(size_t count)
+{
+  const auto num_beams = static_cast<size_t>(2.0 * turtlelib::PI / RESOLUTION);
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> position(-5.0, 5.0);
+
+  std::vector<turtlelib::Obstacle> obstacles;
+  turtlelib::Obstacles soa;
+
+  while (obstacles.size() < count) {
+    const turtlelib::Obstacle obs{position(generator), position(generator), OBSTACLE_RADIUS};
+
+    if (std::hypot(obs.x, obs.y) > 2.0 * OBSTACLE_RADIUS) {
+      obstacles.push_back(obs);
+      soa.x.push_back(obs.x);
+      soa.y.push_back(obs.y);
+      soa.r.push_back(obs.r);
+    }
+  }
+
+  const auto miss = std::numeric_limits<double>::infinity();
+  std::vector<double> per_beam(num_beams), batched(num_beams);
+
+  const auto naive = time_ms(
+    [&]() {
+      for (size_t i = 0; i < num_beams; ++i) {
+        const auto alpha = RESOLUTION * static_cast<double>(i) - turtlelib::PI;
+        std::vector<double> dists;
+
+        for (const auto & obs : obstacles) {
+          if (turtlelib::can_intersect(alpha, obs)) {
+            dists.push_back(turtlelib::find_distance(alpha, obs));
+          }
+        }
+
+        per_beam[i] = miss;
+        for (const auto d : dists) {
+          per_beam[i] = std::min(per_beam[i], d);
+        }
+      }
+    });
+
+  turtlelib::BeamTable table;
+  const auto fast = time_ms(
+    [&]() {
+      table.update(-turtlelib::PI, RESOLUTION, num_beams);
+      batched.assign(num_beams, miss);
+      turtlelib::cast_rays(
+        table.cos().data(), table.sin().data(), num_beams, soa, batched.data());
+    });
+
+  /// can_intersect also accepts obstacles behind the scanner, so the per beam ranges
+  /// differ wherever such an obstacle is closer than the one ahead
+  size_t hits = 0;
+  size_t differing = 0;
+  for (size_t i = 0; i < num_beams; ++i) {
+    hits += batched[i] < miss;
+    differing += !(std::fabs(batched[i] - per_beam[i]) < 1e-6) && per_beam[i] < batched[i];
+  }
+
+  std::printf(
+    "%5zu obstacles, %zu beams: per beam %8.2f ms, batched %7.2f ms, speedup %5.1fx,"
+    " %zu hits, %zu beams closer per beam\n",
+    count, num_beams, naive, fast, naive / fast, hits, differing);
+}
+} // namespace
+
+int main()
+{
+  run(10);
+  run(100);
+  run(500);
+  return 0;
+}
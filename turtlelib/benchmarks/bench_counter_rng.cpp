@@ -0,0 +1,67 @@
+/// \file bench_counter_rng.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Compare per sample standard library noise with bulk counter based noise.
+/// \version 0.1
+/// \date 2024-04-12
+///
+/// \copyright Copyright (c) 2024
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "turtlelib/counter_rng.hpp"
+
+namespace
+{
+constexpr int REPEATS = 2000;
+
+/// \brief Time a fill repeated over the same array
+/// \param fill The fill
+/// \return The average time of one fill in nanoseconds
+template<class F>
+double time_ns(F fill)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int k = 0; k < REPEATS; ++k) {
+    fill(k);
+  }
+
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / REPEATS;
+}
+
+/// \brief Benchmark one number of samples, e.g. the beams of a scan
+/// \param count The number of samples
+void run(size_t count)
+{
+  std::vector<double> noice(count);
+
+  std::default_random_engine generator(0);
+  std::normal_distribution<double> normal(0.0, 1.0);
+  const auto per_sample = time_ns(
+    [&](int) {
+      for (auto & n : noice) {
+        n = normal(generator);
+      }
+    });
+
+  const auto bulk = time_ns(
+    [&](int k) {
+      turtlelib::fill_normal({0, static_cast<uint64_t>(k), 0}, 0, count, noice.data());
+    });
+
+  std::printf(
+    "%6zu samples: per sample normal_distribution %9.1f ns, fill_normal %9.1f ns, "
+    "speedup %5.1fx\n", count, per_sample, bulk, per_sample / bulk);
+}
+} // namespace
+
+int main()
+{
+  run(360);
+  run(4096);
+  run(65536);
+  return 0;
+}
@@ -0,0 +1,242 @@
+/// \file bench_distance_field.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Compare walking every map cell along a beam with sphere tracing the distance field.
+/// \version 0.1
+/// \date 2024-04-06
+///
+/// \copyright Copyright (c) 2024
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "turtlelib/beam_table.hpp"
+#include "turtlelib/distance_field.hpp"
+#include "turtlelib/geometry2d.hpp"
+
+namespace
+{
+constexpr int REPEATS = 10;
+constexpr double CELL = 0.05;
+constexpr double ROOM = 4.0;
+constexpr double DOOR = 0.9;
+constexpr double RESOLUTION = 0.001;
+
+/// \brief Rasterize a building of square rooms with doors
+/// \param rooms The number of rooms along each side
+/// \return The map, centered at the origin
+turtlelib::OccupancyMap building(size_t rooms)
+{
+  const auto cells_per_room = static_cast<size_t>(std::round(ROOM / CELL));
+  const auto door_cells = static_cast<size_t>(std::round(DOOR / CELL));
+  const auto door_lo = (cells_per_room - door_cells) / 2;
+  const auto size = cells_per_room * rooms + 1;
+
+  turtlelib::OccupancyMap map;
+  map.width = size;
+  map.height = size;
+  map.resolution = CELL;
+  map.origin_x = -static_cast<double>(size) * CELL / 2.0;
+  map.origin_y = map.origin_x;
+  map.data.assign(size * size, turtlelib::CELL_FREE);
+
+  for (size_t row = 0; row < size; ++row) {
+    for (size_t col = 0; col < size; ++col) {
+      const auto on_col = col % cells_per_room == 0;
+      const auto on_row = row % cells_per_room == 0;
+      const auto outer = row == 0 || col == 0 || row + 1 == size || col + 1 == size;
+      const auto in_door_row = row % cells_per_room >= door_lo &&
+        row % cells_per_room < door_lo + door_cells;
+      const auto in_door_col = col % cells_per_room >= door_lo &&
+        col % cells_per_room < door_lo + door_cells;
+
+      if (outer || (on_col && !in_door_row) || (on_row && !in_door_col)) {
+        map.data[row * size + col] = turtlelib::CELL_OCCUPIED;
+      }
+    }
+  }
+
+  return map;
+}
+
+/// \brief Rasterize an open hall with square pillars
+/// \param length The side length of the hall
+/// \return The map, centered at the origin
+turtlelib::OccupancyMap hall(double length)
+{
+  constexpr double SPACING = 6.0;
+  constexpr double PILLAR = 0.3;
+
+  const auto size = static_cast<size_t>(std::round(length / CELL));
+  const auto spacing_cells = static_cast<size_t>(std::round(SPACING / CELL));
+  const auto pillar_cells = static_cast<size_t>(std::round(PILLAR / CELL));
+
+  turtlelib::OccupancyMap map;
+  map.width = size;
+  map.height = size;
+  map.resolution = CELL;
+  map.origin_x = -static_cast<double>(size) * CELL / 2.0;
+  map.origin_y = map.origin_x;
+  map.data.assign(size * size, turtlelib::CELL_FREE);
+
+  for (size_t row = 0; row < size; ++row) {
+    for (size_t col = 0; col < size; ++col) {
+      const auto outer = row == 0 || col == 0 || row + 1 == size || col + 1 == size;
+      const auto pillar = row % spacing_cells < pillar_cells && col % spacing_cells < pillar_cells;
+
+      if (outer || pillar) {
+        map.data[row * size + col] = turtlelib::CELL_OCCUPIED;
+      }
+    }
+  }
+
+  return map;
+}
+
+/// \brief Walk every cell along a ray until an occupied one
+/// \param map The map
+/// \param x The x coordinate of the origin of the ray, inside the map
+/// \param y The y coordinate of the origin of the ray, inside the map
+/// \param dx The x component of the direction
+/// \param dy The y component of the direction
+/// \param max_range The length of the ray
+/// \return The distance to the first occupied cell, infinity without a hit
+double walk_cells(
+  const turtlelib::OccupancyMap & map, double x, double y, double dx, double dy,
+  double max_range)
+{
+  const auto miss = std::numeric_limits<double>::infinity();
+
+  auto col = static_cast<long>(std::floor((x - map.origin_x) / map.resolution));
+  auto row = static_cast<long>(std::floor((y - map.origin_y) / map.resolution));
+  const long step_col = dx > 0.0 ? 1 : -1;
+  const long step_row = dy > 0.0 ? 1 : -1;
+  const auto delta_col = dx != 0.0 ? map.resolution / std::fabs(dx) : miss;
+  const auto delta_row = dy != 0.0 ? map.resolution / std::fabs(dy) : miss;
+  auto next_col = dx != 0.0 ?
+    (map.origin_x + static_cast<double>(col + (dx > 0.0)) * map.resolution - x) / dx : miss;
+  auto next_row = dy != 0.0 ?
+    (map.origin_y + static_cast<double>(row + (dy > 0.0)) * map.resolution - y) / dy : miss;
+  auto t = 0.0;
+
+  while (t <= max_range) {
+    if (
+      col < 0 || row < 0 || col >= static_cast<long>(map.width) ||
+      row >= static_cast<long>(map.height))
+    {
+      return miss;
+    }
+
+    if (map.data[static_cast<size_t>(row) * map.width + static_cast<size_t>(col)] ==
+      turtlelib::CELL_OCCUPIED)
+    {
+      return t;
+    }
+
+    if (next_col < next_row) {
+      t = next_col;
+      next_col += delta_col;
+      col += step_col;
+    } else {
+      t = next_row;
+      next_row += delta_row;
+      row += step_row;
+    }
+  }
+
+  return miss;
+}
+
+/// \brief Time a scan repeated from random poses
+/// \param scan The scan
+/// \return The average time of one scan in milliseconds
+template<class F>
+double time_ms(F scan)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int k = 0; k < REPEATS; ++k) {
+    scan(k);
+  }
+
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / REPEATS;
+}
+
+/// \brief Benchmark one map and lidar range
+/// \param name The name of the map
+/// \param map The map
+/// \param range_max The range of the lidar
+void run(const char * name, const turtlelib::OccupancyMap & map, double range_max)
+{
+
+  const auto build_start = std::chrono::steady_clock::now();
+  const turtlelib::DistanceField field(map);
+  const auto build_stop = std::chrono::steady_clock::now();
+  const auto build = std::chrono::duration<double, std::milli>(build_stop - build_start).count();
+
+  /// Robots stand anywhere in the free space
+  const auto length = static_cast<double>(map.width) * map.resolution;
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> position(map.origin_x, map.origin_x + length);
+
+  std::vector<double> pose_x, pose_y;
+  while (pose_x.size() < REPEATS) {
+    const auto x = position(generator);
+    const auto y = position(generator);
+
+    if (field.distance(x, y) > 0.3) {
+      pose_x.push_back(x);
+      pose_y.push_back(y);
+    }
+  }
+
+  const auto num_beams = static_cast<size_t>(2.0 * turtlelib::PI / RESOLUTION);
+  const turtlelib::BeamTable table(-turtlelib::PI, RESOLUTION, num_beams);
+
+  std::vector<double> walked(num_beams), traced(num_beams);
+
+  const auto cells = time_ms(
+    [&](int k) {
+      for (size_t i = 0; i < num_beams; ++i) {
+        walked[i] = walk_cells(
+          map, pose_x[k], pose_y[k], table.cos()[i], table.sin()[i], range_max);
+      }
+    });
+
+  const auto sphere = time_ms(
+    [&](int k) {
+      for (size_t i = 0; i < num_beams; ++i) {
+        traced[i] = field.raycast(
+          pose_x[k], pose_y[k], table.cos()[i], table.sin()[i], range_max);
+      }
+    });
+
+  /// The cell walk stops at the cell boundary, sphere tracing just past it
+  size_t differing = 0;
+  for (size_t i = 0; i < num_beams; ++i) {
+    differing += !(walked[i] == traced[i] || std::fabs(walked[i] - traced[i]) < 1e-6);
+  }
+
+  std::printf(
+    "%-8s %4zux%-4zu cells, range %4.1f m, %zu beams: field %6.1f ms, cell walk %6.3f ms,"
+    " sphere tracing %6.3f ms, speedup %4.1fx, %zu differing beams\n",
+    name, map.width, map.height, range_max, num_beams, build, cells, sphere, cells / sphere,
+    differing);
+}
+} // namespace
+
+int main()
+{
+  const auto rooms = building(25);
+  const auto open = hall(100.0);
+
+  run("rooms", rooms, 3.5);
+  run("rooms", rooms, 30.0);
+  run("hall", open, 3.5);
+  run("hall", open, 12.0);
+  run("hall", open, 30.0);
+  return 0;
+}
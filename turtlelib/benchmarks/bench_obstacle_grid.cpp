@@ -0,0 +1,130 @@
+/// \file bench_obstacle_grid.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Compare scans and collision checks against all obstacles with the obstacle grid.
+/// \version 0.1
+/// \date 2024-04-04
+///
+/// \copyright Copyright (c) 2024
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "turtlelib/beam_table.hpp"
+#include "turtlelib/obstacle_grid.hpp"
+#include "turtlelib/trig2d.hpp"
+
+namespace
+{
+constexpr int REPEATS = 20;
+constexpr double WORLD_HALF_LENGTH = 50.0;
+constexpr double OBSTACLE_RADIUS = 0.038;
+constexpr double RANGE_MAX = 3.5;
+constexpr double CELL_SIZE = 0.5;
+
+/// \brief Time a step repeated from random poses
+/// \param step The step
+/// \return The average time of one step in milliseconds
+template<class F>
+double time_ms(F step)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int k = 0; k < REPEATS; ++k) {
+    step(k);
+  }
+
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / REPEATS;
+}
+
+/// \brief Benchmark one world
+/// \param count The number of obstacles
+/// \param resolution The angle between two beams
+void run(size_t count, double resolution)
+{
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> position(-WORLD_HALF_LENGTH, WORLD_HALF_LENGTH);
+
+  turtlelib::Obstacles obstacles;
+  for (size_t i = 0; i < count; ++i) {
+    obstacles.x.push_back(position(generator));
+    obstacles.y.push_back(position(generator));
+    obstacles.r.push_back(OBSTACLE_RADIUS);
+  }
+
+  std::vector<double> pose_x(REPEATS), pose_y(REPEATS);
+  for (int k = 0; k < REPEATS; ++k) {
+    pose_x[k] = position(generator);
+    pose_y[k] = position(generator);
+  }
+
+  const auto num_beams = static_cast<size_t>(2.0 * turtlelib::PI / resolution);
+  const turtlelib::BeamTable table(-turtlelib::PI, resolution, num_beams);
+  const auto miss = std::numeric_limits<double>::infinity();
+
+  std::vector<double> all_ranges(num_beams), grid_ranges(num_beams);
+  turtlelib::Obstacles shifted = obstacles;
+  size_t all_collisions = 0;
+
+  const auto all = time_ms(
+    [&](int k) {
+      bool collision = false;
+
+      for (size_t i = 0; i < count; ++i) {
+        shifted.x[i] = obstacles.x[i] - pose_x[k];
+        shifted.y[i] = obstacles.y[i] - pose_y[k];
+
+        collision = collision || std::hypot(shifted.x[i], shifted.y[i]) < 0.2 + OBSTACLE_RADIUS;
+      }
+
+      all_collisions += collision;
+
+      all_ranges.assign(num_beams, miss);
+      turtlelib::cast_rays(
+        table.cos().data(), table.sin().data(), num_beams, shifted, all_ranges.data());
+    });
+
+  const auto build_start = std::chrono::steady_clock::now();
+  const turtlelib::ObstacleGrid grid(obstacles, CELL_SIZE);
+  const auto build = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - build_start).count();
+
+  std::vector<size_t> nearby;
+  size_t grid_collisions = 0;
+  size_t differing = 0;
+
+  const auto indexed = time_ms(
+    [&](int k) {
+      grid.query(pose_x[k], pose_y[k], 0.2, nearby);
+      grid_collisions += !nearby.empty();
+
+      for (size_t i = 0; i < num_beams; ++i) {
+        grid_ranges[i] = grid.raycast(
+          pose_x[k], pose_y[k], table.cos()[i], table.sin()[i], RANGE_MAX);
+      }
+    });
+
+  /// The last scan of both, beyond the lidar range both count as a miss
+  for (size_t i = 0; i < num_beams; ++i) {
+    const auto expected = all_ranges[i] <= RANGE_MAX ? all_ranges[i] : miss;
+    differing += !(expected == grid_ranges[i] || std::fabs(expected - grid_ranges[i]) < 1e-9);
+  }
+
+  std::printf(
+    "%6zu obstacles, %4zu beams: all obstacles %8.3f ms, grid %6.3f ms (built in %.1f ms),"
+    " speedup %6.1fx, %zu differing beams, collisions %zu/%zu\n",
+    count, num_beams, all, indexed, build, all / indexed, differing, all_collisions,
+    grid_collisions);
+}
+} // namespace
+
+int main()
+{
+  run(1000, 0.02);
+  run(10000, 0.02);
+  run(10000, 0.001);
+  return 0;
+}
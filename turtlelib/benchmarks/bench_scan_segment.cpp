@@ -0,0 +1,274 @@
+/// \file bench_scan_segment.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Compare the fixed and the adaptive breakpoint distance on scans.
+/// \version 0.1
+/// \date 2024-04-01
+///
+/// Usage: bench_scan_segment [scans.txt]
+///
+/// Every line of the scan file is one recorded scan:
+///   angle_min angle_increment range_min range_max range_0 range_1 ...
+/// Without a file, scans of cylinders in a walled arena are simulated, with
+/// some pairs of cylinders standing close together. For simulated scans the
+/// circles are also checked against the true cylinders.
+///
+/// \copyright Copyright (c) 2024
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "turtlelib/detect.hpp"
+#include "turtlelib/geometry2d.hpp"
+#include "turtlelib/scan_segment.hpp"
+
+namespace
+{
+constexpr double ARENA_HALF_LENGTH = 2.5;
+constexpr double CYLINDER_RADIUS = 0.05;
+constexpr double RANGE_SIGMA = 0.01;
+constexpr size_t NUM_SIMULATED = 500;
+
+/// \brief A laser scan
+struct Scan
+{
+  double angle_min;
+  double angle_increment;
+  double range_min;
+  double range_max;
+  std::vector<float> ranges;
+
+  /// \brief The true cylinders hit by at least 4 beams in the scanner frame, empty for
+  ///        recorded scans
+  std::vector<turtlelib::Point2D> cylinders;
+};
+
+/// \brief Read recorded scans
+/// \param filename The scan file
+/// \return The scans
+std::vector<Scan> load_scans(const std::string & filename)
+{
+  std::vector<Scan> scans;
+  std::ifstream file(filename);
+  std::string line;
+
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    Scan scan;
+
+    if (!(fields >> scan.angle_min >> scan.angle_increment >> scan.range_min >> scan.range_max)) {
+      continue;
+    }
+
+    float range;
+    while (fields >> range) {
+      scan.ranges.push_back(range);
+    }
+
+    scans.push_back(scan);
+  }
+
+  return scans;
+}
+
+/// \brief Cast a ray against the arena walls and the cylinders
+/// \param px The x coordinate of the scanner
+/// \param py The y coordinate of the scanner
+/// \param dx The x component of the unit ray direction
+/// \param dy The y component of the unit ray direction
+/// \param cylinders The cylinders
+/// \param hit The index of the hit cylinder, -1 for a wall
+/// \return The distance to the first hit
+double cast(
+  double px, double py, double dx, double dy,
+  const std::vector<turtlelib::Point2D> & cylinders, int & hit)
+{
+  hit = -1;
+
+  auto t = std::numeric_limits<double>::infinity();
+
+  if (dx > 0.0) {t = std::min(t, (ARENA_HALF_LENGTH - px) / dx);}
+  if (dx < 0.0) {t = std::min(t, (-ARENA_HALF_LENGTH - px) / dx);}
+  if (dy > 0.0) {t = std::min(t, (ARENA_HALF_LENGTH - py) / dy);}
+  if (dy < 0.0) {t = std::min(t, (-ARENA_HALF_LENGTH - py) / dy);}
+
+  for (size_t i = 0; i < cylinders.size(); ++i) {
+    const auto ox = cylinders[i].x - px;
+    const auto oy = cylinders[i].y - py;
+    const auto along = ox * dx + oy * dy;
+    const auto d2 = ox * ox + oy * oy - along * along;
+    const auto r2 = CYLINDER_RADIUS * CYLINDER_RADIUS;
+
+    if (along > 0.0 && d2 < r2 && along - std::sqrt(r2 - d2) < t) {
+      t = along - std::sqrt(r2 - d2);
+      hit = static_cast<int>(i);
+    }
+  }
+
+  return t;
+}
+
+/// \brief Simulate scans from random poses in a random arena
+/// \return The scans
+std::vector<Scan> simulate_scans()
+{
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> position(-2.2, 2.2);
+  std::uniform_real_distribution<double> heading(-turtlelib::PI, turtlelib::PI);
+  std::normal_distribution<double> noise(0.0, RANGE_SIGMA);
+
+  std::vector<Scan> scans;
+
+  for (size_t k = 0; k < NUM_SIMULATED; ++k) {
+    /// Half of the cylinders have a neighbour 12 cm away
+    std::vector<turtlelib::Point2D> cylinders;
+    for (int i = 0; i < 6; ++i) {
+      const turtlelib::Point2D c{position(generator), position(generator)};
+      cylinders.push_back(c);
+
+      if (i % 2 == 0) {
+        cylinders.push_back({c.x + 0.12, c.y});
+      }
+    }
+
+    const turtlelib::Transform2D Tws({position(generator), position(generator)}, heading(generator));
+    const auto Tsw = Tws.inv();
+
+    Scan scan{0.0, turtlelib::deg2rad(1.0), 0.12, 3.5, {}, {}};
+    std::vector<size_t> hits(cylinders.size(), 0);
+
+    for (size_t i = 0; i < 360; ++i) {
+      const auto d = Tws(turtlelib::Vector2D{std::cos(i * scan.angle_increment),
+          std::sin(i * scan.angle_increment)});
+
+      int hit;
+      const auto range = cast(Tws.translation().x, Tws.translation().y, d.x, d.y, cylinders, hit);
+
+      if (range < scan.range_max) {
+        scan.ranges.push_back(static_cast<float>(range + noise(generator)));
+
+        if (hit != -1) {
+          ++hits.at(hit);
+        }
+      } else {
+        scan.ranges.push_back(0.0f);
+      }
+    }
+
+    for (size_t i = 0; i < cylinders.size(); ++i) {
+      if (hits.at(i) >= 4) {
+        scan.cylinders.push_back(Tsw(cylinders.at(i)));
+      }
+    }
+
+    scans.push_back(scan);
+  }
+
+  return scans;
+}
+
+/// \brief Segment and classify all scans, and print the statistics
+/// \param name The name of the segmentation
+/// \param segmenter The segmenter
+/// \param scans The scans
+void run(const char * name, turtlelib::ScanSegmenter & segmenter, const std::vector<Scan> & scans)
+{
+  const turtlelib::CircleClassifier classifier;
+
+  size_t clusters = 0;
+  size_t pure_clusters = 0;
+  size_t circles = 0;
+  size_t true_circles = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  for (const auto & scan : scans) {
+    const auto & scan_clusters = segmenter.segment(
+      scan.ranges, scan.angle_min, scan.angle_increment, scan.range_min, scan.range_max);
+
+    clusters += scan_clusters.size();
+
+    for (const auto & cluster : scan_clusters) {
+      /// A cluster holding exactly the points of one cylinder
+      for (const auto & c : scan.cylinders) {
+        bool pure = true;
+
+        for (auto i = cluster.begin; i < cluster.end && pure; ++i) {
+          const auto d = std::hypot(segmenter.x().at(i) - c.x, segmenter.y().at(i) - c.y);
+          pure = std::fabs(d - CYLINDER_RADIUS) < 4.0 * RANGE_SIGMA;
+        }
+
+        if (pure) {
+          ++pure_clusters;
+          break;
+        }
+      }
+
+      const auto fit = classifier.fit(
+        segmenter.x().data() + cluster.begin,
+        segmenter.y().data() + cluster.begin,
+        cluster.end - cluster.begin);
+
+      if (!fit.is_circle) {
+        continue;
+      }
+
+      ++circles;
+
+      for (const auto & c : scan.cylinders) {
+        if (std::hypot(fit.circle.x - c.x, fit.circle.y - c.y) < 0.02) {
+          ++true_circles;
+          break;
+        }
+      }
+    }
+  }
+
+  const auto stop = std::chrono::steady_clock::now();
+  const auto n = static_cast<double>(scans.size());
+  const auto us = std::chrono::duration<double, std::micro>(stop - start).count() / n;
+
+  std::printf(
+    "%-9s clusters %6.2f  cylinder clusters %5.2f  circles %5.2f  within 2 cm %5.2f"
+    "  %6.1f us\n",
+    name, clusters / n, pure_clusters / n, circles / n, true_circles / n, us);
+}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+  const auto scans = argc > 1 ? load_scans(argv[1]) : simulate_scans();
+
+  if (scans.empty()) {
+    std::fprintf(stderr, "No scans\n");
+    return 1;
+  }
+
+  std::printf(
+    "%zu %s scans, counts and times per scan\n", scans.size(),
+    argc > 1 ? "recorded" : "simulated");
+
+  if (argc == 1) {
+    size_t visible = 0;
+    for (const auto & scan : scans) {
+      visible += scan.cylinders.size();
+    }
+    std::printf(
+      "cylinders hit by 4 or more beams %.2f per scan\n",
+      static_cast<double>(visible) / static_cast<double>(scans.size()));
+  }
+
+  turtlelib::ScanSegmenter fixed(0.5, 4);
+  run("fixed", fixed, scans);
+
+  turtlelib::ScanSegmenter adaptive(0.5, 4);
+  adaptive.use_adaptive_threshold(turtlelib::deg2rad(10.0), RANGE_SIGMA);
+  run("adaptive", adaptive, scans);
+
+  return 0;
+}
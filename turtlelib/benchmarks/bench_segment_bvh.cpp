@@ -0,0 +1,137 @@
+/// \file bench_segment_bvh.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Compare lidar scans against every wall with the segment BVH.
+/// \version 0.1
+/// \date 2024-04-05
+///
+/// \copyright Copyright (c) 2024
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "turtlelib/beam_table.hpp"
+#include "turtlelib/geometry2d.hpp"
+#include "turtlelib/segment_bvh.hpp"
+
+namespace
+{
+constexpr int REPEATS = 20;
+constexpr double RANGE_MAX = 3.5;
+constexpr double RESOLUTION = 0.001;
+
+/// \brief Build a building of square rooms with doors
+/// \param rooms The number of rooms along each side
+/// \return The walls
+std::vector<turtlelib::Segment> building(size_t rooms)
+{
+  constexpr double ROOM = 4.0;
+  constexpr double DOOR = 0.9;
+
+  const auto length = ROOM * static_cast<double>(rooms);
+  std::vector<turtlelib::Segment> walls = turtlelib::arena_walls(length, length);
+
+  /// Every inner wall line has a door in the middle of every room
+  for (size_t k = 1; k < rooms; ++k) {
+    const auto line = -length / 2.0 + ROOM * static_cast<double>(k);
+
+    for (size_t j = 0; j < rooms; ++j) {
+      const auto lo = -length / 2.0 + ROOM * static_cast<double>(j);
+      const auto door_lo = lo + (ROOM - DOOR) / 2.0;
+      const auto door_hi = door_lo + DOOR;
+
+      walls.push_back({line, lo, line, door_lo});
+      walls.push_back({line, door_hi, line, lo + ROOM});
+      walls.push_back({lo, line, door_lo, line});
+      walls.push_back({door_hi, line, lo + ROOM, line});
+    }
+  }
+
+  return walls;
+}
+
+/// \brief Time a scan repeated from random poses
+/// \param scan The scan
+/// \return The average time of one scan in milliseconds
+template<class F>
+double time_ms(F scan)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  for (int k = 0; k < REPEATS; ++k) {
+    scan(k);
+  }
+
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count() / REPEATS;
+}
+
+/// \brief Benchmark one building
+/// \param rooms The number of rooms along each side
+void run(size_t rooms)
+{
+  const auto walls = building(rooms);
+  const auto half = 2.0 * static_cast<double>(rooms) - 0.1;
+
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<double> position(-half, half);
+
+  std::vector<double> pose_x(REPEATS), pose_y(REPEATS);
+  for (int k = 0; k < REPEATS; ++k) {
+    pose_x[k] = position(generator);
+    pose_y[k] = position(generator);
+  }
+
+  const auto num_beams = static_cast<size_t>(2.0 * turtlelib::PI / RESOLUTION);
+  const turtlelib::BeamTable table(-turtlelib::PI, RESOLUTION, num_beams);
+  const auto miss = std::numeric_limits<double>::infinity();
+
+  std::vector<double> all_ranges(num_beams), bvh_ranges(num_beams);
+
+  const auto all = time_ms(
+    [&](int k) {
+      for (size_t i = 0; i < num_beams; ++i) {
+        auto best = miss;
+
+        for (const auto & wall : walls) {
+          best = std::min(
+            best, turtlelib::raycast_segment(
+              pose_x[k], pose_y[k], table.cos()[i], table.sin()[i], wall));
+        }
+
+        all_ranges[i] = best <= RANGE_MAX ? best : miss;
+      }
+    });
+
+  const turtlelib::SegmentBVH bvh(walls);
+
+  const auto indexed = time_ms(
+    [&](int k) {
+      for (size_t i = 0; i < num_beams; ++i) {
+        bvh_ranges[i] = bvh.raycast(
+          pose_x[k], pose_y[k], table.cos()[i], table.sin()[i], RANGE_MAX);
+      }
+    });
+
+  size_t differing = 0;
+  for (size_t i = 0; i < num_beams; ++i) {
+    differing += !(all_ranges[i] == bvh_ranges[i] || std::fabs(all_ranges[i] - bvh_ranges[i]) < 1e-9);
+  }
+
+  std::printf(
+    "%6zu walls, %zu beams: all walls %9.3f ms, BVH %6.3f ms, speedup %6.1fx,"
+    " %zu differing beams\n",
+    walls.size(), num_beams, all, indexed, all / indexed, differing);
+}
+} // namespace
+
+int main()
+{
+  run(1);
+  run(3);
+  run(10);
+  run(50);
+  return 0;
+}
@@ -0,0 +1,74 @@
+/// \file beam_table.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Cached beam directions of a laser scanner.
+/// \version 0.1
+/// \date 2024-03-29
+///
+/// The beam angles of a scanner rarely change between scans, so the cosine
+/// and sine of every beam are computed once and reused until the angle of
+/// the first beam, the angle increment or the number of beams changes.
+/// Converting a scan to points is then two branchless sweeps of multiplies
+/// and compares over contiguous arrays, which the compiler vectorizes at the
+/// optimization level the library builds this file with.
+///
+/// \copyright Copyright (c) 2024
+#ifndef BEAM_TABLE_HPP_INCLUDE_GUARD
+#define BEAM_TABLE_HPP_INCLUDE_GUARD
+
+#include <cstdint>
+#include <vector>
+
+namespace turtlelib
+{
+/// \brief The directions of the beams of a laser scanner
+class BeamTable
+{
+private:
+  double angle_min_;
+  double angle_increment_;
+  std::vector<double> cos_;
+  std::vector<double> sin_;
+
+public:
+  /// \brief Construct an empty table
+  BeamTable();
+
+  /// \brief Construct the table of a scanner
+  /// \param angle_min The angle of the first beam
+  /// \param angle_increment The angle between two beams
+  /// \param count The number of beams
+  BeamTable(double angle_min, double angle_increment, size_t count);
+
+  /// \brief Recompute the table if the scanner geometry has changed
+  /// \param angle_min The angle of the first beam
+  /// \param angle_increment The angle between two beams
+  /// \param count The number of beams
+  /// \return Whether the table was recomputed
+  bool update(double angle_min, double angle_increment, size_t count);
+
+  /// \brief Convert ranges to points in the scanner frame
+  /// \param ranges The measured ranges, one per beam
+  /// \param range_min The smallest valid range, exclusive
+  /// \param range_max The largest valid range, exclusive
+  /// \param x The x coordinates of the points, one per beam
+  /// \param y The y coordinates of the points, one per beam
+  /// \param valid Whether each range is valid, 1 or 0
+  void to_cartesian(
+    const float * ranges, double range_min, double range_max,
+    double * x, double * y, uint8_t * valid) const;
+
+  /// \brief Get the number of beams
+  /// \return The number of beams
+  size_t size() const;
+
+  /// \brief Get the cosine of the beam angles
+  /// \return The cosine of every beam angle
+  const std::vector<double> & cos() const;
+
+  /// \brief Get the sine of the beam angles
+  /// \return The sine of every beam angle
+  const std::vector<double> & sin() const;
+};
+} // namespace turtlelib
+
+#endif
@@ -0,0 +1,80 @@
+/// \file circle_tracker.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Track detected circles from scan to scan.
+/// \version 0.1
+/// \date 2024-03-31
+///
+/// The circles of the last scan are moved into the frame of the new scan by
+/// the odometry between the two scans. A cluster lying on a predicted circle
+/// is assigned to its track and only needs a few geometric refinement steps
+/// from the prediction, and the track keeps its id for as long as it is seen.
+///
+/// \copyright Copyright (c) 2024
+#ifndef CIRCLE_TRACKER_HPP_INCLUDE_GUARD
+#define CIRCLE_TRACKER_HPP_INCLUDE_GUARD
+
+#include <vector>
+
+#include "turtlelib/detect.hpp"
+#include "turtlelib/se2d.hpp"
+
+namespace turtlelib
+{
+/// \brief A circle followed over consecutive scans
+struct CircleTrack
+{
+  /// \brief The stable id of the track
+  int id;
+
+  /// \brief The circle in the frame of the last scan, or the predicted one after predict
+  Landmark circle;
+
+  /// \brief The number of consecutive scans without the circle
+  size_t misses;
+};
+
+/// \brief Track circles over scans
+class CircleTracker
+{
+private:
+  double gate_;
+  size_t max_misses_;
+  int next_id_;
+  std::vector<CircleTrack> tracks_;
+
+public:
+  /// \brief Construct a tracker with a 2 cm gate, dropping tracks missed 3 scans in a row
+  CircleTracker();
+
+  /// \brief Construct a tracker
+  /// \param gate The largest root mean square distance of a cluster to a predicted circle
+  /// \param max_misses The number of consecutive missed scans to drop a track
+  CircleTracker(double gate, size_t max_misses);
+
+  /// \brief Move the tracked circles into the frame of the new scan
+  /// \param T_curr_prev The transform from the previous scan frame to the new scan frame
+  void predict(const Transform2D & T_curr_prev);
+
+  /// \brief Find the track a cluster lies on
+  /// \param x The x coordinates of the cluster
+  /// \param y The y coordinates of the cluster
+  /// \param num The number of points
+  /// \return The index of the closest predicted circle within the gate, or -1
+  int match(const double * x, const double * y, size_t num) const;
+
+  /// \brief Update the tracks with the circles of the new scan
+  /// \param circles The circles of the new scan
+  /// \param matches The track index of every circle from match, or -1
+  /// \return The track id of every circle
+  std::vector<int> update(const std::vector<Landmark> & circles, const std::vector<int> & matches);
+
+  /// \brief Get the tracks
+  /// \return The tracks
+  const std::vector<CircleTrack> & tracks() const;
+
+  /// \brief Drop all tracks, keeping the ids unique
+  void clear();
+};
+} // namespace turtlelib
+
+#endif
@@ -0,0 +1,91 @@
+/// \file consistency.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Filter consistency statistics (NIS/NEES) for the EKF.
+/// \version 0.1
+/// \date 2024-03-20
+///
+/// \copyright Copyright (c) 2024
+#ifndef CONSISTENCY_HPP_INCLUDE_GUARD
+#define CONSISTENCY_HPP_INCLUDE_GUARD
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace turtlelib
+{
+/// \brief 95% upper bound of the chi-square distribution with 2 DOF
+constexpr double CHI2_95_2DOF = 5.991;
+
+/// \brief 95% upper bound of the chi-square distribution with 3 DOF
+constexpr double CHI2_95_3DOF = 7.815;
+
+/// \brief Compute the normalized innovation squared of a 2D measurement
+/// \param dz The innovation [range, bearing]
+/// \param S The innovation covariance in row-major order [s00, s01, s10, s11]
+/// \return dz^T S^-1 dz
+double compute_nis(const std::array<double, 2> & dz, const std::array<double, 4> & S);
+
+/// \brief Compute the normalized estimation error squared of a robot pose
+/// \param error The pose error [theta, x, y]
+/// \param P The pose covariance in row-major order
+/// \return error^T P^-1 error
+double compute_nees(const std::array<double, 3> & error, const std::array<double, 9> & P);
+
+/// \brief Rolling statistics over a fixed window of samples
+class RollingStats
+{
+private:
+  std::vector<double> window_;
+  size_t head_;
+  size_t size_;
+  double window_sum_;
+  double bound_;
+  size_t window_above_;
+  size_t total_count_;
+  double total_sum_;
+  double max_;
+
+public:
+  /// \brief Construct a rolling statistics object
+  RollingStats();
+
+  /// \brief Construct a rolling statistics object
+  /// \param window The number of samples kept in the window
+  /// \param bound The consistency bound samples are compared against
+  RollingStats(size_t window, double bound);
+
+  /// \brief Add a new sample, does not allocate
+  /// \param value The sample value
+  void add(double value);
+
+  /// \brief Clear all the samples
+  void reset();
+
+  /// \brief Get the mean of the samples in the window
+  /// \return The window mean
+  double window_mean() const;
+
+  /// \brief Get the fraction of samples in the window above the bound
+  /// \return The fraction in [0, 1]
+  double fraction_above() const;
+
+  /// \brief Get the mean of all samples seen
+  /// \return The total mean
+  double total_mean() const;
+
+  /// \brief Get the largest sample seen
+  /// \return The maximum value
+  double max() const;
+
+  /// \brief Get the number of samples in the window
+  /// \return The window size
+  size_t window_count() const;
+
+  /// \brief Get the number of all samples seen
+  /// \return The total count
+  size_t total_count() const;
+};
+} // namespace turtlelib
+
+#endif
@@ -0,0 +1,67 @@
+/// \file counter_rng.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Counter based noise generation with Philox4x32-10.
+/// \version 0.1
+/// \date 2024-04-12
+///
+/// Every sample is a pure function of its key (seed, tick, stream) and its
+/// index, with no state carried between calls. The samples of a scan or a
+/// step therefore do not depend on the order they are drawn in or on the
+/// thread drawing them, and a range of samples is filled in bulk by running
+/// the rounds over arrays of counters, which the compiler vectorizes.
+///
+/// \copyright Copyright (c) 2024
+#ifndef COUNTER_RNG_HPP_INCLUDE_GUARD
+#define COUNTER_RNG_HPP_INCLUDE_GUARD
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace turtlelib
+{
+/// \brief A 128 bit block of Philox, as four 32 bit words
+using PhiloxBlock = std::array<uint32_t, 4>;
+
+/// \brief The key of a stream of samples
+struct NoiseKey
+{
+  /// \brief The seed of the run
+  uint64_t seed = 0;
+
+  /// \brief The simulation tick
+  uint64_t tick = 0;
+
+  /// \brief The kind of noise, and the robot it belongs to
+  uint32_t stream = 0;
+};
+
+/// \brief Encrypt a counter with Philox4x32-10
+/// \param counter The counter
+/// \param key The key, the low word first
+/// \return The random block
+PhiloxBlock philox4x32(const PhiloxBlock & counter, const std::array<uint32_t, 2> & key);
+
+/// \brief Fill uniform samples in (0, 1)
+///
+/// Sample i of a stream is lane i % 4 of block i / 4, so any sub range of
+/// the same stream gives the same samples.
+/// \param key The key of the stream
+/// \param first The index of the first sample
+/// \param count The number of samples
+/// \param out The samples
+void fill_uniform(const NoiseKey & key, uint64_t first, size_t count, double * out);
+
+/// \brief Fill standard normal samples, by Box-Muller on the uniform samples
+///
+/// Sample i of a stream is made from the same block as the uniform sample i.
+/// The logarithm, sine and cosine are series accurate to about 1e-15 rather
+/// than calls to the math library, so the conversion vectorizes as well.
+/// \param key The key of the stream
+/// \param first The index of the first sample
+/// \param count The number of samples
+/// \param out The samples
+void fill_normal(const NoiseKey & key, uint64_t first, size_t count, double * out);
+} // namespace turtlelib
+
+#endif
@@ -8,6 +8,7 @@
 #ifndef DETECT_HPP_INCLUDE_GUARD
 #define DETECT_HPP_INCLUDE_GUARD
 
+#include <cstdint>
 #include <vector>
 #include <armadillo>
 
@@ -28,6 +29,243 @@ struct Landmark
   double r;
 };
 
+/// \brief Fit a circle to points with the Hyper fit, from moments collected in a single pass
+///
+/// The moments are accumulated relative to the first point to avoid cancellation, the
+/// characteristic polynomial of the 4x4 moment matrix is solved by Newton's method from
+/// zero, and no memory is allocated.
+/// \param points The points on the circle, at least 3 and not collinear
+/// \return The fitted circle, with an infinite radius for collinear points
+Landmark fit_circle(const std::vector<Point2D> & points);
+
+/// \brief Fit a circle to points stored as separate coordinate arrays
+/// \param x The x coordinates of the points
+/// \param y The y coordinates of the points
+/// \param num The number of points, at least 3
+/// \return The fitted circle, with an infinite radius for collinear points
+Landmark fit_circle(const double * x, const double * y, size_t num);
+
+/// \brief Refine a circle by Gauss-Newton iterations on the geometric distances of the points
+///
+/// Starting from a good guess, such as the circle of the previous scan, a few iterations on the
+/// 3x3 normal equations replace a full algebraic fit.
+/// \param x The x coordinates of the points
+/// \param y The y coordinates of the points
+/// \param num The number of points, at least 3
+/// \param guess The initial circle
+/// \param iterations The largest number of iterations
+/// \return The refined circle, the guess if the normal equations are singular
+Landmark refine_circle(
+  const double * x, const double * y, size_t num, const Landmark & guess,
+  size_t iterations);
+
+/// \brief Compute the root mean square geometric distance of points to a circle
+/// \param x The x coordinates of the points
+/// \param y The y coordinates of the points
+/// \param num The number of points, at least 1
+/// \param circle The circle
+/// \return The root mean square distance
+double geometric_residual(const double * x, const double * y, size_t num, const Landmark & circle);
+
+/// \brief Fit a circle robustly, with RANSAC over three-point circles
+///
+/// Circles through three sampled points are scored by the number of points within the inlier
+/// threshold of them. The number of iterations shrinks as the best inlier ratio grows, down to
+/// what the requested confidence needs, and never exceeds the budget. The consensus set of the
+/// best circle is then refined with fit_circle. The consensus points are kept in scratch buffers
+/// that only grow, so one object should be used per thread.
+class RansacCircleFit
+{
+private:
+  double inlier_threshold_;
+  size_t max_iterations_;
+  double confidence_;
+  std::vector<double> inlier_x_;
+  std::vector<double> inlier_y_;
+
+public:
+  /// \brief Construct a fit with a 1 cm inlier threshold, 100 iterations at most and a
+  ///        confidence of 0.99
+  RansacCircleFit();
+
+  /// \brief Construct a fit
+  /// \param inlier_threshold The largest distance of an inlier from the circle
+  /// \param max_iterations The budget of sampled circles
+  /// \param confidence The probability of sampling three inliers at least once
+  RansacCircleFit(double inlier_threshold, size_t max_iterations, double confidence);
+
+  /// \brief Fit a circle to points stored as separate coordinate arrays
+  /// \param x The x coordinates of the points
+  /// \param y The y coordinates of the points
+  /// \param num The number of points, at least 3
+  /// \param seed The seed of the sampling, so a cluster always gets the same circle
+  /// \return The refined circle, fitted to all points if no three points define a circle
+  Landmark fit(const double * x, const double * y, size_t num, uint32_t seed);
+
+  /// \brief Get the x coordinates of the consensus set of the last fit, in input order
+  /// \return The x coordinates
+  const std::vector<double> & inlier_x() const;
+
+  /// \brief Get the y coordinates of the consensus set of the last fit, in input order
+  /// \return The y coordinates
+  const std::vector<double> & inlier_y() const;
+};
+
+/// \brief The statistics of the inscribed angles of a cluster
+struct InscribedAngles
+{
+  /// \brief The mean angle
+  double mean;
+
+  /// \brief The standard deviation of the angles
+  double stddev;
+};
+
+/// \brief Compute the inscribed angles of a cluster in a single pass
+///
+/// Every interior point sees the two end points of the cluster under an angle. On an arc the
+/// angles are all the same, 180 degrees minus half the arc, while on a wall they are close to
+/// 180 degrees and on a corner they spread out.
+/// \param x The x coordinates of the points
+/// \param y The y coordinates of the points
+/// \param num The number of points, at least 3
+/// \return The mean and standard deviation of the angles
+InscribedAngles inscribed_angles(const double * x, const double * y, size_t num);
+
+/// \brief How well a circle is supported by its points
+struct FitQuality
+{
+  /// \brief The root mean square geometric distance of the points to the circle
+  double residual;
+
+  /// \brief The number of points
+  size_t num_points;
+
+  /// \brief The angle the points cover around the center
+  double angular_span;
+};
+
+/// \brief Compute the quality of a fitted circle in a single pass
+/// \param x The x coordinates of the points, in scan order
+/// \param y The y coordinates of the points, in scan order
+/// \param num The number of points, at least 1
+/// \param circle The fitted circle
+/// \return The quality of the fit
+FitQuality fit_quality(const double * x, const double * y, size_t num, const Landmark & circle);
+
+/// \brief Turn the quality of circle fits into measurement noise
+///
+/// A circle measured from few points, a short arc or points far off the circle
+/// locates its center poorly. Fits below the gate are rejected, and the noise of
+/// the others grows with the squared residual and the squared inverse span.
+class FitQualityGate
+{
+private:
+  double max_residual_;
+  size_t min_points_;
+  double min_span_;
+  double reference_residual_;
+  double reference_span_;
+
+public:
+  /// \brief Construct a gate rejecting residuals over 2 cm, fewer than 4 points and
+  ///        spans under 0.3 rad, with a 1 cm residual and a quarter turn as references
+  FitQualityGate();
+
+  /// \brief Construct a gate
+  /// \param max_residual The largest accepted residual
+  /// \param min_points The smallest accepted number of points
+  /// \param min_span The smallest accepted angular span
+  /// \param reference_residual The residual up to which the noise is not inflated
+  /// \param reference_span The span from which on the noise is not inflated
+  FitQualityGate(
+    double max_residual, size_t min_points, double min_span, double reference_residual,
+    double reference_span);
+
+  /// \brief Whether a fit is good enough to be used
+  /// \param quality The quality of the fit, with 0 points when unknown
+  /// \return Whether the fit is accepted, always true for an unknown quality
+  bool accept(const FitQuality & quality) const;
+
+  /// \brief The factor scaling the measurement noise of a fit
+  /// \param quality The quality of the fit, with 0 points when unknown
+  /// \return The factor, at least 1 and exactly 1 for an unknown quality
+  double noise_scale(const FitQuality & quality) const;
+};
+
+/// \brief The result of classifying and fitting a cluster
+struct ClusterFit
+{
+  /// \brief The fitted circle, only set for accepted clusters
+  Landmark circle;
+
+  /// \brief The quality of the fitted circle, only set for accepted clusters
+  FitQuality quality;
+
+  /// \brief The inscribed angles of the cluster
+  InscribedAngles angles;
+
+  /// \brief Whether the cluster was accepted as a circle
+  bool is_circle;
+};
+
+/// \brief Reject clusters that are not arcs before fitting, and implausible circles after
+class CircleClassifier
+{
+private:
+  double min_mean_;
+  double max_mean_;
+  double max_stddev_;
+  double min_radius_;
+  double max_radius_;
+
+public:
+  /// \brief Construct a classifier accepting mean angles of 90 to 135 degrees spread by
+  ///        at most 0.15 rad, and radii of 0.01 to 0.1 m
+  CircleClassifier();
+
+  /// \brief Construct a classifier
+  /// \param min_mean The smallest mean inscribed angle
+  /// \param max_mean The largest mean inscribed angle
+  /// \param max_stddev The largest standard deviation of the inscribed angles
+  /// \param min_radius The smallest radius of an accepted circle
+  /// \param max_radius The largest radius of an accepted circle
+  CircleClassifier(
+    double min_mean, double max_mean, double max_stddev, double min_radius,
+    double max_radius);
+
+  /// \brief Whether inscribed angles come from an arc
+  /// \param angles The inscribed angles of a cluster
+  /// \return Whether the cluster is an arc
+  bool is_arc(const InscribedAngles & angles) const;
+
+  /// \brief Whether a fitted circle has a plausible radius
+  /// \param circle The fitted circle
+  /// \return Whether the radius is within the gate
+  bool in_radius_gate(const Landmark & circle) const;
+
+  /// \brief Classify a cluster and fit a circle to the arcs
+  /// \param x The x coordinates of the points
+  /// \param y The y coordinates of the points
+  /// \param num The number of points, at least 3
+  /// \return The classification and the fitted circle
+  ClusterFit fit(const double * x, const double * y, size_t num) const;
+
+  /// \brief Fit a circle with RANSAC, then classify its consensus set
+  ///
+  /// A cylinder next to a wall in the same cluster is not an arc as a whole, so the arc test
+  /// runs on the consensus set only.
+  /// \param x The x coordinates of the points
+  /// \param y The y coordinates of the points
+  /// \param num The number of points, at least 3
+  /// \param ransac The RANSAC fit of the calling thread
+  /// \param seed The seed of the sampling
+  /// \return The classification and the fitted circle
+  ClusterFit fit(
+    const double * x, const double * y, size_t num, RansacCircleFit & ransac,
+    uint32_t seed) const;
+};
+
 /// \brief The class for landmark detection
 class CircleDetect
 {
@@ -82,6 +320,11 @@ public:
   /// \return The resulting detected landmark
   Landmark detect_circle();
 
+  /// \brief Compute the quality of a circle fitted to the data points
+  /// \param circle The fitted circle
+  /// \return The quality of the fit
+  FitQuality quality(const Landmark & circle) const;
+
   /// \brief Get all data points
   /// \return All data points
   std::vector<Point2D> & get_data_points();
@@ -0,0 +1,76 @@
+/// \file distance_field.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A Euclidean distance field over the occupied cells of a map.
+/// \version 0.1
+/// \date 2024-04-06
+///
+/// The exact squared distance from every cell to the nearest occupied cell is
+/// computed once with the separable transform of Felzenszwalb and
+/// Huttenlocher, one pass over the columns and one over the rows. A point
+/// query is then a single lookup, and a ray jumps ahead by the clearance
+/// around it (sphere tracing) and only walks cell by cell next to walls.
+///
+/// \copyright Copyright (c) 2024
+#ifndef DISTANCE_FIELD_HPP_INCLUDE_GUARD
+#define DISTANCE_FIELD_HPP_INCLUDE_GUARD
+
+#include <cstddef>
+#include <vector>
+
+#include "turtlelib/occupancy_map.hpp"
+
+namespace turtlelib
+{
+/// \brief Compute the squared distance transform of a sampled function in one dimension
+/// \param f The function, 0 at the occupied samples and a large value elsewhere
+/// \param d The squared distances, the same size as f
+void distance_transform_1d(const std::vector<double> & f, std::vector<double> & d);
+
+/// \brief The distance to the nearest occupied cell of a map
+class DistanceField
+{
+private:
+  size_t width_;
+  size_t height_;
+  double resolution_;
+  double origin_x_;
+  double origin_y_;
+
+  /// The distance between the centers of every cell and the nearest occupied cell
+  std::vector<float> distance_;
+
+public:
+  /// \brief Construct an empty field
+  DistanceField();
+
+  /// \brief Compute the field of a map, unknown cells are free
+  /// \param map The map
+  explicit DistanceField(const OccupancyMap & map);
+
+  /// \brief Get the distance to the nearest occupied cell
+  /// \param x The x coordinate of the point
+  /// \param y The y coordinate of the point
+  /// \return The distance from the center of the cell holding the point, 0 in an occupied cell
+  ///         and infinity outside the map or without occupied cells
+  double distance(double x, double y) const;
+
+  /// \brief Cast a ray against the occupied cells
+  /// \param x The x coordinate of the origin of the ray
+  /// \param y The y coordinate of the origin of the ray
+  /// \param dx The x component of the unit direction of the ray
+  /// \param dy The y component of the unit direction of the ray
+  /// \param max_range The length of the ray
+  /// \return The distance to the first occupied cell, infinity without a hit within max_range
+  double raycast(double x, double y, double dx, double dy, double max_range) const;
+
+  /// \brief Get the number of columns
+  /// \return The number of columns
+  size_t width() const;
+
+  /// \brief Get the number of rows
+  /// \return The number of rows
+  size_t height() const;
+};
+} // namespace turtlelib
+
+#endif
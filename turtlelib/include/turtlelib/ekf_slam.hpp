@@ -112,6 +112,15 @@ public:
   /// \brief Get the covariance mattrix
   /// \return arma::mat The covariance matrix
   arma::mat get_covariance_mat() const;
+
+  /// \brief Fuse two landmarks found to be the same obstacle into one
+  ///
+  /// The constraint that both positions are equal is applied as a Kalman update,
+  /// then the dropped landmark is removed from the state and the covariance and
+  /// a blank slot is appended, so the later landmarks move down by one index.
+  /// \param keep The index of the landmark that is kept
+  /// \param drop The index of the landmark that is removed
+  void merge_landmarks(int keep, int drop);
 };
 } // namespace turtlelib
 
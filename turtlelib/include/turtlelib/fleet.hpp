@@ -0,0 +1,58 @@
+/// \file fleet.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief The states of a fleet of differential drive robots, stepped together.
+/// \version 0.1
+/// \date 2024-04-08
+///
+/// Every state variable of the fleet is one array with an entry per robot,
+/// so a step of the whole fleet is one loop over contiguous arrays instead of
+/// a call per robot object.
+///
+/// \copyright Copyright (c) 2024
+#ifndef FLEET_HPP_INCLUDE_GUARD
+#define FLEET_HPP_INCLUDE_GUARD
+
+#include <cstddef>
+#include <vector>
+
+namespace turtlelib
+{
+/// \brief The states of a fleet of differential drive robots, one entry per robot
+struct FleetState
+{
+  /// \brief The x coordinates of the robots
+  std::vector<double> x;
+
+  /// \brief The y coordinates of the robots
+  std::vector<double> y;
+
+  /// \brief The headings of the robots
+  std::vector<double> theta;
+
+  /// \brief The left wheel angles of the robots
+  std::vector<double> left_wheel;
+
+  /// \brief The right wheel angles of the robots
+  std::vector<double> right_wheel;
+};
+
+/// \brief Add a robot with its wheels at 0
+/// \param fleet The fleet
+/// \param x The x coordinate of the robot
+/// \param y The y coordinate of the robot
+/// \param theta The heading of the robot
+/// \return The index of the robot
+size_t add_robot(FleetState & fleet, double x, double y, double theta);
+
+/// \brief Move every robot of a fleet by the rotation of its wheels, like DiffDrive::compute_fk
+/// \param fleet The fleet, the wheel angles are left unchanged
+/// \param track_width The distance between the wheels
+/// \param wheel_radius The radius of the wheels
+/// \param delta_left The rotation of the left wheel of every robot
+/// \param delta_right The rotation of the right wheel of every robot
+void drive_fleet(
+  FleetState & fleet, double track_width, double wheel_radius,
+  const std::vector<double> & delta_left, const std::vector<double> & delta_right);
+} // namespace turtlelib
+
+#endif
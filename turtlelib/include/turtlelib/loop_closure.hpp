@@ -0,0 +1,76 @@
+/// \file loop_closure.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Detect duplicate landmarks from revisited landmark constellations.
+/// \version 0.1
+/// \date 2024-03-26
+///
+/// Each landmark is described by the sorted distances to its neighbours,
+/// leaving out the neighbours close enough to be its own duplicate. On a
+/// revisit the landmarks of a constellation are initialized again together,
+/// so a duplicate sees the other duplicates at the same distances as the
+/// original sees their originals. The distances of all landmarks are kept in
+/// an inverted index, and a landmark matching enough distances of a nearby
+/// older landmark is reported as its duplicate.
+///
+/// \copyright Copyright (c) 2024
+#ifndef LOOP_CLOSURE_HPP_INCLUDE_GUARD
+#define LOOP_CLOSURE_HPP_INCLUDE_GUARD
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "turtlelib/geometry2d.hpp"
+
+namespace turtlelib
+{
+/// \brief A pair of landmarks found to be the same obstacle
+struct LandmarkMatch
+{
+  /// \brief The index of the older landmark, which is kept
+  int keep;
+
+  /// \brief The index of the newer landmark, which is merged into the older one
+  int drop;
+
+  /// \brief The number of matching descriptor distances
+  size_t votes;
+};
+
+/// \brief The descriptor index for loop closure detection
+class LoopClosure
+{
+private:
+  size_t min_matches_;
+  double tolerance_;
+  double merge_radius_;
+  double descriptor_radius_;
+  std::vector<std::vector<double>> descriptors_;
+  std::unordered_map<int64_t, std::vector<std::pair<int, double>>> index_;
+
+public:
+  /// \brief Construct a loop closure detector needing 2 matches within 5 cm,
+  ///        with a 0.3 m merge radius and a 3 m descriptor radius
+  LoopClosure();
+
+  /// \brief Construct a loop closure detector
+  /// \param min_matches The number of matching distances to accept a duplicate
+  /// \param tolerance The largest difference of matching distances
+  /// \param merge_radius The largest distance between a landmark and its duplicate
+  /// \param descriptor_radius The largest neighbour distance in a descriptor
+  LoopClosure(size_t min_matches, double tolerance, double merge_radius, double descriptor_radius);
+
+  /// \brief Compute the descriptor of a landmark
+  /// \param landmarks All landmarks of the map
+  /// \param index The index of the described landmark
+  /// \return The sorted distances to the neighbours between the merge and descriptor radius
+  std::vector<double> describe(const std::vector<Point2D> & landmarks, size_t index) const;
+
+  /// \brief Find the landmarks that duplicate an older landmark
+  /// \param landmarks All landmarks of the map, oldest first
+  /// \return The matches, each landmark in at most one, ordered by decreasing drop index
+  std::vector<LandmarkMatch> find_duplicates(const std::vector<Point2D> & landmarks);
+};
+} // namespace turtlelib
+
+#endif
@@ -0,0 +1,84 @@
+/// \file mailbox.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A single slot mailbox in which the newest item wins.
+/// \version 0.1
+/// \date 2024-04-02
+///
+/// The producer exchanges the newest item into an atomic pointer and deletes
+/// whatever item it displaced, so a slow consumer always finds the newest item
+/// and never a backlog. Neither side ever blocks or takes a lock.
+///
+/// \copyright Copyright (c) 2024
+#ifndef MAILBOX_HPP_INCLUDE_GUARD
+#define MAILBOX_HPP_INCLUDE_GUARD
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace turtlelib
+{
+/// \brief A lock free single slot mailbox keeping only the latest item
+/// \tparam T The type of the items
+template<class T>
+class LatestMailbox
+{
+private:
+  std::atomic<T *> slot_;
+  std::atomic<uint64_t> dropped_;
+
+public:
+  /// \brief Construct an empty mailbox
+  LatestMailbox()
+  : slot_(nullptr), dropped_(0)
+  {
+  }
+
+  /// \brief Delete the item left in the mailbox
+  ~LatestMailbox()
+  {
+    delete slot_.exchange(nullptr);
+  }
+
+  LatestMailbox(const LatestMailbox &) = delete;
+  LatestMailbox & operator=(const LatestMailbox &) = delete;
+
+  /// \brief Put an item, replacing the item not taken yet
+  /// \param item The item
+  /// \return Whether an item was dropped
+  bool put(std::unique_ptr<T> item)
+  {
+    const std::unique_ptr<T> old(slot_.exchange(item.release(), std::memory_order_acq_rel));
+
+    if (old) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    return false;
+  }
+
+  /// \brief Take the latest item
+  /// \return The item, empty if there is none
+  std::unique_ptr<T> take()
+  {
+    return std::unique_ptr<T>(slot_.exchange(nullptr, std::memory_order_acq_rel));
+  }
+
+  /// \brief Whether there is an item to take
+  /// \return Whether the mailbox holds an item
+  bool empty() const
+  {
+    return slot_.load(std::memory_order_acquire) == nullptr;
+  }
+
+  /// \brief Get the number of items replaced before they were taken
+  /// \return The number of dropped items
+  uint64_t dropped() const
+  {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+};
+} // namespace turtlelib
+
+#endif
@@ -0,0 +1,82 @@
+/// \file map_io.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Binary persistence of the EKF SLAM map.
+/// \version 0.1
+/// \date 2024-03-20
+///
+/// The map file is a fixed size header followed by the state vector and the
+/// column-major covariance matrix as native doubles, so that it can be memory
+/// mapped and copied without any parsing.
+///
+/// \copyright Copyright (c) 2024
+#ifndef MAP_IO_HPP_INCLUDE_GUARD
+#define MAP_IO_HPP_INCLUDE_GUARD
+
+#include <cstdint>
+#include <string>
+#include <armadillo>
+
+#include "turtlelib/se2d.hpp"
+#include "turtlelib/ekf_slam.hpp"
+
+namespace turtlelib
+{
+/// \brief The magic bytes at the start of a map file
+constexpr char MAP_FILE_MAGIC[8] = {'N', 'U', 'S', 'L', 'A', 'M', 'A', 'P'};
+
+/// \brief The current version of the map file format
+constexpr uint32_t MAP_FILE_VERSION = 1;
+
+/// \brief The largest number of landmarks of a map file, which keeps its size far from overflowing
+constexpr uint32_t MAP_FILE_MAX_LANDMARKS = 1u << 16;
+
+/// \brief The fixed size header of a map file
+struct MapFileHeader
+{
+  /// \brief The magic bytes, always MAP_FILE_MAGIC
+  char magic[8];
+
+  /// \brief The version of the file format
+  uint32_t version;
+
+  /// \brief The number of landmark slots in the state
+  uint32_t num_landmarks;
+
+  /// \brief The length of the state vector, 3 + 2 * num_landmarks
+  uint64_t state_size;
+
+  /// \brief The map to odom transform [x, y, theta]
+  double map_odom[3];
+
+  /// \brief The robot pose in the map frame [theta, x, y]
+  double robot[3];
+};
+
+/// \brief The EKF SLAM map kept on disk
+struct SlamMap
+{
+  /// \brief The transform from the map frame to the odom frame
+  Transform2D Tmo;
+
+  /// \brief The robot pose in the map frame
+  RobotState robot;
+
+  /// \brief The full state vector [theta, x, y, m1x, m1y, ...]
+  arma::vec state;
+
+  /// \brief The full covariance matrix
+  arma::mat covariance;
+};
+
+/// \brief Write the map to a binary file
+/// \param filename The path of the map file
+/// \param map The map to write
+void save_map(const std::string & filename, const SlamMap & map);
+
+/// \brief Memory map a binary map file and load it
+/// \param filename The path of the map file
+/// \return The loaded map
+SlamMap load_map(const std::string & filename);
+} // namespace turtlelib
+
+#endif
@@ -0,0 +1,100 @@
+/// \file obstacle_grid.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A uniform grid over cylindrical obstacles.
+/// \version 0.1
+/// \date 2024-04-04
+///
+/// Every obstacle is listed in all cells its disk overlaps, and the lists of
+/// all cells are packed into one array with an offset per cell. A disk query
+/// visits only the cells around the disk, and a ray walks the cells it
+/// crosses in order and stops in the first cell holding a hit, so the cost
+/// of both no longer grows with the number of obstacles in the world. A fan
+/// of rays from one origin, like a lidar scan, takes the obstacles within
+/// reach from a disk query and intersects them with all rays in cast_rays.
+///
+/// \copyright Copyright (c) 2024
+#ifndef OBSTACLE_GRID_HPP_INCLUDE_GUARD
+#define OBSTACLE_GRID_HPP_INCLUDE_GUARD
+
+#include <cstddef>
+#include <vector>
+
+#include "turtlelib/trig2d.hpp"
+
+namespace turtlelib
+{
+/// \brief A uniform grid index over cylindrical obstacles
+class ObstacleGrid
+{
+private:
+  Obstacles obstacles_;
+  double cell_size_;
+  double min_x_;
+  double min_y_;
+  size_t cols_;
+  size_t rows_;
+
+  /// The obstacles of cell c are cell_items_[cell_start_[c]] to cell_items_[cell_start_[c + 1]]
+  std::vector<size_t> cell_start_;
+  std::vector<size_t> cell_items_;
+
+  /// \brief Get the column of an x coordinate, clamped to the grid
+  /// \param x The x coordinate
+  /// \return The column
+  size_t col_(double x) const;
+
+  /// \brief Get the row of a y coordinate, clamped to the grid
+  /// \param y The y coordinate
+  /// \return The row
+  size_t row_(double y) const;
+
+public:
+  /// \brief Construct an empty grid
+  ObstacleGrid();
+
+  /// \brief Construct the grid of a set of obstacles
+  /// \param obstacles The obstacles
+  /// \param cell_size The side length of a cell
+  ObstacleGrid(const Obstacles & obstacles, double cell_size);
+
+  /// \brief Find the obstacles overlapping a disk
+  /// \param x The x coordinate of the center of the disk
+  /// \param y The y coordinate of the center of the disk
+  /// \param radius The radius of the disk
+  /// \param indices The indices of the overlapping obstacles in increasing order
+  void query(double x, double y, double radius, std::vector<size_t> & indices) const;
+
+  /// \brief Cast a ray against the obstacles
+  /// \param x The x coordinate of the origin of the ray
+  /// \param y The y coordinate of the origin of the ray
+  /// \param dx The x component of the unit direction of the ray
+  /// \param dy The y component of the unit direction of the ray
+  /// \param max_range The length of the ray
+  /// \return The distance to the first hit, infinity without a hit within max_range.
+  ///         Obstacles around the origin are not seen, like in cast_rays.
+  double raycast(double x, double y, double dx, double dy, double max_range) const;
+
+  /// \brief Cast a fan of rays from one origin against the obstacles
+  /// \param x The x coordinate of the origin of the rays
+  /// \param y The y coordinate of the origin of the rays
+  /// \param dir_x The x components of the unit directions of the rays
+  /// \param dir_y The y components of the unit directions of the rays
+  /// \param num_rays The number of rays
+  /// \param max_range The length of the rays
+  /// \param ranges The distance to the first hit of every ray, infinity without a hit
+  ///        within max_range. Obstacles around the origin are not seen, like in cast_rays.
+  void raycast(
+    double x, double y, const double * dir_x, const double * dir_y, size_t num_rays,
+    double max_range, double * ranges) const;
+
+  /// \brief Get the obstacles
+  /// \return The obstacles
+  const Obstacles & obstacles() const;
+
+  /// \brief Get the number of cells
+  /// \return The number of cells
+  size_t num_cells() const;
+};
+} // namespace turtlelib
+
+#endif
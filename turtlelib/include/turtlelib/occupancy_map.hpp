@@ -0,0 +1,74 @@
+/// \file occupancy_map.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Loading of PGM occupancy maps described by a map_server YAML file.
+/// \version 0.1
+/// \date 2024-04-06
+///
+/// The cells are stored like in nav_msgs/OccupancyGrid: row major, starting
+/// at the bottom left corner at the origin, with 0 for free, 100 for occupied
+/// and -1 for unknown cells. The image is thresholded like the trinary mode
+/// of map_server.
+///
+/// \copyright Copyright (c) 2024
+#ifndef OCCUPANCY_MAP_HPP_INCLUDE_GUARD
+#define OCCUPANCY_MAP_HPP_INCLUDE_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace turtlelib
+{
+/// \brief The value of a free cell
+constexpr int8_t CELL_FREE = 0;
+
+/// \brief The value of an occupied cell
+constexpr int8_t CELL_OCCUPIED = 100;
+
+/// \brief The value of an unknown cell
+constexpr int8_t CELL_UNKNOWN = -1;
+
+/// \brief An occupancy grid map
+struct OccupancyMap
+{
+  /// \brief The number of columns
+  size_t width = 0;
+
+  /// \brief The number of rows
+  size_t height = 0;
+
+  /// \brief The side length of a cell
+  double resolution = 1.0;
+
+  /// \brief The x coordinate of the bottom left corner
+  double origin_x = 0.0;
+
+  /// \brief The y coordinate of the bottom left corner
+  double origin_y = 0.0;
+
+  /// \brief The cells, row major from the bottom row
+  std::vector<int8_t> data;
+};
+
+/// \brief Read an occupancy map from a binary (P5) or plain (P2) PGM image
+/// \param stream The image
+/// \param resolution The side length of a cell
+/// \param origin_x The x coordinate of the bottom left corner
+/// \param origin_y The y coordinate of the bottom left corner
+/// \param negate Whether white is occupied instead of black
+/// \param occupied_thresh The occupancy probability above which a cell is occupied
+/// \param free_thresh The occupancy probability below which a cell is free
+/// \return The map
+OccupancyMap read_pgm(
+  std::istream & stream, double resolution, double origin_x, double origin_y,
+  bool negate = false, double occupied_thresh = 0.65, double free_thresh = 0.196);
+
+/// \brief Load an occupancy map from a map_server YAML file and its image
+/// \param yaml_filename The path of the YAML file, the image path is relative to it
+/// \return The map
+OccupancyMap load_occupancy_map(const std::string & yaml_filename);
+} // namespace turtlelib
+
+#endif
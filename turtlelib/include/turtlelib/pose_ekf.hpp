@@ -0,0 +1,121 @@
+/// \file pose_ekf.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Pose only Extended Kalman Filter against a frozen landmark map.
+/// \version 0.1
+/// \date 2024-03-22
+///
+/// The state is only the robot pose [theta, x, y], so that a correction costs
+/// the same no matter how many landmarks the map holds. The uncertainty of the
+/// landmarks is folded into the measurement noise instead of the state.
+///
+/// \copyright Copyright (c) 2024
+#ifndef POSE_EKF_HPP_INCLUDE_GUARD
+#define POSE_EKF_HPP_INCLUDE_GUARD
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "turtlelib/geometry2d.hpp"
+#include "turtlelib/ekf_slam.hpp"
+
+namespace turtlelib
+{
+/// \brief A landmark of the frozen map
+struct MapLandmark
+{
+  /// \brief The x position in the map frame
+  double x;
+
+  /// \brief The y position in the map frame
+  double y;
+
+  /// \brief The row-major 2x2 position covariance
+  std::array<double, 4> covariance;
+
+  /// \brief The id of the landmark in the SLAM map
+  int uid;
+};
+
+/// \brief The innovation of a single correction
+struct Innovation
+{
+  /// \brief The measurement difference [range, bearing]
+  std::array<double, 2> dz;
+
+  /// \brief The row-major 2x2 innovation covariance
+  std::array<double, 4> S;
+};
+
+/// \brief The EKF over the robot pose only, with the landmarks held fixed
+class PoseEKF
+{
+private:
+  RobotState state_;
+  std::array<double, 9> covariance_;
+  std::vector<MapLandmark> landmarks_;
+  std::unordered_map<int64_t, std::vector<int>> grid_;
+  double cell_size_;
+
+  /// \brief Get the key of the grid cell holding a coordinate
+  /// \param ix The cell column
+  /// \param iy The cell row
+  /// \return The hash key of the cell
+  static int64_t cell_key(int64_t ix, int64_t iy);
+
+  /// \brief Get the cell index of a coordinate
+  /// \param value The coordinate
+  /// \return The cell index
+  int64_t cell_index(double value) const;
+
+public:
+  /// \brief Construct a pose EKF with an association gate of 0.1 m
+  PoseEKF();
+
+  /// \brief Construct a pose EKF
+  /// \param gate The maximum distance between an observation and its landmark,
+  ///             also the cell size of the landmark grid.
+  explicit PoseEKF(double gate);
+
+  /// \brief Replace the landmark map
+  /// \param landmarks The landmarks in the map frame
+  void set_map(const std::vector<MapLandmark> & landmarks);
+
+  /// \brief Reset the robot pose and its covariance
+  /// \param state The robot pose
+  /// \param covariance The row-major 3x3 pose covariance over [theta, x, y]
+  void reset(const RobotState & state, const std::array<double, 9> & covariance);
+
+  /// \brief Propagate the covariance to the odometry predicted pose
+  /// \param state The predicted robot pose
+  /// \param Q The row-major 3x3 process noise
+  void predict(const RobotState & state, const std::array<double, 9> & Q);
+
+  /// \brief Find the landmark closest to a point within the gate
+  /// \param point The observed point in the map frame
+  /// \return The index of the landmark, -1 if none is within the gate
+  int associate(Point2D point) const;
+
+  /// \brief Correct the pose with an observation of a known landmark
+  /// \param observation The observed landmark in the body frame
+  /// \param index The index of the landmark in the map
+  /// \param sensor_variance The variance of the range and bearing noise
+  /// \return The innovation of the correction
+  Innovation correct(Point2D observation, int index, double sensor_variance);
+
+  /// \brief Get the robot pose
+  /// \return The robot pose
+  RobotState get_robot_state() const;
+
+  /// \brief Get the pose covariance
+  /// \return The row-major 3x3 pose covariance over [theta, x, y]
+  std::array<double, 9> get_covariance() const;
+
+  /// \brief Get the landmark map
+  /// \return All landmarks of the map
+  const std::vector<MapLandmark> & get_map() const;
+};
+} // namespace turtlelib
+
+#endif
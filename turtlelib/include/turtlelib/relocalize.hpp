@@ -0,0 +1,119 @@
+/// \file relocalize.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Global relocalization by geometric hashing of landmark triplets.
+/// \version 0.1
+/// \date 2024-03-24
+///
+/// Every triplet of mapped landmarks whose sides are all shorter than a
+/// maximum length is indexed by its sorted side lengths, which do not depend
+/// on the robot pose. A scan looks up its own triplets, each match votes for
+/// the pose that aligns the two triangles, and the most voted poses are
+/// verified against all observations.
+///
+/// \copyright Copyright (c) 2024
+#ifndef RELOCALIZE_HPP_INCLUDE_GUARD
+#define RELOCALIZE_HPP_INCLUDE_GUARD
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "turtlelib/geometry2d.hpp"
+#include "turtlelib/se2d.hpp"
+
+namespace turtlelib
+{
+/// \brief A verified pose of the robot in the map
+struct PoseHypothesis
+{
+  /// \brief The transform from the map to the body frame
+  Transform2D Tmb;
+
+  /// \brief The number of observations matching a landmark
+  size_t inliers;
+
+  /// \brief The root mean square distance of the inliers to their landmarks
+  double rms_error;
+};
+
+/// \brief Relocalize the robot against a landmark map from a single scan
+class Relocalizer
+{
+private:
+  std::vector<Point2D> landmarks_;
+  std::unordered_map<int64_t, std::vector<std::array<int, 3>>> table_;
+  double resolution_;
+  double max_side_;
+  double angle_resolution_;
+  int64_t num_angle_bins_;
+
+  /// \brief Get the hash key of a quantized side length triple
+  /// \param q The quantized sorted side lengths
+  /// \return The hash key
+  static int64_t triplet_key(const std::array<int64_t, 3> & q);
+
+  /// \brief Order the vertices of a triangle by their opposite side length
+  /// \param points The points of the whole set
+  /// \param triplet The vertex indices, reordered in place
+  /// \return The sorted side lengths
+  static std::array<double, 3> canonical_triplet(
+    const std::vector<Point2D> & points,
+    std::array<int, 3> & triplet);
+
+  /// \brief Count the observations matching a landmark under a pose
+  /// \param observations The observed landmarks in the body frame
+  /// \param Tmb The candidate pose
+  /// \param inlier_radius The maximum distance to a landmark
+  /// \param matches The landmark index of each observation, -1 if unmatched
+  /// \return The sum of the squared inlier distances
+  double match(
+    const std::vector<Point2D> & observations,
+    const Transform2D & Tmb,
+    double inlier_radius,
+    std::vector<int> & matches) const;
+
+public:
+  /// \brief Construct a relocalizer with 5 cm and 0.05 rad bins and 2 m triplet sides
+  Relocalizer();
+
+  /// \brief Construct a relocalizer with 0.05 rad rotation bins
+  /// \param resolution The bin size of the side lengths and the pose vote translations
+  /// \param max_side The longest triangle side that is indexed
+  Relocalizer(double resolution, double max_side);
+
+  /// \brief Construct a relocalizer
+  /// \param resolution The bin size of the side lengths and the pose vote translations
+  /// \param max_side The longest triangle side that is indexed
+  /// \param angle_resolution The largest bin size of the pose vote rotations
+  Relocalizer(double resolution, double max_side, double angle_resolution);
+
+  /// \brief Index a landmark map
+  /// \param landmarks The landmarks in the map frame
+  void set_map(const std::vector<Point2D> & landmarks);
+
+  /// \brief Get the number of indexed triplets
+  /// \return The number of triplets in the hash table
+  size_t num_triplets() const;
+
+  /// \brief Find the robot pose from the landmarks observed in one scan
+  /// \param observations The observed landmarks in the body frame
+  /// \param inlier_radius The maximum distance of an observation to its landmark
+  /// \param min_inliers The minimum number of inliers of an accepted pose
+  /// \param hypothesis The best verified pose
+  /// \return Whether a pose was accepted
+  bool relocalize(
+    const std::vector<Point2D> & observations,
+    double inlier_radius,
+    size_t min_inliers,
+    PoseHypothesis & hypothesis) const;
+};
+
+/// \brief Find the rigid transform that best maps a set of points onto another
+/// \param from The points in the source frame
+/// \param to The corresponding points in the target frame
+/// \return The least squares transform from the source to the target frame
+Transform2D align_points(const std::vector<Point2D> & from, const std::vector<Point2D> & to);
+} // namespace turtlelib
+
+#endif
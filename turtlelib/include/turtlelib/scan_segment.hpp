@@ -0,0 +1,122 @@
+/// \file scan_segment.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Split a laser scan into clusters of neighbouring points.
+/// \version 0.1
+/// \date 2024-03-28
+///
+/// The points of a scan are kept in persistent struct-of-arrays buffers that
+/// only grow, so segmenting a scan allocates nothing once the buffers have
+/// reached the scan size. The valid points are stored starting right after a
+/// break of the scan, so a cluster crossing the end of the scan lies in one
+/// contiguous index range like any other.
+///
+/// Neighbouring points are split either at a fixed distance, or at the
+/// adaptive breakpoint distance of Borges and Aldon, which grows with the
+/// range: a surface seen at the grazing angle lambda spaces consecutive points
+/// r sin(dphi) / sin(lambda - dphi) apart, plus three standard deviations of
+/// the range noise. Far objects then stay whole, and near objects standing
+/// close together are still split.
+///
+/// \copyright Copyright (c) 2024
+#ifndef SCAN_SEGMENT_HPP_INCLUDE_GUARD
+#define SCAN_SEGMENT_HPP_INCLUDE_GUARD
+
+#include <cstdint>
+#include <vector>
+
+#include "turtlelib/geometry2d.hpp"
+#include "turtlelib/beam_table.hpp"
+
+namespace turtlelib
+{
+/// \brief A cluster of scan points, as an index range into the point buffers
+struct ScanCluster
+{
+  /// \brief The index of the first point
+  size_t begin;
+
+  /// \brief One past the index of the last point
+  size_t end;
+};
+
+/// \brief Segment laser scans into clusters
+class ScanSegmenter
+{
+private:
+  double distance_threshold_;
+  size_t min_points_;
+  bool adaptive_;
+  double lambda_;
+  double range_sigma_;
+
+  /// The adaptive breakpoint distance per meter of range for the current scan
+  double adaptive_gain_;
+
+  BeamTable table_;
+
+  /// Beam order buffers
+  std::vector<double> beam_x_;
+  std::vector<double> beam_y_;
+  std::vector<uint8_t> beam_valid_;
+
+  /// Valid points, starting after a break of the scan
+  std::vector<double> x_;
+  std::vector<double> y_;
+  std::vector<ScanCluster> clusters_;
+
+  /// \brief Convert the ranges to points in the beam order buffers
+  /// \param ranges The measured ranges
+  /// \param angle_min The angle of the first beam
+  /// \param angle_increment The angle between two beams
+  /// \param range_min The smallest valid range
+  /// \param range_max The largest valid range
+  void convert_(
+    const std::vector<float> & ranges, double angle_min, double angle_increment,
+    double range_min, double range_max);
+
+  /// \brief Whether two consecutive beams belong to different clusters
+  /// \param previous The index of the previous beam
+  /// \param current The index of the current beam
+  /// \return Whether there is a break between the beams
+  bool is_break_(size_t previous, size_t current) const;
+
+public:
+  /// \brief Construct a segmenter splitting at 0.5 m gaps and keeping clusters of 4 points
+  ScanSegmenter();
+
+  /// \brief Construct a segmenter
+  /// \param distance_threshold The smallest gap between neighbouring points of two clusters
+  /// \param min_points The smallest number of points of a kept cluster
+  ScanSegmenter(double distance_threshold, size_t min_points);
+
+  /// \brief Split at the adaptive breakpoint distance instead of the fixed distance
+  /// \param lambda The smallest angle between a surface and a beam, larger than the beam increment
+  /// \param range_sigma The standard deviation of the range noise
+  void use_adaptive_threshold(double lambda, double range_sigma);
+
+  /// \brief Segment a laser scan
+  /// \param ranges The measured ranges
+  /// \param angle_min The angle of the first beam
+  /// \param angle_increment The angle between two beams
+  /// \param range_min The smallest valid range, exclusive
+  /// \param range_max The largest valid range, exclusive
+  /// \return The clusters, valid until the next call
+  const std::vector<ScanCluster> & segment(
+    const std::vector<float> & ranges, double angle_min, double angle_increment,
+    double range_min, double range_max);
+
+  /// \brief Get the x coordinates of the valid points of the last scan
+  /// \return The x coordinates
+  const std::vector<double> & x() const;
+
+  /// \brief Get the y coordinates of the valid points of the last scan
+  /// \return The y coordinates
+  const std::vector<double> & y() const;
+
+  /// \brief Get the clusters of the last scan
+  /// \return The clusters
+  const std::vector<ScanCluster> & clusters() const;
+};
+} // namespace turtlelib
+
+#endif
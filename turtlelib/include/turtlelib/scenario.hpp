@@ -0,0 +1,161 @@
+/// \file scenario.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Batches of noisy simulator runs and their result files.
+/// \version 0.1
+/// \date 2024-04-10
+///
+/// A batch is one world, one robot and one wheel command, run once per
+/// scenario with its own noise parameters and seed. A scenario only depends
+/// on its seed, so the scenarios of a batch can run on any number of threads
+/// and still give the same results. The results are written as a fixed size
+/// header followed by one fixed size record per scenario.
+///
+/// \copyright Copyright (c) 2024
+#ifndef SCENARIO_HPP_INCLUDE_GUARD
+#define SCENARIO_HPP_INCLUDE_GUARD
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "turtlelib/segment_bvh.hpp"
+#include "turtlelib/trig2d.hpp"
+#include "turtlelib/world_sim.hpp"
+
+namespace turtlelib
+{
+/// \brief The magic bytes at the start of a result file
+constexpr char RESULT_FILE_MAGIC[8] = {'N', 'U', 'S', 'I', 'M', 'R', 'E', 'S'};
+
+/// \brief The current version of the result file format
+constexpr uint32_t RESULT_FILE_VERSION = 1;
+
+/// \brief One noisy run of a batch
+struct Scenario
+{
+  /// \brief The seed of the noise generator
+  uint32_t seed = 0;
+
+  /// \brief The variance of the wheel velocity noise
+  double input_noice = 0.0;
+
+  /// \brief The largest fraction of wheel slip
+  double slip_fraction = 0.0;
+
+  /// \brief The variance of the fake obstacle sensor noise
+  double basic_sensor_variance = 0.0;
+};
+
+/// \brief A world, a robot and its wheel commands, run once per scenario
+struct ScenarioBatch
+{
+  /// \brief The simulation parameters, the noise is set by each scenario
+  SimParams params;
+
+  /// \brief The obstacles
+  Obstacles obstacles;
+
+  /// \brief The walls
+  std::vector<Segment> walls;
+
+  /// \brief The cell size of the obstacle grid
+  double cell_size = 0.5;
+
+  /// \brief The simulated time of a run in seconds
+  double duration = 60.0;
+
+  /// \brief The period of the fake sensor in seconds
+  double sensor_period = 0.2;
+
+  /// \brief The starting pose of the robot
+  double x0 = 0.0;
+  double y0 = 0.0;
+  double theta0 = 0.0;
+
+  /// \brief The motor commands of the wheels
+  double left_cmd = 0.0;
+  double right_cmd = 0.0;
+
+  /// \brief The scenarios
+  std::vector<Scenario> scenarios;
+};
+
+/// \brief The outcome of a scenario, stored as is in a result file
+struct ScenarioResult
+{
+  /// \brief The seed of the scenario
+  uint32_t seed;
+
+  /// \brief The number of times the robot was moved back by a collision
+  uint32_t collisions;
+
+  /// \brief The number of fake sensor measurements
+  uint64_t measurements;
+
+  /// \brief The noise of the scenario
+  double input_noice;
+  double slip_fraction;
+  double basic_sensor_variance;
+
+  /// \brief The final pose of the robot [x, y, theta]
+  double truth[3];
+
+  /// \brief The final pose integrated from the encoders [x, y, theta]
+  double odometry[3];
+
+  /// \brief The final distance between the odometry and the robot
+  double final_error;
+
+  /// \brief The largest distance between the odometry and the robot
+  double max_error;
+
+  /// \brief The root mean square error of the fake sensor measurements
+  double sensor_rmse;
+};
+
+/// \brief Read a batch from a text description
+///
+/// Every line is a keyword and its values, # starts a comment:
+///   param <name> <value>      Set a simulation parameter, e.g. param track_width 0.16
+///   obstacle <x> <y> <r>      Add an obstacle
+///   wall <x1> <y1> <x2> <y2>  Add a wall
+///   arena <x_length> <y_length> Add the four walls of a rectangular arena
+///   cell_size <size>          The cell size of the obstacle grid
+///   duration <seconds>        The simulated time of a run
+///   start <x> <y> <theta>     The starting pose of the robot
+///   wheel_cmd <left> <right>  The motor commands of the wheels
+///   scenario <seed> <input_noice> <slip_fraction> <basic_sensor_variance>
+///   sweep <first_seed> <count> <input_noice> <slip_fraction> <basic_sensor_variance>
+///                             Add count scenarios with consecutive seeds
+/// \param stream The description
+/// \return The batch
+/// \throw std::runtime_error for an unknown keyword or a malformed line
+ScenarioBatch read_scenarios(std::istream & stream);
+
+/// \brief Build the world of a batch
+/// \param batch The batch
+/// \return The world, shared by all its scenarios
+std::shared_ptr<const World> build_world(const ScenarioBatch & batch);
+
+/// \brief Run a scenario of a batch
+/// \param batch The batch
+/// \param world The world of the batch
+/// \param scenario The scenario
+/// \return The outcome
+ScenarioResult run_scenario(
+  const ScenarioBatch & batch, std::shared_ptr<const World> world, const Scenario & scenario);
+
+/// \brief Write results to a binary file
+/// \param filename The path of the result file
+/// \param results The results
+void save_results(const std::string & filename, const std::vector<ScenarioResult> & results);
+
+/// \brief Read the results of a binary file
+/// \param filename The path of the result file
+/// \return The results
+std::vector<ScenarioResult> load_results(const std::string & filename);
+} // namespace turtlelib
+
+#endif
@@ -0,0 +1,126 @@
+/// \file segment_bvh.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A bounding volume hierarchy over line segment walls.
+/// \version 0.1
+/// \date 2024-04-05
+///
+/// The segments are split at the median of their centers along the longer
+/// side of the box around them until a few segments are left per leaf. The
+/// nodes are stored depth first in one array, so the left child of a node is
+/// the next node. A ray visits the closer child first and skips every node
+/// whose box it enters beyond the closest hit so far. A distance query skips
+/// every node whose box is farther than the closest segment so far.
+///
+/// \copyright Copyright (c) 2024
+#ifndef SEGMENT_BVH_HPP_INCLUDE_GUARD
+#define SEGMENT_BVH_HPP_INCLUDE_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace turtlelib
+{
+/// \brief A line segment wall
+struct Segment
+{
+  /// \brief x coordinate of the start point
+  double x1;
+
+  /// \brief y coordinate of the start point
+  double y1;
+
+  /// \brief x coordinate of the end point
+  double x2;
+
+  /// \brief y coordinate of the end point
+  double y2;
+};
+
+/// \brief Cast a ray against a single segment
+/// \param x The x coordinate of the origin of the ray
+/// \param y The y coordinate of the origin of the ray
+/// \param dx The x component of the unit direction of the ray
+/// \param dy The y component of the unit direction of the ray
+/// \param segment The segment
+/// \return The distance to the hit, infinity when the ray misses or runs parallel
+double raycast_segment(double x, double y, double dx, double dy, const Segment & segment);
+
+/// \brief Find the distance from a point to a single segment
+/// \param x The x coordinate of the point
+/// \param y The y coordinate of the point
+/// \param segment The segment
+/// \return The distance to the closest point of the segment
+double distance_segment(double x, double y, const Segment & segment);
+
+/// \brief A bounding volume hierarchy over segments
+class SegmentBVH
+{
+private:
+  /// \brief A node of the hierarchy
+  struct Node
+  {
+    /// \brief The box around the segments of the node
+    double min_x;
+    double min_y;
+    double max_x;
+    double max_y;
+
+    /// \brief The first segment of a leaf, or the right child of an inner node
+    uint32_t index;
+
+    /// \brief The number of segments of a leaf, 0 for an inner node
+    uint32_t count;
+  };
+
+  std::vector<Segment> segments_;
+  std::vector<Node> nodes_;
+  size_t leaf_size_;
+
+  /// \brief Build the node of a range of segments and all nodes below it
+  /// \param begin The first segment
+  /// \param end One past the last segment
+  void build_(size_t begin, size_t end);
+
+public:
+  /// \brief Construct an empty hierarchy
+  SegmentBVH();
+
+  /// \brief Construct the hierarchy of a set of segments
+  /// \param segments The segments
+  /// \param leaf_size The largest number of segments in a leaf
+  explicit SegmentBVH(std::vector<Segment> segments, size_t leaf_size = 4);
+
+  /// \brief Cast a ray against the segments
+  /// \param x The x coordinate of the origin of the ray
+  /// \param y The y coordinate of the origin of the ray
+  /// \param dx The x component of the unit direction of the ray
+  /// \param dy The y component of the unit direction of the ray
+  /// \param max_range The length of the ray
+  /// \return The distance to the first hit, infinity without a hit within max_range
+  double raycast(double x, double y, double dx, double dy, double max_range) const;
+
+  /// \brief Find the distance from a point to the closest segment
+  /// \param x The x coordinate of the point
+  /// \param y The y coordinate of the point
+  /// \param max_distance The largest distance searched
+  /// \return The distance to the closest segment, infinity without a segment within max_distance
+  double distance(double x, double y, double max_distance) const;
+
+  /// \brief Get the segments, in the order of the leaves
+  /// \return The segments
+  const std::vector<Segment> & segments() const;
+
+  /// \brief Get the number of nodes
+  /// \return The number of nodes
+  size_t num_nodes() const;
+};
+
+/// \brief The four walls of a rectangular arena centered at the origin
+/// \param x_length The length of the arena in x direction
+/// \param y_length The length of the arena in y direction
+/// \return The walls, counterclockwise from the east wall
+std::vector<Segment> arena_walls(double x_length, double y_length);
+} // namespace turtlelib
+
+#endif
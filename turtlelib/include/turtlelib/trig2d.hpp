@@ -1,6 +1,9 @@
 #ifndef TRIG2D_HPP_INCLUDE_GUARD
 #define TRIG2D_HPP_INCLUDE_GUARD
 
+#include <cstddef>
+#include <vector>
+
 #include "turtlelib/geometry2d.hpp"
 
 namespace turtlelib
@@ -18,6 +21,19 @@ struct Obstacle
   double r;
 };
 
+/// \brief Cylindrical obstacles stored as one array per field, so rays are cast in batches
+struct Obstacles
+{
+  /// \brief x coordinates of the obstacles
+  std::vector<double> x;
+
+  /// \brief y coordinates of the obstacles
+  std::vector<double> y;
+
+  /// \brief radii of the obstacles
+  std::vector<double> r;
+};
+
 /// \brief compute cross product between two vector
 /// \param v1 first vector
 /// \param v2 second vector
@@ -41,6 +57,20 @@ bool can_intersect(double alpha, Obstacle obs);
 /// \param obs the obstacle
 /// \return double the resulting length
 double find_distance(double alpha, Obstacle obs);
+
+/// \brief cast rays from the origin against all obstacles, keeping the closest hit of every ray
+///
+/// Every ray solves t^2 - 2 t (d . o) + |o|^2 - r^2 = 0 in closed form, one obstacle
+/// at a time over all rays, so the inner loop is branch free and vectorizes. Obstacles
+/// around the origin are not seen, like in can_intersect.
+/// \param dir_x x components of the unit ray directions
+/// \param dir_y y components of the unit ray directions
+/// \param num_rays the number of rays
+/// \param obstacles the obstacles
+/// \param ranges the running minimum distance of every ray, lowered by closer hits
+void cast_rays(
+  const double * dir_x, const double * dir_y, size_t num_rays, const Obstacles & obstacles,
+  double * ranges);
 } // namespace turtlelib
 
 #endif
@@ -0,0 +1,77 @@
+/// \file worker_pool.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A small persistent pool of worker threads.
+/// \version 0.1
+/// \date 2024-03-30
+///
+/// The threads are started once and sleep between jobs, so a parallel loop
+/// costs a wake up instead of a thread creation. The calling thread works on
+/// the loop too and returns once every index is done. Indices are handed out
+/// one at a time from an atomic counter, so workers that finish early take
+/// over the remaining indices.
+///
+/// \copyright Copyright (c) 2024
+#ifndef WORKER_POOL_HPP_INCLUDE_GUARD
+#define WORKER_POOL_HPP_INCLUDE_GUARD
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace turtlelib
+{
+/// \brief A pool of threads running parallel loops
+class WorkerPool
+{
+private:
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+
+  /// The current job, published to the threads by bumping the generation
+  const std::function<void(size_t, size_t)> * job_;
+  size_t count_;
+  std::atomic<size_t> next_;
+  size_t generation_;
+  size_t active_;
+  bool stop_;
+  std::exception_ptr error_;
+
+  /// \brief Run indices of the current job until none are left
+  /// \param worker The index of the running worker
+  void run_(size_t worker);
+
+  /// \brief The loop of a pool thread
+  /// \param worker The index of the thread's worker
+  void loop_(size_t worker);
+
+public:
+  /// \brief Construct a pool
+  /// \param num_threads The number of threads besides the calling thread
+  explicit WorkerPool(size_t num_threads);
+
+  /// \brief Stop and join the threads
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool & operator=(const WorkerPool &) = delete;
+
+  /// \brief Get the number of workers, including the calling thread
+  /// \return The number of workers
+  size_t num_workers() const;
+
+  /// \brief Call a function for every index, spread over the workers
+  /// \param count The number of indices
+  /// \param fn The function, called with the index and the worker index,
+  ///           which is 0 for the calling thread and below num_workers()
+  /// \throw The first exception thrown by fn, after all indices have run
+  void parallel_for(size_t count, const std::function<void(size_t, size_t)> & fn);
+};
+} // namespace turtlelib
+
+#endif
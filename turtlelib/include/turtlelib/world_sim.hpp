@@ -0,0 +1,231 @@
+/// \file world_sim.hpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief The physics and sensor models of the simulator, without ROS.
+/// \version 0.1
+/// \date 2024-04-10
+///
+/// The wheel noise and slip, the collisions, the fake obstacle sensor and the
+/// lidar of nusim. The world geometry is shared and only read, so many
+/// simulations can run at once on different threads. Every noise sample is
+/// keyed by the seed, the tick, the robot and the beam or obstacle index, so
+/// the noise does not depend on the order it is drawn in or on the thread
+/// drawing it.
+///
+/// \copyright Copyright (c) 2024
+#ifndef WORLD_SIM_HPP_INCLUDE_GUARD
+#define WORLD_SIM_HPP_INCLUDE_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "turtlelib/beam_table.hpp"
+#include "turtlelib/counter_rng.hpp"
+#include "turtlelib/distance_field.hpp"
+#include "turtlelib/fleet.hpp"
+#include "turtlelib/geometry2d.hpp"
+#include "turtlelib/obstacle_grid.hpp"
+#include "turtlelib/segment_bvh.hpp"
+
+namespace turtlelib
+{
+/// \brief The robot, noise and sensor parameters of a simulation
+struct SimParams
+{
+  /// \brief The time of one step in seconds
+  double period = 0.01;
+
+  /// \brief The distance between the wheels
+  double track_width = 0.16;
+
+  /// \brief The radius of the wheels
+  double wheel_radius = 0.033;
+
+  /// \brief The wheel velocity in rad/s of one motor command unit
+  double motor_cmd_per_rad_sec = 0.024;
+
+  /// \brief The encoder ticks per radian of wheel rotation
+  double encoder_ticks_per_rad = 651.9;
+
+  /// \brief The radius of the robot when colliding
+  double collision_radius = 0.2;
+
+  /// \brief The variance of the wheel velocity noise
+  double input_noice = 0.0;
+
+  /// \brief The largest fraction of wheel slip
+  double slip_fraction = 0.0;
+
+  /// \brief The variance of the fake obstacle sensor noise
+  double basic_sensor_variance = 0.02;
+
+  /// \brief The range of the fake obstacle sensor
+  double max_range = 2.0;
+
+  /// \brief The minimum range of the lidar
+  double lidar_range_min = 0.12;
+
+  /// \brief The maximum range of the lidar
+  double lidar_range_max = 3.5;
+
+  /// \brief The accuracy of the lidar, six standard deviations of its noise
+  double lidar_accuracy = 0.015;
+
+  /// \brief The angle between two lidar beams
+  double lidar_resolution = 0.02;
+};
+
+/// \brief The static geometry of a world
+struct World
+{
+  /// \brief The cylindrical obstacles
+  ObstacleGrid obstacles;
+
+  /// \brief The line segment walls
+  SegmentBVH walls;
+
+  /// \brief The distance field of the occupancy map
+  DistanceField map;
+};
+
+/// \brief The robot states of a simulation at a tick
+struct SimSnapshot
+{
+  /// \brief The number of steps taken, which keys the noise
+  uint64_t tick = 0;
+
+  /// \brief The states of the robots
+  FleetState fleet;
+};
+
+/// \brief A fleet of differential drive robots simulated in a world
+class WorldSim
+{
+private:
+  SimParams params_;
+  std::shared_ptr<const World> world_;
+  FleetState fleet_;
+  BeamTable beams_;
+  uint64_t seed_;
+  uint64_t tick_;
+
+  /// Scratch arrays of a step, one entry per robot
+  std::vector<double> delta_left_;
+  std::vector<double> delta_right_;
+  std::vector<double> pre_x_;
+  std::vector<double> pre_y_;
+  std::vector<double> input_noice_;
+  std::vector<double> slip_noice_;
+  std::vector<size_t> nearby_;
+  size_t collisions_;
+
+  /// \brief Move a robot back to its previous position if it collided
+  /// \param i The index of the robot
+  void check_collision_(size_t i);
+
+public:
+  /// \brief Construct a simulation of an empty world
+  WorldSim();
+
+  /// \brief Construct a simulation without robots
+  /// \param params The parameters
+  /// \param world The world, shared with other simulations
+  /// \param seed The seed of the noise
+  WorldSim(const SimParams & params, std::shared_ptr<const World> world, uint64_t seed);
+
+  /// \brief Add a robot with its wheels at 0
+  /// \param x The x coordinate of the robot
+  /// \param y The y coordinate of the robot
+  /// \param theta The heading of the robot
+  /// \return The index of the robot
+  size_t add_robot(double x, double y, double theta);
+
+  /// \brief Move a robot to a pose, keeping its wheel angles
+  /// \param i The index of the robot
+  /// \param x The x coordinate of the robot
+  /// \param y The y coordinate of the robot
+  /// \param theta The heading of the robot
+  void place_robot(size_t i, double x, double y, double theta);
+
+  /// \brief Move a robot to a pose and set its wheels to 0
+  /// \param i The index of the robot
+  /// \param x The x coordinate of the robot
+  /// \param y The y coordinate of the robot
+  /// \param theta The heading of the robot
+  void reset_robot(size_t i, double x, double y, double theta);
+
+  /// \brief Drive every robot for one period with wheel noise, slip and collisions
+  ///
+  /// The robots move by the slipping wheels while the encoders count the
+  /// commanded rotation with its noise. The noise of all robots is drawn in
+  /// one bulk fill keyed by the tick, which then advances.
+  /// \param left_cmd The left wheel motor command of every robot
+  /// \param right_cmd The right wheel motor command of every robot
+  void step(const std::vector<double> & left_cmd, const std::vector<double> & right_cmd);
+
+  /// \brief Sense the obstacles within max_range of a robot with the fake sensor
+  ///
+  /// The noise of an obstacle is keyed by its index, so sensing twice in the
+  /// same tick gives the same measurements.
+  /// \param i The index of the robot
+  /// \param positions The noisy world positions of the sensed obstacles
+  /// \param indices The indices of the sensed obstacles in increasing order
+  void sense_obstacles(size_t i, std::vector<Point2D> & positions, std::vector<size_t> & indices);
+
+  /// \brief Cast the lidar of a robot against the obstacles, the walls and the map
+  ///
+  /// Only reads the simulation, so the lidars of different robots can be cast at
+  /// once. The noise of a beam is keyed by its index.
+  /// \param i The index of the robot
+  /// \param ranges The noisy range of every beam, infinity without a hit
+  void scan(size_t i, std::vector<float> & ranges) const;
+
+  /// \brief Copy the robot states and the tick
+  /// \return The snapshot
+  SimSnapshot snapshot() const;
+
+  /// \brief Set the robot states and the tick from a snapshot
+  ///
+  /// A copy of a simulation restored from its snapshots senses exactly like the
+  /// simulation itself, so the sensors can run on another thread than the steps.
+  /// \param snapshot The snapshot
+  void restore(const SimSnapshot & snapshot);
+
+  /// \brief Get the left encoder ticks of a robot
+  /// \param i The index of the robot
+  /// \return The encoder ticks
+  int32_t left_encoder(size_t i) const;
+
+  /// \brief Get the right encoder ticks of a robot
+  /// \param i The index of the robot
+  /// \return The encoder ticks
+  int32_t right_encoder(size_t i) const;
+
+  /// \brief Get the number of times a robot was moved back by a collision
+  /// \return The number of collisions
+  size_t collisions() const;
+
+  /// \brief Get the number of lidar beams
+  /// \return The number of beams
+  size_t num_beams() const;
+
+  /// \brief Get the number of steps taken, which keys the noise
+  /// \return The tick
+  uint64_t tick() const;
+
+  /// \brief Get the states of the robots
+  /// \return The states
+  const FleetState & fleet() const;
+
+  /// \brief Get the parameters
+  /// \return The parameters
+  const SimParams & params() const;
+
+  /// \brief Get the world
+  /// \return The world
+  const World & world() const;
+};
+} // namespace turtlelib
+
+#endif
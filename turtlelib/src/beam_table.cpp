@@ -0,0 +1,123 @@
+/// \file beam_table.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Cached beam directions of a laser scanner.
+/// \version 0.1
+/// \date 2024-03-29
+///
+/// \copyright Copyright (c) 2024
+#include <cmath>
+#include <limits>
+
+#include "turtlelib/beam_table.hpp"
+
+namespace turtlelib
+{
+namespace
+{
+/// \brief Get the float a float range exceeds exactly when it exceeds a bound
+/// \param bound The bound
+/// \return The largest float not above the bound
+float float_below(double bound)
+{
+  if (bound > std::numeric_limits<float>::max()) {
+    return std::numeric_limits<float>::max();
+  } else if (bound < std::numeric_limits<float>::lowest()) {
+    return -std::numeric_limits<float>::infinity();
+  }
+
+  const auto rounded = static_cast<float>(bound);
+  return rounded > bound ? std::nextafter(rounded, -std::numeric_limits<float>::infinity()) :
+         rounded;
+}
+
+/// \brief Get the float a float range is below exactly when it is below a bound
+/// \param bound The bound
+/// \return The smallest float not below the bound
+float float_above(double bound)
+{
+  if (bound > std::numeric_limits<float>::max()) {
+    return std::numeric_limits<float>::infinity();
+  } else if (bound < std::numeric_limits<float>::lowest()) {
+    return std::numeric_limits<float>::lowest();
+  }
+
+  const auto rounded = static_cast<float>(bound);
+  return rounded < bound ? std::nextafter(rounded, std::numeric_limits<float>::infinity()) :
+         rounded;
+}
+} // namespace
+
+BeamTable::BeamTable()
+: angle_min_(0.0), angle_increment_(0.0)
+{
+}
+
+BeamTable::BeamTable(double angle_min, double angle_increment, size_t count)
+: BeamTable()
+{
+  update(angle_min, angle_increment, count);
+}
+
+bool BeamTable::update(double angle_min, double angle_increment, size_t count)
+{
+  /// The geometry comes from the same message fields every scan, so it compares exactly
+  if (angle_min == angle_min_ && angle_increment == angle_increment_ && count == cos_.size()) {
+    return false;
+  }
+
+  angle_min_ = angle_min;
+  angle_increment_ = angle_increment;
+  cos_.resize(count);
+  sin_.resize(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    const auto theta = angle_min + static_cast<double>(i) * angle_increment;
+    cos_[i] = std::cos(theta);
+    sin_[i] = std::sin(theta);
+  }
+
+  return true;
+}
+
+void BeamTable::to_cartesian(
+  const float * ranges, double range_min, double range_max,
+  double * x, double * y, uint8_t * valid) const
+{
+  const auto n = cos_.size();
+  const auto * c = cos_.data();
+  const auto * s = sin_.data();
+
+  /// No branches, so the loops vectorize
+  for (size_t i = 0; i < n; ++i) {
+    const double range = ranges[i];
+
+    x[i] = range * c[i];
+    y[i] = range * s[i];
+  }
+
+  /// Byte flags beside double lanes do not vectorize, so the ranges are
+  /// checked as floats against bounds that give the same result
+  const auto lower = float_below(range_min);
+  const auto upper = float_above(range_max);
+
+  /// NaN ranges fail both compares
+  for (size_t i = 0; i < n; ++i) {
+    valid[i] = static_cast<uint8_t>((ranges[i] > lower) & (ranges[i] < upper));
+  }
+}
+
+size_t BeamTable::size() const
+{
+  return cos_.size();
+}
+
+const std::vector<double> & BeamTable::cos() const
+{
+  return cos_;
+}
+
+const std::vector<double> & BeamTable::sin() const
+{
+  return sin_;
+}
+} // namespace turtlelib
@@ -0,0 +1,110 @@
+/// \file circle_tracker.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Track detected circles from scan to scan.
+/// \version 0.1
+/// \date 2024-03-31
+///
+/// \copyright Copyright (c) 2024
+#include <stdexcept>
+
+#include "turtlelib/circle_tracker.hpp"
+
+namespace turtlelib
+{
+CircleTracker::CircleTracker()
+: CircleTracker(0.02, 3)
+{
+}
+
+CircleTracker::CircleTracker(double gate, size_t max_misses)
+: gate_(gate), max_misses_(max_misses), next_id_(0)
+{
+  if (gate <= 0.0) {
+    throw std::invalid_argument("Invalid circle tracker gate");
+  }
+}
+
+void CircleTracker::predict(const Transform2D & T_curr_prev)
+{
+  for (auto & track : tracks_) {
+    const auto p = T_curr_prev(Point2D{track.circle.x, track.circle.y});
+    track.circle.x = p.x;
+    track.circle.y = p.y;
+  }
+}
+
+int CircleTracker::match(const double * x, const double * y, size_t num) const
+{
+  int best = -1;
+  double best_residual = gate_;
+
+  if (num == 0) {
+    return best;
+  }
+
+  for (size_t i = 0; i < tracks_.size(); ++i) {
+    const auto residual = geometric_residual(x, y, num, tracks_.at(i).circle);
+
+    if (residual <= best_residual) {
+      best = static_cast<int>(i);
+      best_residual = residual;
+    }
+  }
+
+  return best;
+}
+
+std::vector<int> CircleTracker::update(
+  const std::vector<Landmark> & circles,
+  const std::vector<int> & matches)
+{
+  if (circles.size() != matches.size()) {
+    throw std::invalid_argument("Every circle needs a match");
+  }
+
+  std::vector<bool> seen(tracks_.size(), false);
+  std::vector<int> ids(circles.size());
+
+  for (size_t i = 0; i < circles.size(); ++i) {
+    const auto index = matches.at(i);
+
+    /// A track claimed by an earlier circle of the scan starts a new track
+    if (index >= 0 && static_cast<size_t>(index) < tracks_.size() && !seen.at(index)) {
+      seen.at(index) = true;
+      tracks_.at(index).circle = circles.at(i);
+      tracks_.at(index).misses = 0;
+      ids.at(i) = tracks_.at(index).id;
+    } else {
+      tracks_.push_back({next_id_++, circles.at(i), 0});
+      seen.push_back(true);
+      ids.at(i) = tracks_.back().id;
+    }
+  }
+
+  size_t kept = 0;
+
+  for (size_t i = 0; i < tracks_.size(); ++i) {
+    if (!seen.at(i)) {
+      ++tracks_.at(i).misses;
+    }
+
+    if (tracks_.at(i).misses <= max_misses_) {
+      tracks_.at(kept++) = tracks_.at(i);
+    }
+  }
+
+  tracks_.resize(kept);
+
+  return ids;
+}
+
+const std::vector<CircleTrack> & CircleTracker::tracks() const
+{
+  return tracks_;
+}
+
+void CircleTracker::clear()
+{
+  tracks_.clear();
+}
+} // namespace turtlelib
@@ -0,0 +1,164 @@
+/// \file consistency.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Filter consistency statistics (NIS/NEES) for the EKF.
+/// \version 0.1
+/// \date 2024-03-20
+///
+/// \copyright Copyright (c) 2024
+#include <cmath>
+#include <limits>
+
+#include "turtlelib/consistency.hpp"
+
+namespace turtlelib
+{
+double compute_nis(const std::array<double, 2> & dz, const std::array<double, 4> & S)
+{
+  const auto s00 = S.at(0);
+  const auto s01 = 0.5 * (S.at(1) + S.at(2));
+  const auto s11 = S.at(3);
+  const auto det = s00 * s11 - s01 * s01;
+
+  if (std::fabs(det) < std::numeric_limits<double>::min()) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  const auto d0 = dz.at(0);
+  const auto d1 = dz.at(1);
+
+  return (s11 * d0 * d0 - 2.0 * s01 * d0 * d1 + s00 * d1 * d1) / det;
+}
+
+double compute_nees(const std::array<double, 3> & error, const std::array<double, 9> & P)
+{
+  const auto a = P.at(0);
+  const auto b = P.at(1);
+  const auto c = P.at(2);
+  const auto d = P.at(3);
+  const auto e = P.at(4);
+  const auto f = P.at(5);
+  const auto g = P.at(6);
+  const auto h = P.at(7);
+  const auto i = P.at(8);
+
+  /// Adjugate of the 3x3 covariance
+  const auto A = e * i - f * h;
+  const auto B = -(d * i - f * g);
+  const auto C = d * h - e * g;
+  const auto D = -(b * i - c * h);
+  const auto E = a * i - c * g;
+  const auto F = -(a * h - b * g);
+  const auto G = b * f - c * e;
+  const auto H = -(a * f - c * d);
+  const auto I = a * e - b * d;
+
+  const auto det = a * A + b * B + c * C;
+
+  if (std::fabs(det) < std::numeric_limits<double>::min()) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  const auto e0 = error.at(0);
+  const auto e1 = error.at(1);
+  const auto e2 = error.at(2);
+
+  const auto v0 = A * e0 + D * e1 + G * e2;
+  const auto v1 = B * e0 + E * e1 + H * e2;
+  const auto v2 = C * e0 + F * e1 + I * e2;
+
+  return (e0 * v0 + e1 * v1 + e2 * v2) / det;
+}
+
+RollingStats::RollingStats()
+: RollingStats(50, CHI2_95_2DOF)
+{
+}
+
+RollingStats::RollingStats(size_t window, double bound)
+: window_(window == 0 ? 1 : window, 0.0), bound_(bound)
+{
+  reset();
+}
+
+void RollingStats::add(double value)
+{
+  if (size_ == window_.size()) {
+    const auto oldest = window_.at(head_);
+    window_sum_ -= oldest;
+
+    if (oldest > bound_) {
+      --window_above_;
+    }
+  } else {
+    ++size_;
+  }
+
+  window_.at(head_) = value;
+  head_ = (head_ + 1) % window_.size();
+  window_sum_ += value;
+
+  if (value > bound_) {
+    ++window_above_;
+  }
+
+  ++total_count_;
+  total_sum_ += value;
+
+  if (value > max_) {
+    max_ = value;
+  }
+}
+
+void RollingStats::reset()
+{
+  head_ = 0;
+  size_ = 0;
+  window_sum_ = 0.0;
+  window_above_ = 0;
+  total_count_ = 0;
+  total_sum_ = 0.0;
+  max_ = 0.0;
+}
+
+double RollingStats::window_mean() const
+{
+  if (size_ == 0) {
+    return 0.0;
+  }
+
+  return window_sum_ / static_cast<double>(size_);
+}
+
+double RollingStats::fraction_above() const
+{
+  if (size_ == 0) {
+    return 0.0;
+  }
+
+  return static_cast<double>(window_above_) / static_cast<double>(size_);
+}
+
+double RollingStats::total_mean() const
+{
+  if (total_count_ == 0) {
+    return 0.0;
+  }
+
+  return total_sum_ / static_cast<double>(total_count_);
+}
+
+double RollingStats::max() const
+{
+  return max_;
+}
+
+size_t RollingStats::window_count() const
+{
+  return size_;
+}
+
+size_t RollingStats::total_count() const
+{
+  return total_count_;
+}
+} // namespace turtlelib
@@ -0,0 +1,240 @@
+/// \file counter_rng.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Counter based noise generation with Philox4x32-10.
+/// \version 0.1
+/// \date 2024-04-12
+///
+/// \copyright Copyright (c) 2024
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "turtlelib/counter_rng.hpp"
+#include "turtlelib/geometry2d.hpp"
+
+namespace turtlelib
+{
+namespace
+{
+/// The multipliers and key increments of Philox4x32
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr int PHILOX_ROUNDS = 10;
+
+/// The number of blocks generated at once
+constexpr size_t CHUNK_BLOCKS = 64;
+
+/// \brief The lanes of a chunk of consecutive blocks, one array per word
+struct Chunk
+{
+  uint32_t w0[CHUNK_BLOCKS];
+  uint32_t w1[CHUNK_BLOCKS];
+  uint32_t w2[CHUNK_BLOCKS];
+  uint32_t w3[CHUNK_BLOCKS];
+};
+
+/// \brief Generate consecutive blocks of a stream
+///
+/// Each round runs over all blocks before the next one, so the loops work on
+/// whole arrays and vectorize.
+/// \param key The key of the stream
+/// \param first_block The index of the first block
+/// \param count The number of blocks, at most CHUNK_BLOCKS
+/// \param chunk The blocks
+void philox_chunk(const NoiseKey & key, uint64_t first_block, size_t count, Chunk & chunk)
+{
+  const auto stream = key.stream;
+  const auto tick_lo = static_cast<uint32_t>(key.tick);
+  const auto tick_hi = static_cast<uint32_t>(key.tick >> 32);
+
+  for (size_t j = 0; j < count; ++j) {
+    chunk.w0[j] = static_cast<uint32_t>(first_block + j);
+    chunk.w1[j] = stream;
+    chunk.w2[j] = tick_lo;
+    chunk.w3[j] = tick_hi;
+  }
+
+  auto k0 = static_cast<uint32_t>(key.seed);
+  auto k1 = static_cast<uint32_t>(key.seed >> 32);
+
+  for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+    for (size_t j = 0; j < count; ++j) {
+      const auto p0 = static_cast<uint64_t>(PHILOX_M0) * chunk.w0[j];
+      const auto p1 = static_cast<uint64_t>(PHILOX_M1) * chunk.w2[j];
+
+      const auto c0 = static_cast<uint32_t>(p1 >> 32) ^ chunk.w1[j] ^ k0;
+      const auto c2 = static_cast<uint32_t>(p0 >> 32) ^ chunk.w3[j] ^ k1;
+
+      chunk.w1[j] = static_cast<uint32_t>(p1);
+      chunk.w3[j] = static_cast<uint32_t>(p0);
+      chunk.w0[j] = c0;
+      chunk.w2[j] = c2;
+    }
+
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+}
+
+/// \brief Map a random word to (0, 1)
+/// \param word The word
+/// \return The uniform sample
+inline double to_uniform(uint32_t word)
+{
+  return (static_cast<double>(word) + 0.5) * (1.0 / 4294967296.0);
+}
+
+/// \brief 2^52 + 2^51, adding and subtracting it rounds a double to the nearest integer
+constexpr double ROUNDING = 6755399441055744.0;
+
+/// \brief The natural logarithm of a positive normal number
+///
+/// Splits off the exponent and sums the atanh series of the mantissa. It has
+/// no branches and no integer conversions, so loops calling it vectorize.
+/// Accurate to about 1e-15.
+/// \param x The number
+/// \return The logarithm
+inline double log_positive(double x)
+{
+  uint64_t bits;
+  std::memcpy(&bits, &x, sizeof(bits));
+
+  /// The biased exponent as the low bits of 2^52
+  auto exponent_bits = (bits >> 52) | 0x4330000000000000ull;
+  double exponent;
+  std::memcpy(&exponent, &exponent_bits, sizeof(exponent));
+  exponent -= 4503599627370496.0 + 1023.0;
+
+  bits = (bits & 0x000FFFFFFFFFFFFFull) | 0x3FF0000000000000ull;
+  double mantissa;
+  std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+  /// Keep the mantissa in [sqrt(0.5), sqrt(2)) for a short series
+  const auto high = mantissa > 1.4142135623730951;
+  mantissa = high ? 0.5 * mantissa : mantissa;
+  exponent = high ? exponent + 1.0 : exponent;
+
+  const auto s = (mantissa - 1.0) / (mantissa + 1.0);
+  const auto s2 = s * s;
+  const auto series =
+    1.0 + s2 *
+    (1.0 / 3.0 + s2 *
+    (1.0 / 5.0 + s2 *
+    (1.0 / 7.0 + s2 *
+    (1.0 / 9.0 + s2 *
+    (1.0 / 11.0 + s2 *
+    (1.0 / 13.0 + s2 *
+    (1.0 / 15.0 + s2 * (1.0 / 17.0))))))));
+
+  return exponent * 0.6931471805599453 + 2.0 * s * series;
+}
+
+/// \brief The sine and cosine of a fraction of a full turn
+///
+/// Reduces to the nearest quarter turn and sums the Taylor series. It has no
+/// branches and no integer conversions, so loops calling it vectorize.
+/// Accurate to about 1e-15.
+/// \param turn The angle in turns, in [0, 1]
+/// \param sine The sine
+/// \param cosine The cosine
+inline void sincos_turn(double turn, double & sine, double & cosine)
+{
+  const auto quarter = (4.0 * turn + ROUNDING) - ROUNDING;
+  const auto a = (4.0 * turn - quarter) * (0.5 * PI);
+  const auto a2 = a * a;
+
+  const auto s = a * (1.0 - a2 / 6.0 * (1.0 - a2 / 20.0 * (1.0 - a2 / 42.0 * (1.0 - a2 / 72.0 *
+    (1.0 - a2 / 110.0 * (1.0 - a2 / 156.0 * (1.0 - a2 / 210.0)))))));
+  const auto c = 1.0 - a2 / 2.0 * (1.0 - a2 / 12.0 * (1.0 - a2 / 30.0 * (1.0 - a2 / 56.0 *
+    (1.0 - a2 / 90.0 * (1.0 - a2 / 132.0 * (1.0 - a2 / 182.0))))));
+
+  /// Rotate by the quarter turns, from 0 to 4, the sine flips at 2 and 3, the cosine at 1 and 2
+  const auto odd = std::abs(std::abs(quarter - 2.0) - 1.0) < 0.5;
+  const auto sine_sign = std::abs(quarter - 2.5) < 1.0 ? -1.0 : 1.0;
+  const auto cosine_sign = std::abs(quarter - 1.5) < 1.0 ? -1.0 : 1.0;
+
+  sine = sine_sign * (odd ? c : s);
+  cosine = cosine_sign * (odd ? s : c);
+}
+
+/// \brief Fill samples of a stream from the lanes of its blocks
+/// \param key The key of the stream
+/// \param first The index of the first sample
+/// \param count The number of samples
+/// \param out The samples
+/// \param convert Turns the four uniform lanes of a block into four samples in place
+template<class F>
+void fill_samples(const NoiseKey & key, uint64_t first, size_t count, double * out, F convert)
+{
+  Chunk chunk;
+  double lanes[4 * CHUNK_BLOCKS];
+
+  size_t done = 0;
+
+  while (done < count) {
+    const auto index = first + done;
+    const auto first_block = index / 4;
+    const auto skip = static_cast<size_t>(index % 4);
+    const auto blocks = std::min(CHUNK_BLOCKS, (skip + count - done + 3) / 4);
+
+    philox_chunk(key, first_block, blocks, chunk);
+
+    for (size_t j = 0; j < blocks; ++j) {
+      lanes[4 * j] = to_uniform(chunk.w0[j]);
+      lanes[4 * j + 1] = to_uniform(chunk.w1[j]);
+      lanes[4 * j + 2] = to_uniform(chunk.w2[j]);
+      lanes[4 * j + 3] = to_uniform(chunk.w3[j]);
+    }
+
+    convert(lanes, blocks);
+
+    const auto take = std::min(4 * blocks - skip, count - done);
+    std::copy(lanes + skip, lanes + skip + take, out + done);
+    done += take;
+  }
+}
+} // namespace
+
+PhiloxBlock philox4x32(const PhiloxBlock & counter, const std::array<uint32_t, 2> & key)
+{
+  auto block = counter;
+  auto k0 = key[0];
+  auto k1 = key[1];
+
+  for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+    const auto p0 = static_cast<uint64_t>(PHILOX_M0) * block[0];
+    const auto p1 = static_cast<uint64_t>(PHILOX_M1) * block[2];
+
+    block = {
+      static_cast<uint32_t>(p1 >> 32) ^ block[1] ^ k0, static_cast<uint32_t>(p1),
+      static_cast<uint32_t>(p0 >> 32) ^ block[3] ^ k1, static_cast<uint32_t>(p0)};
+
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+
+  return block;
+}
+
+void fill_uniform(const NoiseKey & key, uint64_t first, size_t count, double * out)
+{
+  fill_samples(key, first, count, out, [](double *, size_t) {});
+}
+
+void fill_normal(const NoiseKey & key, uint64_t first, size_t count, double * out)
+{
+  fill_samples(
+    key, first, count, out, [](double * lanes, size_t blocks) {
+      /// Every pair of lanes gives two independent samples
+      for (size_t j = 0; j < 2 * blocks; ++j) {
+        const auto r = std::sqrt(-2.0 * log_positive(lanes[2 * j]));
+        double sine, cosine;
+        sincos_turn(lanes[2 * j + 1], sine, cosine);
+        lanes[2 * j] = r * cosine;
+        lanes[2 * j + 1] = r * sine;
+      }
+    });
+}
+} // namespace turtlelib
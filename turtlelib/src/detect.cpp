@@ -5,12 +5,517 @@
 /// \date 2024-03-17
 ///
 /// \copyright Copyright (c) 2024
+#include <algorithm>
 #include <armadillo>
 #include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
 #include "turtlelib/detect.hpp"
 
 namespace turtlelib
 {
+namespace
+{
+/// \brief The Hyper fit over any point storage
+/// \param num The number of points
+/// \param point_at The accessor of the i-th point
+/// \return The fitted circle
+template<typename PointAt>
+Landmark hyper_fit(size_t num, PointAt point_at)
+{
+  if (num < 3) {
+    throw std::invalid_argument("At least 3 points are needed to fit a circle");
+  }
+
+  /// Raw moments up to the fourth order, relative to the first point
+  const auto first = point_at(0);
+  const auto px = first.x;
+  const auto py = first.y;
+
+  double su = 0.0, sv = 0.0;
+  double suu = 0.0, suv = 0.0, svv = 0.0;
+  double suuu = 0.0, suuv = 0.0, suvv = 0.0, svvv = 0.0;
+  double suuuu = 0.0, suuvv = 0.0, svvvv = 0.0;
+
+  for (size_t i = 0; i < num; ++i) {
+    const auto point = point_at(i);
+    const auto u = point.x - px;
+    const auto v = point.y - py;
+    const auto uu = u * u;
+    const auto vv = v * v;
+
+    su += u;
+    sv += v;
+    suu += uu;
+    suv += u * v;
+    svv += vv;
+    suuu += uu * u;
+    suuv += uu * v;
+    suvv += u * vv;
+    svvv += vv * v;
+    suuuu += uu * uu;
+    suuvv += uu * vv;
+    svvvv += vv * vv;
+  }
+
+  const auto n = static_cast<double>(num);
+  const auto a = su / n;
+  const auto b = sv / n;
+  const auto Euu = suu / n;
+  const auto Euv = suv / n;
+  const auto Evv = svv / n;
+  const auto Euuu = suuu / n;
+  const auto Euuv = suuv / n;
+  const auto Euvv = suvv / n;
+  const auto Evvv = svvv / n;
+
+  /// Central moments of x, y and z = x^2 + y^2
+  const auto Mxx = Euu - a * a;
+  const auto Myy = Evv - b * b;
+  const auto Mxy = Euv - a * b;
+  const auto Mxz =
+    (Euuu - 3.0 * a * Euu + 2.0 * a * a * a) +
+    (Euvv - 2.0 * b * Euv - a * Evv + 2.0 * a * b * b);
+  const auto Myz =
+    (Evvv - 3.0 * b * Evv + 2.0 * b * b * b) +
+    (Euuv - 2.0 * a * Euv - b * Euu + 2.0 * a * a * b);
+  const auto Mxxxx = suuuu / n - 4.0 * a * Euuu + 6.0 * a * a * Euu - 3.0 * a * a * a * a;
+  const auto Myyyy = svvvv / n - 4.0 * b * Evvv + 6.0 * b * b * Evv - 3.0 * b * b * b * b;
+  const auto Mxxyy =
+    suuvv / n - 2.0 * b * Euuv - 2.0 * a * Euvv + b * b * Euu + a * a * Evv +
+    4.0 * a * b * Euv - 3.0 * a * a * b * b;
+  const auto Mzz = Mxxxx + 2.0 * Mxxyy + Myyyy;
+
+  /// Coefficients of the characteristic polynomial of the Hyper fit
+  const auto Mz = Mxx + Myy;
+  const auto Cov_xy = Mxx * Myy - Mxy * Mxy;
+  const auto Var_z = Mzz - Mz * Mz;
+
+  const auto A2 = 4.0 * Cov_xy - 3.0 * Mz * Mz - Mzz;
+  const auto A1 = Var_z * Mz + 4.0 * Cov_xy * Mz - Mxz * Mxz - Myz * Myz;
+  const auto A0 =
+    Mxz * (Mxz * Myy - Myz * Mxy) + Myz * (Myz * Mxx - Mxz * Mxy) - Var_z * Cov_xy;
+
+  /// Newton's method from zero converges to the smallest non-negative root
+  double x = 0.0;
+  double y = A0;
+
+  for (int i = 0; i < 99; ++i) {
+    const auto dy = A1 + x * (2.0 * A2 + 16.0 * x * x);
+    const auto x_new = x - y / dy;
+
+    if (x_new == x || !std::isfinite(x_new)) {
+      break;
+    }
+
+    const auto y_new = A0 + x_new * (A1 + x_new * (A2 + 4.0 * x_new * x_new));
+
+    if (std::fabs(y_new) >= std::fabs(y)) {
+      break;
+    }
+
+    x = x_new;
+    y = y_new;
+  }
+
+  const auto det = x * x - x * Mz + Cov_xy;
+
+  if (std::fabs(det) < std::numeric_limits<double>::min()) {
+    return {px + a, py + b, std::numeric_limits<double>::infinity()};
+  }
+
+  const auto x_center = (Mxz * (Myy - x) - Myz * Mxy) / det / 2.0;
+  const auto y_center = (Myz * (Mxx - x) - Mxz * Mxy) / det / 2.0;
+  const auto R = std::sqrt(x_center * x_center + y_center * y_center + Mz - 2.0 * x);
+
+  return {x_center + px + a, y_center + py + b, R};
+}
+
+/// \brief Compute the circle through three points
+/// \param x1 The x coordinate of the first point
+/// \param y1 The y coordinate of the first point
+/// \param x2 The x coordinate of the second point
+/// \param y2 The y coordinate of the second point
+/// \param x3 The x coordinate of the third point
+/// \param y3 The y coordinate of the third point
+/// \param circle The circle through the points
+/// \return False if the points are collinear
+bool circle_through(
+  double x1, double y1, double x2, double y2, double x3, double y3,
+  Landmark & circle)
+{
+  /// Relative to the first point, the center solves a 2x2 linear system
+  const auto bx = x2 - x1;
+  const auto by = y2 - y1;
+  const auto cx = x3 - x1;
+  const auto cy = y3 - y1;
+  const auto d = 2.0 * (bx * cy - by * cx);
+
+  if (std::fabs(d) < 1e-12) {
+    return false;
+  }
+
+  const auto b2 = bx * bx + by * by;
+  const auto c2 = cx * cx + cy * cy;
+  const auto ux = (cy * b2 - by * c2) / d;
+  const auto uy = (bx * c2 - cx * b2) / d;
+
+  circle = {x1 + ux, y1 + uy, std::sqrt(ux * ux + uy * uy)};
+  return true;
+}
+} // namespace
+
+Landmark fit_circle(const std::vector<Point2D> & points)
+{
+  return hyper_fit(points.size(), [&points](size_t i) {return points[i];});
+}
+
+Landmark fit_circle(const double * x, const double * y, size_t num)
+{
+  return hyper_fit(num, [x, y](size_t i) {return Point2D{x[i], y[i]};});
+}
+
+Landmark refine_circle(
+  const double * x, const double * y, size_t num, const Landmark & guess,
+  size_t iterations)
+{
+  if (num < 3) {
+    throw std::invalid_argument("At least 3 points are needed to fit a circle");
+  }
+
+  Landmark circle = guess;
+
+  for (size_t k = 0; k < iterations; ++k) {
+    /// Normal equations J^T J delta = -J^T r of the residuals r = |p - c| - R
+    double jaa = 0.0, jab = 0.0, jar = 0.0, jbb = 0.0, jbr = 0.0;
+    double ga = 0.0, gb = 0.0, gr = 0.0;
+
+    for (size_t i = 0; i < num; ++i) {
+      const auto dx = x[i] - circle.x;
+      const auto dy = y[i] - circle.y;
+      const auto d = std::sqrt(dx * dx + dy * dy);
+
+      if (d < std::numeric_limits<double>::epsilon()) {
+        continue;
+      }
+
+      const auto ja = -dx / d;
+      const auto jb = -dy / d;
+      const auto r = d - circle.r;
+
+      jaa += ja * ja;
+      jab += ja * jb;
+      jar -= ja;
+      jbb += jb * jb;
+      jbr -= jb;
+      ga += ja * r;
+      gb += jb * r;
+      gr -= r;
+    }
+
+    const auto jrr = static_cast<double>(num);
+
+    /// Solve the symmetric 3x3 system by its adjugate
+    const auto c00 = jbb * jrr - jbr * jbr;
+    const auto c01 = jar * jbr - jab * jrr;
+    const auto c02 = jab * jbr - jar * jbb;
+    const auto det = jaa * c00 + jab * c01 + jar * c02;
+
+    if (std::fabs(det) < 1e-12) {
+      break;
+    }
+
+    const auto c11 = jaa * jrr - jar * jar;
+    const auto c12 = jab * jar - jaa * jbr;
+    const auto c22 = jaa * jbb - jab * jab;
+
+    const auto da = -(c00 * ga + c01 * gb + c02 * gr) / det;
+    const auto db = -(c01 * ga + c11 * gb + c12 * gr) / det;
+    const auto dr = -(c02 * ga + c12 * gb + c22 * gr) / det;
+
+    circle.x += da;
+    circle.y += db;
+    circle.r += dr;
+
+    if (da * da + db * db + dr * dr < 1e-20) {
+      break;
+    }
+  }
+
+  return circle;
+}
+
+double geometric_residual(const double * x, const double * y, size_t num, const Landmark & circle)
+{
+  if (num == 0) {
+    throw std::invalid_argument("At least 1 point is needed for a residual");
+  }
+
+  double sum = 0.0;
+
+  for (size_t i = 0; i < num; ++i) {
+    const auto dx = x[i] - circle.x;
+    const auto dy = y[i] - circle.y;
+    const auto r = std::sqrt(dx * dx + dy * dy) - circle.r;
+    sum += r * r;
+  }
+
+  return std::sqrt(sum / static_cast<double>(num));
+}
+
+FitQuality fit_quality(const double * x, const double * y, size_t num, const Landmark & circle)
+{
+  if (num == 0) {
+    throw std::invalid_argument("At least 1 point is needed for a fit quality");
+  }
+
+  double sum = 0.0;
+  double span = 0.0;
+  double previous = 0.0;
+
+  for (size_t i = 0; i < num; ++i) {
+    const auto dx = x[i] - circle.x;
+    const auto dy = y[i] - circle.y;
+    const auto r = std::sqrt(dx * dx + dy * dy) - circle.r;
+    const auto phi = std::atan2(dy, dx);
+
+    sum += r * r;
+
+    /// Summing the steps between neighbours also covers arcs over half a turn
+    if (i > 0) {
+      span += normalize_angle(phi - previous);
+    }
+
+    previous = phi;
+  }
+
+  return {std::sqrt(sum / static_cast<double>(num)), num, std::fabs(span)};
+}
+
+FitQualityGate::FitQualityGate()
+: FitQualityGate(0.02, 4, 0.3, 0.01, PI / 2.0)
+{
+}
+
+FitQualityGate::FitQualityGate(
+  double max_residual, size_t min_points, double min_span, double reference_residual,
+  double reference_span)
+: max_residual_(max_residual), min_points_(min_points), min_span_(min_span),
+  reference_residual_(reference_residual), reference_span_(reference_span)
+{
+  if (max_residual <= 0.0 || reference_residual <= 0.0 || reference_span <= 0.0) {
+    throw std::invalid_argument("Invalid fit quality gate configuration");
+  }
+}
+
+bool FitQualityGate::accept(const FitQuality & quality) const
+{
+  if (quality.num_points == 0) {
+    return true;
+  }
+
+  return quality.residual <= max_residual_ && quality.num_points >= min_points_ &&
+         quality.angular_span >= min_span_;
+}
+
+double FitQualityGate::noise_scale(const FitQuality & quality) const
+{
+  if (quality.num_points == 0) {
+    return 1.0;
+  }
+
+  const auto residual = std::max(1.0, quality.residual / reference_residual_);
+  const auto span = std::max(1.0, reference_span_ / std::max(quality.angular_span, 1e-6));
+
+  return residual * residual * span * span;
+}
+
+RansacCircleFit::RansacCircleFit()
+: RansacCircleFit(0.01, 100, 0.99)
+{
+}
+
+RansacCircleFit::RansacCircleFit(
+  double inlier_threshold, size_t max_iterations,
+  double confidence)
+: inlier_threshold_(inlier_threshold), max_iterations_(max_iterations), confidence_(confidence)
+{
+  if (inlier_threshold <= 0.0 || max_iterations == 0 || confidence <= 0.0 || confidence >= 1.0) {
+    throw std::invalid_argument("Invalid RANSAC circle fit configuration");
+  }
+}
+
+Landmark RansacCircleFit::fit(const double * x, const double * y, size_t num, uint32_t seed)
+{
+  if (num < 3) {
+    throw std::invalid_argument("At least 3 points are needed to fit a circle");
+  }
+
+  std::minstd_rand generator(seed);
+  std::uniform_int_distribution<size_t> sample(0, num - 1);
+
+  Landmark best{0.0, 0.0, 0.0};
+  size_t best_inliers = 0;
+  size_t iterations = max_iterations_;
+
+  for (size_t k = 0; k < iterations; ++k) {
+    const auto i = sample(generator);
+    auto j = sample(generator);
+    auto l = sample(generator);
+
+    Landmark circle;
+    if (i == j || j == l || i == l ||
+      !circle_through(x[i], y[i], x[j], y[j], x[l], y[l], circle))
+    {
+      continue;
+    }
+
+    size_t inliers = 0;
+    for (size_t m = 0; m < num; ++m) {
+      const auto dx = x[m] - circle.x;
+      const auto dy = y[m] - circle.y;
+      inliers += std::fabs(std::sqrt(dx * dx + dy * dy) - circle.r) <= inlier_threshold_;
+    }
+
+    if (inliers <= best_inliers) {
+      continue;
+    }
+
+    best = circle;
+    best_inliers = inliers;
+
+    if (best_inliers == num) {
+      break;
+    }
+
+    /// Iterations to draw three inliers at least once with the requested confidence
+    const auto w = static_cast<double>(best_inliers) / static_cast<double>(num);
+    const auto needed = std::ceil(std::log(1.0 - confidence_) / std::log(1.0 - w * w * w));
+    if (needed < static_cast<double>(iterations)) {
+      iterations = static_cast<size_t>(needed);
+    }
+  }
+
+  inlier_x_.clear();
+  inlier_y_.clear();
+
+  for (size_t m = 0; m < num; ++m) {
+    const auto dx = x[m] - best.x;
+    const auto dy = y[m] - best.y;
+
+    if (best_inliers == 0 ||
+      std::fabs(std::sqrt(dx * dx + dy * dy) - best.r) <= inlier_threshold_)
+    {
+      inlier_x_.push_back(x[m]);
+      inlier_y_.push_back(y[m]);
+    }
+  }
+
+  return fit_circle(inlier_x_.data(), inlier_y_.data(), inlier_x_.size());
+}
+
+const std::vector<double> & RansacCircleFit::inlier_x() const
+{
+  return inlier_x_;
+}
+
+const std::vector<double> & RansacCircleFit::inlier_y() const
+{
+  return inlier_y_;
+}
+
+InscribedAngles inscribed_angles(const double * x, const double * y, size_t num)
+{
+  if (num < 3) {
+    throw std::invalid_argument("At least 3 points are needed for inscribed angles");
+  }
+
+  const auto x_first = x[0];
+  const auto y_first = y[0];
+  const auto x_last = x[num - 1];
+  const auto y_last = y[num - 1];
+
+  /// Welford's running mean and variance
+  double mean = 0.0;
+  double m2 = 0.0;
+
+  for (size_t i = 1; i + 1 < num; ++i) {
+    const auto ax = x_first - x[i];
+    const auto ay = y_first - y[i];
+    const auto bx = x_last - x[i];
+    const auto by = y_last - y[i];
+    const auto angle = std::atan2(std::fabs(ax * by - ay * bx), ax * bx + ay * by);
+
+    const auto delta = angle - mean;
+    mean += delta / static_cast<double>(i);
+    m2 += delta * (angle - mean);
+  }
+
+  return {mean, std::sqrt(m2 / static_cast<double>(num - 2))};
+}
+
+CircleClassifier::CircleClassifier()
+: CircleClassifier(deg2rad(90.0), deg2rad(135.0), 0.15, 0.01, 0.1)
+{
+}
+
+CircleClassifier::CircleClassifier(
+  double min_mean, double max_mean, double max_stddev, double min_radius,
+  double max_radius)
+: min_mean_(min_mean), max_mean_(max_mean), max_stddev_(max_stddev), min_radius_(min_radius),
+  max_radius_(max_radius)
+{
+  if (min_mean >= max_mean || max_stddev <= 0.0 || min_radius < 0.0 || min_radius >= max_radius) {
+    throw std::invalid_argument("Invalid circle classifier configuration");
+  }
+}
+
+bool CircleClassifier::is_arc(const InscribedAngles & angles) const
+{
+  return angles.mean >= min_mean_ && angles.mean <= max_mean_ && angles.stddev <= max_stddev_;
+}
+
+bool CircleClassifier::in_radius_gate(const Landmark & circle) const
+{
+  return circle.r >= min_radius_ && circle.r <= max_radius_;
+}
+
+ClusterFit CircleClassifier::fit(const double * x, const double * y, size_t num) const
+{
+  ClusterFit result{{0.0, 0.0, 0.0}, {0.0, 0, 0.0}, inscribed_angles(x, y, num), false};
+
+  if (!is_arc(result.angles)) {
+    return result;
+  }
+
+  result.circle = fit_circle(x, y, num);
+  result.quality = fit_quality(x, y, num, result.circle);
+  result.is_circle = in_radius_gate(result.circle);
+
+  return result;
+}
+
+ClusterFit CircleClassifier::fit(
+  const double * x, const double * y, size_t num, RansacCircleFit & ransac,
+  uint32_t seed) const
+{
+  ClusterFit result{ransac.fit(x, y, num, seed), {0.0, 0, 0.0}, {0.0, 0.0}, false};
+
+  const auto & inlier_x = ransac.inlier_x();
+  const auto & inlier_y = ransac.inlier_y();
+
+  if (inlier_x.size() < 3) {
+    return result;
+  }
+
+  result.quality = fit_quality(inlier_x.data(), inlier_y.data(), inlier_x.size(), result.circle);
+  result.angles = inscribed_angles(inlier_x.data(), inlier_y.data(), inlier_x.size());
+  result.is_circle = is_arc(result.angles) && in_radius_gate(result.circle);
+
+  return result;
+}
+
 CircleDetect::CircleDetect()
 {
   CircleDetect(0);
@@ -123,58 +628,21 @@ arma::mat CircleDetect::construct_H_mat(const double z_mean)
 
 Landmark CircleDetect::detect_circle()
 {
-  const auto x_hat = compute_x_mean();
-  const auto y_hat = compute_y_mean();
-
-  shift_coordinate(x_hat, y_hat);
-  const auto z_bar = compute_z_mean();
-
-  const arma::mat Z_mat = construct_Z_mat();
-  const arma::mat M_mat = compute_M_mat(Z_mat);
-  const arma::mat H_mat = construct_H_mat(z_bar);
-  const arma::mat H_inv = H_mat.i();
-
-  arma::mat U_mat;
-  arma::vec sigma_vec;
-  arma::mat V_mat;
-  arma::svd(U_mat, sigma_vec, V_mat, Z_mat);
-
-  const arma::mat Sigma_mat = arma::diagmat(sigma_vec);
-  const double sigma_min = sigma_vec.min();
-
-  arma::vec A_vec;
-
-  if (sigma_min < 1e-12) {
-    A_vec = V_mat.col(3);
-  } else {
-    const arma::mat Y_mat = V_mat * Sigma_mat * V_mat.t();
-    const arma::mat Q_mat = Y_mat * H_inv * Y_mat;
-
-    arma::vec eig_val;
-    arma::mat eig_vec;
-    arma::eig_sym(eig_val, eig_vec, Q_mat);
-    // std::cout << "-------- HERE -------" << std::endl;
+  return fit_circle(data_points_);
+}
 
-    const auto eig_min_ind = eig_val.index_min();
-    const arma::vec A_star_vec = eig_vec.col(eig_min_ind);
+FitQuality CircleDetect::quality(const Landmark & circle) const
+{
+  std::vector<double> x, y;
+  x.reserve(data_points_.size());
+  y.reserve(data_points_.size());
 
-    A_vec = arma::solve(Y_mat, A_star_vec);
+  for (const auto & p : data_points_) {
+    x.push_back(p.x);
+    y.push_back(p.y);
   }
 
-  const auto A1 = A_vec(0);
-  const auto A2 = A_vec(1);
-  const auto A3 = A_vec(2);
-  const auto A4 = A_vec(3);
-
-  const auto a = -A2 / (2.0 * A1);
-  const auto b = -A3 / (2.0 * A1);
-  const auto R2 = (pow(A2, 2.0) + pow(A3, 2.0) - 4.0 * A1 * A4) / (4.0 * pow(A1, 2.0));
-
-  const auto x_center = a + x_hat;
-  const auto y_center = b + y_hat;
-  const auto R_center = sqrt(R2);
-
-  return {x_center, y_center, R_center};
+  return fit_quality(x.data(), y.data(), x.size(), circle);
 }
 
 std::vector<Point2D> & CircleDetect::get_data_points()
@@ -0,0 +1,257 @@
+/// \file distance_field.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A Euclidean distance field over the occupied cells of a map.
+/// \version 0.1
+/// \date 2024-04-06
+///
+/// \copyright Copyright (c) 2024
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "turtlelib/distance_field.hpp"
+
+namespace turtlelib
+{
+namespace
+{
+/// \brief The squared distance standing for no occupied sample, finite to keep the parabolas finite
+constexpr double FAR = 1e20;
+} // namespace
+
+void distance_transform_1d(const std::vector<double> & f, std::vector<double> & d)
+{
+  const auto n = f.size();
+  d.resize(n);
+
+  if (n == 0) {
+    return;
+  }
+
+  /// The lower envelope of the parabolas rooted at every sample: v holds their roots
+  /// and z the boundaries between them
+  std::vector<size_t> v(n);
+  std::vector<double> z(n + 1);
+  size_t k = 0;
+  v[0] = 0;
+  z[0] = -std::numeric_limits<double>::infinity();
+  z[1] = std::numeric_limits<double>::infinity();
+
+  for (size_t q = 1; q < n; ++q) {
+    const auto fq = f[q] + static_cast<double>(q * q);
+    const auto intersect = [&f, fq, q](size_t p) {
+        return (fq - (f[p] + static_cast<double>(p * p))) / (2.0 * static_cast<double>(q - p));
+      };
+
+    /// Drop the parabolas hidden by the new one, z[0] stops the search at the first
+    auto s = intersect(v[k]);
+    while (s <= z[k]) {
+      --k;
+      s = intersect(v[k]);
+    }
+
+    ++k;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = std::numeric_limits<double>::infinity();
+  }
+
+  k = 0;
+  for (size_t q = 0; q < n; ++q) {
+    while (z[k + 1] < static_cast<double>(q)) {
+      ++k;
+    }
+
+    const auto offset = static_cast<double>(q) - static_cast<double>(v[k]);
+    d[q] = offset * offset + f[v[k]];
+  }
+}
+
+DistanceField::DistanceField()
+: width_(0), height_(0), resolution_(1.0), origin_x_(0.0), origin_y_(0.0)
+{
+}
+
+DistanceField::DistanceField(const OccupancyMap & map)
+: width_(map.width), height_(map.height), resolution_(map.resolution),
+  origin_x_(map.origin_x), origin_y_(map.origin_y)
+{
+  if (map.data.size() != width_ * height_) {
+    throw std::invalid_argument("The map data does not match its size");
+  }
+
+  if (resolution_ <= 0.0) {
+    throw std::invalid_argument("Invalid map resolution");
+  }
+
+  std::vector<double> squared(width_ * height_);
+  for (size_t i = 0; i < squared.size(); ++i) {
+    squared[i] = map.data[i] == CELL_OCCUPIED ? 0.0 : FAR;
+  }
+
+  /// The transform is separable: first along every column, then along every row
+  std::vector<double> line, transformed;
+
+  line.resize(height_);
+  for (size_t col = 0; col < width_; ++col) {
+    for (size_t row = 0; row < height_; ++row) {
+      line[row] = squared[row * width_ + col];
+    }
+
+    distance_transform_1d(line, transformed);
+
+    for (size_t row = 0; row < height_; ++row) {
+      squared[row * width_ + col] = transformed[row];
+    }
+  }
+
+  line.resize(width_);
+  distance_.resize(width_ * height_);
+  for (size_t row = 0; row < height_; ++row) {
+    std::copy_n(squared.begin() + row * width_, width_, line.begin());
+    distance_transform_1d(line, transformed);
+
+    for (size_t col = 0; col < width_; ++col) {
+      distance_[row * width_ + col] = transformed[col] >= 0.1 * FAR ?
+        std::numeric_limits<float>::infinity() :
+        static_cast<float>(std::sqrt(transformed[col]) * resolution_);
+    }
+  }
+}
+
+double DistanceField::distance(double x, double y) const
+{
+  const auto col = std::floor((x - origin_x_) / resolution_);
+  const auto row = std::floor((y - origin_y_) / resolution_);
+
+  if (
+    !(col >= 0.0 && row >= 0.0 && col < static_cast<double>(width_) &&
+    row < static_cast<double>(height_)))
+  {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  return distance_[static_cast<size_t>(row) * width_ + static_cast<size_t>(col)];
+}
+
+double DistanceField::raycast(double x, double y, double dx, double dy, double max_range) const
+{
+  const auto miss = std::numeric_limits<double>::infinity();
+
+  if (distance_.empty()) {
+    return miss;
+  }
+
+  /// Clip the ray to the bounds of the map
+  auto t_enter = 0.0;
+  auto t_leave = max_range;
+
+  const double origin[2] = {x, y};
+  const double direction[2] = {dx, dy};
+  const double lower[2] = {origin_x_, origin_y_};
+  const double upper[2] = {
+    origin_x_ + static_cast<double>(width_) * resolution_,
+    origin_y_ + static_cast<double>(height_) * resolution_};
+
+  for (int axis = 0; axis < 2; ++axis) {
+    if (direction[axis] == 0.0) {
+      if (origin[axis] < lower[axis] || origin[axis] > upper[axis]) {
+        return miss;
+      }
+      continue;
+    }
+
+    auto t0 = (lower[axis] - origin[axis]) / direction[axis];
+    auto t1 = (upper[axis] - origin[axis]) / direction[axis];
+
+    if (t0 > t1) {
+      std::swap(t0, t1);
+    }
+
+    t_enter = std::max(t_enter, t0);
+    t_leave = std::min(t_leave, t1);
+  }
+
+  /// A point is at least the distance between the cell centers minus half the diagonals
+  /// of both cells away from the occupied cell
+  const auto diagonal = std::sqrt(2.0) * resolution_;
+  const auto inv_resolution = 1.0 / resolution_;
+  const auto inv_dx = 1.0 / dx;
+  const auto inv_dy = 1.0 / dy;
+  const auto step_col = dx > 0.0 ? 1 : -1;
+  const auto step_row = dy > 0.0 ? 1 : -1;
+  const auto delta_col = std::fabs(resolution_ * inv_dx);
+  const auto delta_row = std::fabs(resolution_ * inv_dy);
+
+  auto t = t_enter;
+  long col = 0;
+  long row = 0;
+  auto next_col = miss;
+  auto next_row = miss;
+
+  /// Find the cell of the ray at t and the distances to its next column and row
+  const auto locate = [&]() {
+      const auto px = x + dx * t;
+      const auto py = y + dy * t;
+      col = static_cast<long>(std::clamp(
+          std::floor((px - origin_x_) * inv_resolution), 0.0, static_cast<double>(width_ - 1)));
+      row = static_cast<long>(std::clamp(
+          std::floor((py - origin_y_) * inv_resolution), 0.0, static_cast<double>(height_ - 1)));
+      next_col = dx != 0.0 ?
+        (origin_x_ + static_cast<double>(col + (dx > 0.0)) * resolution_ - x) * inv_dx : miss;
+      next_row = dy != 0.0 ?
+        (origin_y_ + static_cast<double>(row + (dy > 0.0)) * resolution_ - y) * inv_dy : miss;
+    };
+
+  locate();
+
+  while (t <= t_leave) {
+    const auto d = distance_[static_cast<size_t>(row) * width_ + static_cast<size_t>(col)];
+
+    if (d == 0.0f) {
+      return t;
+    }
+
+    /// Jump by the clearance in open space
+    const auto clearance = d - diagonal;
+
+    if (clearance >= 2.0 * resolution_) {
+      t += clearance;
+      locate();
+      continue;
+    }
+
+    /// Next to a wall, step into the next cell along the ray (Amanatides and Woo)
+    if (next_col < next_row) {
+      t = next_col;
+      next_col += delta_col;
+      col += step_col;
+
+      if (col < 0 || col >= static_cast<long>(width_)) {
+        break;
+      }
+    } else {
+      t = next_row;
+      next_row += delta_row;
+      row += step_row;
+
+      if (row < 0 || row >= static_cast<long>(height_)) {
+        break;
+      }
+    }
+  }
+
+  return miss;
+}
+
+size_t DistanceField::width() const
+{
+  return width_;
+}
+
+size_t DistanceField::height() const
+{
+  return height_;
+}
+} // namespace turtlelib
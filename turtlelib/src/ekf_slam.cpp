@@ -7,6 +7,7 @@
 /// \copyright Copyright (c) 2024
 #include <armadillo>
 #include <limits>
+#include <stdexcept>
 
 #include "turtlelib/ekf_slam.hpp"
 
@@ -193,4 +194,58 @@ arma::mat EKF::get_covariance_mat() const
 {
   return covariance_mat_;
 }
+
+void EKF::merge_landmarks(int keep, int drop)
+{
+  if (keep == drop || keep < 0 || drop < 0 || keep >= num_obstacles_ || drop >= num_obstacles_) {
+    throw std::invalid_argument("Invalid landmarks to merge");
+  }
+
+  const auto n = static_cast<arma::uword>(3 + 2 * num_obstacles_);
+  const auto k_keep = static_cast<arma::uword>(3 + 2 * keep);
+  const auto k_drop = static_cast<arma::uword>(3 + 2 * drop);
+
+  arma::vec state = get_state_vec();
+
+  /// Pseudo measurement m_keep - m_drop = 0 with a tiny variance
+  arma::mat H_mat(2, n, arma::fill::zeros);
+  H_mat.at(0, k_keep) = 1.0;
+  H_mat.at(1, k_keep + 1) = 1.0;
+  H_mat.at(0, k_drop) = -1.0;
+  H_mat.at(1, k_drop + 1) = -1.0;
+
+  const arma::mat R_mat = 1e-6 * arma::mat(2, 2, arma::fill::eye);
+  const arma::mat S_mat = H_mat * covariance_mat_ * H_mat.t() + R_mat;
+  const arma::mat K_mat = covariance_mat_ * H_mat.t() * S_mat.i();
+  const arma::mat I_mat(n, n, arma::fill::eye);
+
+  state -= K_mat * (H_mat * state);
+  state.at(0) = normalize_angle(state.at(0));
+  covariance_mat_ = (I_mat - K_mat * H_mat) * covariance_mat_;
+
+  /// Remove the dropped landmark and append a blank slot at the end
+  state.shed_rows(k_drop, k_drop + 1);
+  covariance_mat_.shed_rows(k_drop, k_drop + 1);
+  covariance_mat_.shed_cols(k_drop, k_drop + 1);
+
+  state.resize(n);
+  state.at(n - 2) = 1e4;
+  state.at(n - 1) = 1e4;
+  covariance_mat_.resize(n, n);
+  covariance_mat_.at(n - 2, n - 2) = 1e10;
+  covariance_mat_.at(n - 1, n - 1) = 1e10;
+
+  obstacles_.erase(obstacles_.begin() + drop);
+  obstacles_.push_back({1e4, 1e4, -1});
+
+  state_ = {state.at(0), state.at(1), state.at(2)};
+
+  for (int i = 0; i < num_obstacles_; ++i) {
+    if (obstacles_.at(i).uid != -1) {
+      obstacles_.at(i).x = state.at(3 + 2 * i);
+      obstacles_.at(i).y = state.at(3 + 2 * i + 1);
+      obstacles_.at(i).uid = i;
+    }
+  }
+}
 } // namespace turtlelib
@@ -0,0 +1,61 @@
+/// \file fleet.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief The states of a fleet of differential drive robots, stepped together.
+/// \version 0.1
+/// \date 2024-04-08
+///
+/// \copyright Copyright (c) 2024
+#include <cmath>
+#include <stdexcept>
+
+#include "turtlelib/fleet.hpp"
+#include "turtlelib/geometry2d.hpp"
+
+namespace turtlelib
+{
+size_t add_robot(FleetState & fleet, double x, double y, double theta)
+{
+  fleet.x.push_back(x);
+  fleet.y.push_back(y);
+  fleet.theta.push_back(theta);
+  fleet.left_wheel.push_back(0.0);
+  fleet.right_wheel.push_back(0.0);
+
+  return fleet.x.size() - 1;
+}
+
+void drive_fleet(
+  FleetState & fleet, double track_width, double wheel_radius,
+  const std::vector<double> & delta_left, const std::vector<double> & delta_right)
+{
+  const auto num = fleet.x.size();
+
+  if (delta_left.size() != num || delta_right.size() != num) {
+    throw std::invalid_argument("Every robot of the fleet needs its wheel rotations");
+  }
+
+  const auto d = track_width / 2.0;
+  const auto r = wheel_radius;
+
+  for (size_t i = 0; i < num; ++i) {
+    const auto omega = r / (2.0 * d) * (delta_right[i] - delta_left[i]);
+    const auto v = r / 2.0 * (delta_left[i] + delta_right[i]);
+
+    /// The body frame displacement of integrate_twist, along an arc when turning
+    auto dx = v;
+    auto dy = 0.0;
+
+    if (!almost_equal(omega, 0.0)) {
+      dx = v / omega * std::sin(omega);
+      dy = v / omega * (1.0 - std::cos(omega));
+    }
+
+    const auto c = std::cos(fleet.theta[i]);
+    const auto s = std::sin(fleet.theta[i]);
+
+    fleet.x[i] += c * dx - s * dy;
+    fleet.y[i] += s * dx + c * dy;
+    fleet.theta[i] = normalize_angle(fleet.theta[i] + omega);
+  }
+}
+} // namespace turtlelib
@@ -0,0 +1,148 @@
+/// \file loop_closure.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Detect duplicate landmarks from revisited landmark constellations.
+/// \version 0.1
+/// \date 2024-03-26
+///
+/// \copyright Copyright (c) 2024
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "turtlelib/loop_closure.hpp"
+
+namespace turtlelib
+{
+LoopClosure::LoopClosure()
+: LoopClosure(2, 0.05, 0.3, 3.0)
+{
+}
+
+LoopClosure::LoopClosure(
+  size_t min_matches, double tolerance, double merge_radius,
+  double descriptor_radius)
+: min_matches_(min_matches), tolerance_(tolerance), merge_radius_(merge_radius),
+  descriptor_radius_(descriptor_radius)
+{
+  if (min_matches == 0 || tolerance <= 0.0 || merge_radius <= 0.0 ||
+    descriptor_radius <= merge_radius)
+  {
+    throw std::invalid_argument("Invalid loop closure configuration");
+  }
+}
+
+std::vector<double> LoopClosure::describe(
+  const std::vector<Point2D> & landmarks,
+  size_t index) const
+{
+  const auto & p = landmarks.at(index);
+  std::vector<double> distances;
+
+  for (size_t i = 0; i < landmarks.size(); ++i) {
+    const auto dx = landmarks.at(i).x - p.x;
+    const auto dy = landmarks.at(i).y - p.y;
+    const auto d = std::sqrt(dx * dx + dy * dy);
+
+    /// Neighbours this close may be the duplicate itself
+    if (i != index && d > merge_radius_ && d <= descriptor_radius_) {
+      distances.push_back(d);
+    }
+  }
+
+  std::sort(distances.begin(), distances.end());
+
+  return distances;
+}
+
+std::vector<LandmarkMatch> LoopClosure::find_duplicates(const std::vector<Point2D> & landmarks)
+{
+  descriptors_.clear();
+  index_.clear();
+
+  for (size_t i = 0; i < landmarks.size(); ++i) {
+    descriptors_.push_back(describe(landmarks, i));
+
+    for (const auto d : descriptors_.back()) {
+      const auto key = static_cast<int64_t>(std::floor(d / tolerance_));
+      index_[key].push_back({static_cast<int>(i), d});
+    }
+  }
+
+  std::vector<LandmarkMatch> candidates;
+  std::unordered_map<int, size_t> votes;
+  std::vector<int> voted;
+
+  for (size_t j = 0; j < landmarks.size(); ++j) {
+    votes.clear();
+
+    for (const auto d : descriptors_.at(j)) {
+      const auto key = static_cast<int64_t>(std::floor(d / tolerance_));
+      voted.clear();
+
+      for (int64_t bin = key - 1; bin <= key + 1; ++bin) {
+        const auto entries = index_.find(bin);
+
+        if (entries == index_.end()) {
+          continue;
+        }
+
+        for (const auto & entry : entries->second) {
+          const auto i = entry.first;
+
+          if (
+            static_cast<size_t>(i) >= j ||
+            std::fabs(entry.second - d) > tolerance_ ||
+            std::find(voted.begin(), voted.end(), i) != voted.end())
+          {
+            continue;
+          }
+
+          const auto dx = landmarks.at(i).x - landmarks.at(j).x;
+          const auto dy = landmarks.at(i).y - landmarks.at(j).y;
+
+          if (dx * dx + dy * dy <= merge_radius_ * merge_radius_) {
+            /// Each distance of the landmark votes at most once for every older landmark
+            voted.push_back(i);
+            ++votes[i];
+          }
+        }
+      }
+    }
+
+    LandmarkMatch best{-1, static_cast<int>(j), 0};
+
+    for (const auto & vote : votes) {
+      if (vote.second > best.votes || (vote.second == best.votes && vote.first < best.keep)) {
+        best.keep = vote.first;
+        best.votes = vote.second;
+      }
+    }
+
+    if (best.keep != -1 && best.votes >= min_matches_) {
+      candidates.push_back(best);
+    }
+  }
+
+  /// Accept the strongest matches first, each landmark in at most one match
+  std::sort(
+    candidates.begin(), candidates.end(),
+    [](const LandmarkMatch & a, const LandmarkMatch & b) {return a.votes > b.votes;});
+
+  std::vector<bool> used(landmarks.size(), false);
+  std::vector<LandmarkMatch> matches;
+
+  for (const auto & candidate : candidates) {
+    if (!used.at(candidate.keep) && !used.at(candidate.drop)) {
+      used.at(candidate.keep) = true;
+      used.at(candidate.drop) = true;
+      matches.push_back(candidate);
+    }
+  }
+
+  std::sort(
+    matches.begin(), matches.end(),
+    [](const LandmarkMatch & a, const LandmarkMatch & b) {return a.drop > b.drop;});
+
+  return matches;
+}
+} // namespace turtlelib
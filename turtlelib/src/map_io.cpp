@@ -0,0 +1,148 @@
+/// \file map_io.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Binary persistence of the EKF SLAM map.
+/// \version 0.1
+/// \date 2024-03-20
+///
+/// \copyright Copyright (c) 2024
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "turtlelib/map_io.hpp"
+
+namespace turtlelib
+{
+static_assert(sizeof(MapFileHeader) == 72, "Unexpected map file header size");
+
+void save_map(const std::string & filename, const SlamMap & map)
+{
+  const auto state_size = static_cast<uint64_t>(map.state.n_elem);
+
+  if (state_size < 3 || (state_size - 3) % 2 != 0) {
+    throw std::invalid_argument("Invalid state size " + std::to_string(state_size));
+  }
+
+  if ((state_size - 3) / 2 > MAP_FILE_MAX_LANDMARKS) {
+    throw std::invalid_argument("Too many landmarks " + std::to_string((state_size - 3) / 2));
+  }
+
+  if (map.covariance.n_rows != state_size || map.covariance.n_cols != state_size) {
+    throw std::invalid_argument("Covariance does not match the state size");
+  }
+
+  MapFileHeader header;
+  std::memcpy(header.magic, MAP_FILE_MAGIC, sizeof(header.magic));
+  header.version = MAP_FILE_VERSION;
+  header.num_landmarks = static_cast<uint32_t>((state_size - 3) / 2);
+  header.state_size = state_size;
+  header.map_odom[0] = map.Tmo.translation().x;
+  header.map_odom[1] = map.Tmo.translation().y;
+  header.map_odom[2] = map.Tmo.rotation();
+  header.robot[0] = map.robot.theta;
+  header.robot[1] = map.robot.x;
+  header.robot[2] = map.robot.y;
+
+  /// Write to a temporary file first so that a crash never leaves a half written map
+  const std::string tmp_filename = filename + ".tmp";
+  std::ofstream file(tmp_filename, std::ios::binary | std::ios::trunc);
+
+  if (!file) {
+    throw std::runtime_error("Failed to open " + tmp_filename + " for writing");
+  }
+
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(
+    reinterpret_cast<const char *>(map.state.memptr()),
+    static_cast<std::streamsize>(state_size * sizeof(double)));
+  file.write(
+    reinterpret_cast<const char *>(map.covariance.memptr()),
+    static_cast<std::streamsize>(state_size * state_size * sizeof(double)));
+  file.close();
+
+  if (!file) {
+    throw std::runtime_error("Failed to write " + tmp_filename);
+  }
+
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    throw std::runtime_error("Failed to move " + tmp_filename + " to " + filename);
+  }
+}
+
+SlamMap load_map(const std::string & filename)
+{
+  const int fd = open(filename.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open " + filename);
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    throw std::runtime_error("Failed to stat " + filename);
+  }
+
+  const auto file_size = static_cast<size_t>(file_stat.st_size);
+
+  if (file_size < sizeof(MapFileHeader)) {
+    close(fd);
+    throw std::runtime_error(filename + " is too small to be a map file");
+  }
+
+  void * data = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Failed to map " + filename);
+  }
+
+  MapFileHeader header;
+  std::memcpy(&header, data, sizeof(header));
+
+  std::string error;
+
+  if (std::memcmp(header.magic, MAP_FILE_MAGIC, sizeof(header.magic)) != 0) {
+    error = filename + " is not a map file";
+  } else if (header.version != MAP_FILE_VERSION) {
+    error = "Unsupported map file version " + std::to_string(header.version);
+  } else if (header.num_landmarks > MAP_FILE_MAX_LANDMARKS) {
+    /// Bounded before the size is computed, so a corrupt count cannot overflow it
+    error = "Too many landmarks in " + filename;
+  } else if (header.state_size != 3 + 2 * static_cast<uint64_t>(header.num_landmarks)) {
+    error = "Inconsistent state size in " + filename;
+  } else if (
+    file_size != sizeof(MapFileHeader) +
+    (header.state_size + header.state_size * header.state_size) * sizeof(double))
+  {
+    error = "Truncated map file " + filename;
+  }
+
+  if (!error.empty()) {
+    munmap(data, file_size);
+    throw std::runtime_error(error);
+  }
+
+  const auto n = static_cast<arma::uword>(header.state_size);
+  const auto state_ptr = reinterpret_cast<const double *>(
+    static_cast<const char *>(data) + sizeof(MapFileHeader));
+  const auto covariance_ptr = state_ptr + n;
+
+  SlamMap map{
+    Transform2D({header.map_odom[0], header.map_odom[1]}, header.map_odom[2]),
+    {header.robot[0], header.robot[1], header.robot[2]},
+    arma::vec(state_ptr, n),
+    arma::mat(covariance_ptr, n, n)
+  };
+
+  munmap(data, file_size);
+
+  return map;
+}
+} // namespace turtlelib
@@ -0,0 +1,279 @@
+/// \file obstacle_grid.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A uniform grid over cylindrical obstacles.
+/// \version 0.1
+/// \date 2024-04-04
+///
+/// \copyright Copyright (c) 2024
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "turtlelib/obstacle_grid.hpp"
+
+namespace turtlelib
+{
+ObstacleGrid::ObstacleGrid()
+: cell_size_(1.0), min_x_(0.0), min_y_(0.0), cols_(0), rows_(0), cell_start_{0}
+{
+}
+
+ObstacleGrid::ObstacleGrid(const Obstacles & obstacles, double cell_size)
+: obstacles_(obstacles), cell_size_(cell_size), min_x_(0.0), min_y_(0.0), cols_(0), rows_(0),
+  cell_start_{0}
+{
+  const auto num = obstacles.x.size();
+
+  if (obstacles.y.size() != num || obstacles.r.size() != num) {
+    throw std::invalid_argument("Every obstacle needs x, y and r");
+  }
+
+  if (cell_size <= 0.0) {
+    throw std::invalid_argument("Invalid grid cell size");
+  }
+
+  if (num == 0) {
+    return;
+  }
+
+  auto max_x = -std::numeric_limits<double>::infinity();
+  auto max_y = -std::numeric_limits<double>::infinity();
+  min_x_ = std::numeric_limits<double>::infinity();
+  min_y_ = std::numeric_limits<double>::infinity();
+
+  for (size_t i = 0; i < num; ++i) {
+    min_x_ = std::min(min_x_, obstacles.x[i] - obstacles.r[i]);
+    min_y_ = std::min(min_y_, obstacles.y[i] - obstacles.r[i]);
+    max_x = std::max(max_x, obstacles.x[i] + obstacles.r[i]);
+    max_y = std::max(max_y, obstacles.y[i] + obstacles.r[i]);
+  }
+
+  cols_ = static_cast<size_t>(std::floor((max_x - min_x_) / cell_size)) + 1;
+  rows_ = static_cast<size_t>(std::floor((max_y - min_y_) / cell_size)) + 1;
+
+  /// Count the obstacles of every cell, turn the counts into offsets, then fill
+  cell_start_.assign(cols_ * rows_ + 1, 0);
+
+  for (size_t pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < num; ++i) {
+      const auto col_lo = col_(obstacles.x[i] - obstacles.r[i]);
+      const auto col_hi = col_(obstacles.x[i] + obstacles.r[i]);
+      const auto row_lo = row_(obstacles.y[i] - obstacles.r[i]);
+      const auto row_hi = row_(obstacles.y[i] + obstacles.r[i]);
+
+      for (auto row = row_lo; row <= row_hi; ++row) {
+        for (auto col = col_lo; col <= col_hi; ++col) {
+          const auto cell = row * cols_ + col;
+
+          if (pass == 0) {
+            ++cell_start_[cell + 1];
+          } else {
+            cell_items_[cell_start_[cell]++] = i;
+          }
+        }
+      }
+    }
+
+    if (pass == 0) {
+      for (size_t c = 0; c < cols_ * rows_; ++c) {
+        cell_start_[c + 1] += cell_start_[c];
+      }
+
+      cell_items_.resize(cell_start_.back());
+    }
+  }
+
+  /// Filling advanced every offset to the start of the next cell
+  for (auto c = cols_ * rows_; c > 0; --c) {
+    cell_start_[c] = cell_start_[c - 1];
+  }
+
+  cell_start_[0] = 0;
+}
+
+size_t ObstacleGrid::col_(double x) const
+{
+  const auto col = std::floor((x - min_x_) / cell_size_);
+  return static_cast<size_t>(std::clamp(col, 0.0, static_cast<double>(cols_ - 1)));
+}
+
+size_t ObstacleGrid::row_(double y) const
+{
+  const auto row = std::floor((y - min_y_) / cell_size_);
+  return static_cast<size_t>(std::clamp(row, 0.0, static_cast<double>(rows_ - 1)));
+}
+
+void ObstacleGrid::query(double x, double y, double radius, std::vector<size_t> & indices) const
+{
+  indices.clear();
+
+  if (
+    cols_ == 0 || x + radius < min_x_ || y + radius < min_y_ ||
+    x - radius > min_x_ + cols_ * cell_size_ || y - radius > min_y_ + rows_ * cell_size_)
+  {
+    return;
+  }
+
+  const auto col_lo = col_(x - radius);
+  const auto col_hi = col_(x + radius);
+  const auto row_lo = row_(y - radius);
+  const auto row_hi = row_(y + radius);
+
+  for (auto row = row_lo; row <= row_hi; ++row) {
+    for (auto col = col_lo; col <= col_hi; ++col) {
+      const auto cell = row * cols_ + col;
+
+      for (auto k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+        const auto i = cell_items_[k];
+        const auto reach = radius + obstacles_.r[i];
+
+        if (std::hypot(obstacles_.x[i] - x, obstacles_.y[i] - y) < reach) {
+          indices.push_back(i);
+        }
+      }
+    }
+  }
+
+  /// An obstacle spanning several cells is found once per cell
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+}
+
+double ObstacleGrid::raycast(double x, double y, double dx, double dy, double max_range) const
+{
+  const auto miss = std::numeric_limits<double>::infinity();
+
+  if (cols_ == 0) {
+    return miss;
+  }
+
+  /// Clip the ray to the bounds of the grid
+  const auto max_x = min_x_ + cols_ * cell_size_;
+  const auto max_y = min_y_ + rows_ * cell_size_;
+
+  auto t_enter = 0.0;
+  auto t_leave = max_range;
+
+  const double origin[2] = {x, y};
+  const double direction[2] = {dx, dy};
+  const double lower[2] = {min_x_, min_y_};
+  const double upper[2] = {max_x, max_y};
+
+  for (int axis = 0; axis < 2; ++axis) {
+    if (direction[axis] == 0.0) {
+      if (origin[axis] < lower[axis] || origin[axis] > upper[axis]) {
+        return miss;
+      }
+      continue;
+    }
+
+    auto t0 = (lower[axis] - origin[axis]) / direction[axis];
+    auto t1 = (upper[axis] - origin[axis]) / direction[axis];
+
+    if (t0 > t1) {
+      std::swap(t0, t1);
+    }
+
+    t_enter = std::max(t_enter, t0);
+    t_leave = std::min(t_leave, t1);
+  }
+
+  if (t_enter > t_leave) {
+    return miss;
+  }
+
+  /// Walk the cells along the ray (Amanatides and Woo)
+  auto col = col_(x + dx * t_enter);
+  auto row = row_(y + dy * t_enter);
+
+  const auto delta_col = dx != 0.0 ? cell_size_ / std::fabs(dx) : miss;
+  const auto delta_row = dy != 0.0 ? cell_size_ / std::fabs(dy) : miss;
+
+  auto next_col = dx != 0.0 ?
+    (min_x_ + static_cast<double>(col + (dx > 0.0)) * cell_size_ - x) / dx : miss;
+  auto next_row = dy != 0.0 ?
+    (min_y_ + static_cast<double>(row + (dy > 0.0)) * cell_size_ - y) / dy : miss;
+
+  auto best = miss;
+
+  while (true) {
+    const auto cell = row * cols_ + col;
+
+    for (auto k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+      const auto i = cell_items_[k];
+      const auto ox = obstacles_.x[i] - x;
+      const auto oy = obstacles_.y[i] - y;
+      const auto c = ox * ox + oy * oy - obstacles_.r[i] * obstacles_.r[i];
+      const auto b = ox * dx + oy * dy;
+      const auto disc = b * b - c;
+
+      if (c > 0.0 && b > 0.0 && disc >= 0.0) {
+        best = std::min(best, b - std::sqrt(disc));
+      }
+    }
+
+    /// A hit before the ray leaves the cell cannot be beaten by a later cell
+    const auto t_cell = std::min(next_col, next_row);
+
+    if (best <= t_cell || t_cell >= t_leave) {
+      break;
+    }
+
+    if (next_col < next_row) {
+      if (dx > 0.0 ? col + 1 == cols_ : col == 0) {
+        break;
+      }
+      col = dx > 0.0 ? col + 1 : col - 1;
+      next_col += delta_col;
+    } else {
+      if (dy > 0.0 ? row + 1 == rows_ : row == 0) {
+        break;
+      }
+      row = dy > 0.0 ? row + 1 : row - 1;
+      next_row += delta_row;
+    }
+  }
+
+  return best <= max_range ? best : miss;
+}
+
+void ObstacleGrid::raycast(
+  double x, double y, const double * dir_x, const double * dir_y, size_t num_rays,
+  double max_range, double * ranges) const
+{
+  const auto miss = std::numeric_limits<double>::infinity();
+  std::fill(ranges, ranges + num_rays, miss);
+
+  /// Only obstacles reaching into the disk of the rays can be hit
+  std::vector<size_t> indices;
+  query(x, y, max_range, indices);
+
+  Obstacles near;
+  near.x.reserve(indices.size());
+  near.y.reserve(indices.size());
+  near.r.reserve(indices.size());
+
+  for (const auto i : indices) {
+    near.x.push_back(obstacles_.x[i] - x);
+    near.y.push_back(obstacles_.y[i] - y);
+    near.r.push_back(obstacles_.r[i]);
+  }
+
+  cast_rays(dir_x, dir_y, num_rays, near, ranges);
+
+  for (size_t k = 0; k < num_rays; ++k) {
+    ranges[k] = ranges[k] <= max_range ? ranges[k] : miss;
+  }
+}
+
+const Obstacles & ObstacleGrid::obstacles() const
+{
+  return obstacles_;
+}
+
+size_t ObstacleGrid::num_cells() const
+{
+  return cols_ * rows_;
+}
+} // namespace turtlelib
@@ -0,0 +1,204 @@
+/// \file occupancy_map.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Loading of PGM occupancy maps described by a map_server YAML file.
+/// \version 0.1
+/// \date 2024-04-06
+///
+/// \copyright Copyright (c) 2024
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "turtlelib/occupancy_map.hpp"
+
+namespace turtlelib
+{
+namespace
+{
+/// \brief Read the next number of a PGM header, skipping comments
+/// \param stream The image
+/// \return The number
+size_t read_pgm_number(std::istream & stream)
+{
+  stream >> std::ws;
+
+  while (stream.peek() == '#') {
+    std::string comment;
+    std::getline(stream, comment);
+    stream >> std::ws;
+  }
+
+  size_t number = 0;
+  if (!(stream >> number)) {
+    throw std::runtime_error("Invalid PGM header");
+  }
+
+  return number;
+}
+
+/// \brief Remove the spaces and quotes around a YAML value
+/// \param value The value
+/// \return The trimmed value
+std::string trim(const std::string & value)
+{
+  const auto begin = value.find_first_not_of(" \t\r\"'");
+
+  if (begin == std::string::npos) {
+    return "";
+  }
+
+  const auto end = value.find_last_not_of(" \t\r\"'");
+  return value.substr(begin, end - begin + 1);
+}
+} // namespace
+
+OccupancyMap read_pgm(
+  std::istream & stream, double resolution, double origin_x, double origin_y,
+  bool negate, double occupied_thresh, double free_thresh)
+{
+  if (resolution <= 0.0) {
+    throw std::invalid_argument("Invalid map resolution");
+  }
+
+  std::string magic;
+  stream >> magic;
+
+  if (magic != "P5" && magic != "P2") {
+    throw std::runtime_error("Not a PGM image");
+  }
+
+  const auto width = read_pgm_number(stream);
+  const auto height = read_pgm_number(stream);
+  const auto max_value = read_pgm_number(stream);
+
+  if (width == 0 || height == 0 || max_value == 0 || max_value > 65535) {
+    throw std::runtime_error("Invalid PGM header");
+  }
+
+  /// A single whitespace separates the header from binary pixels
+  if (magic == "P5") {
+    stream.get();
+  }
+
+  OccupancyMap map;
+  map.width = width;
+  map.height = height;
+  map.resolution = resolution;
+  map.origin_x = origin_x;
+  map.origin_y = origin_y;
+  map.data.resize(width * height);
+
+  for (size_t row = 0; row < height; ++row) {
+    for (size_t col = 0; col < width; ++col) {
+      size_t value = 0;
+
+      if (magic == "P2") {
+        if (!(stream >> value)) {
+          throw std::runtime_error("Truncated PGM image");
+        }
+      } else if (max_value < 256) {
+        value = static_cast<unsigned char>(stream.get());
+      } else {
+        value = static_cast<unsigned char>(stream.get()) << 8;
+        value |= static_cast<unsigned char>(stream.get());
+      }
+
+      if (!stream) {
+        throw std::runtime_error("Truncated PGM image");
+      }
+
+      /// Dark pixels are occupied unless negated
+      const auto shade = static_cast<double>(value) / static_cast<double>(max_value);
+      const auto occupancy = negate ? shade : 1.0 - shade;
+
+      auto cell = CELL_UNKNOWN;
+      if (occupancy > occupied_thresh) {
+        cell = CELL_OCCUPIED;
+      } else if (occupancy < free_thresh) {
+        cell = CELL_FREE;
+      }
+
+      /// The image starts at the top row, the map at the bottom row
+      map.data[(height - 1 - row) * width + col] = cell;
+    }
+  }
+
+  return map;
+}
+
+OccupancyMap load_occupancy_map(const std::string & yaml_filename)
+{
+  std::ifstream yaml(yaml_filename);
+
+  if (!yaml) {
+    throw std::runtime_error("Failed to open " + yaml_filename);
+  }
+
+  std::string image;
+  auto resolution = 0.0;
+  double origin[3] = {0.0, 0.0, 0.0};
+  auto negate = false;
+  auto occupied_thresh = 0.65;
+  auto free_thresh = 0.196;
+
+  /// map_server files are flat "key: value" lines
+  std::string line;
+  while (std::getline(yaml, line)) {
+    line = line.substr(0, line.find('#'));
+    const auto colon = line.find(':');
+
+    if (colon == std::string::npos) {
+      continue;
+    }
+
+    const auto key = trim(line.substr(0, colon));
+    const auto value = trim(line.substr(colon + 1));
+
+    if (key == "image") {
+      image = value;
+    } else if (key == "resolution") {
+      resolution = std::stod(value);
+    } else if (key == "origin") {
+      auto list = value;
+      for (auto & c : list) {
+        if (c == '[' || c == ']' || c == ',') {
+          c = ' ';
+        }
+      }
+
+      std::istringstream numbers(list);
+      if (!(numbers >> origin[0] >> origin[1] >> origin[2])) {
+        throw std::runtime_error("Invalid map origin in " + yaml_filename);
+      }
+    } else if (key == "negate") {
+      negate = value == "1" || value == "true";
+    } else if (key == "occupied_thresh") {
+      occupied_thresh = std::stod(value);
+    } else if (key == "free_thresh") {
+      free_thresh = std::stod(value);
+    }
+  }
+
+  if (image.empty() || resolution <= 0.0) {
+    throw std::runtime_error("Map " + yaml_filename + " needs an image and a resolution");
+  }
+
+  if (origin[2] != 0.0) {
+    throw std::runtime_error("Rotated maps are not supported");
+  }
+
+  auto image_path = std::filesystem::path(image);
+  if (image_path.is_relative()) {
+    image_path = std::filesystem::path(yaml_filename).parent_path() / image_path;
+  }
+
+  std::ifstream pgm(image_path, std::ios::binary);
+
+  if (!pgm) {
+    throw std::runtime_error("Failed to open " + image_path.string());
+  }
+
+  return read_pgm(pgm, resolution, origin[0], origin[1], negate, occupied_thresh, free_thresh);
+}
+} // namespace turtlelib
@@ -0,0 +1,236 @@
+/// \file pose_ekf.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Pose only Extended Kalman Filter against a frozen landmark map.
+/// \version 0.1
+/// \date 2024-03-22
+///
+/// \copyright Copyright (c) 2024
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "turtlelib/pose_ekf.hpp"
+
+namespace turtlelib
+{
+PoseEKF::PoseEKF()
+: PoseEKF(0.1)
+{
+}
+
+PoseEKF::PoseEKF(double gate)
+: state_{0.0, 0.0, 0.0}, covariance_{}, cell_size_(gate)
+{
+  if (gate <= 0.0) {
+    throw std::invalid_argument("The association gate must be positive");
+  }
+}
+
+int64_t PoseEKF::cell_key(int64_t ix, int64_t iy)
+{
+  return static_cast<int64_t>(
+    (static_cast<uint64_t>(ix) << 32) ^ (static_cast<uint64_t>(iy) & 0xffffffff));
+}
+
+int64_t PoseEKF::cell_index(double value) const
+{
+  return static_cast<int64_t>(std::floor(value / cell_size_));
+}
+
+void PoseEKF::set_map(const std::vector<MapLandmark> & landmarks)
+{
+  landmarks_ = landmarks;
+  grid_.clear();
+
+  for (size_t i = 0; i < landmarks_.size(); ++i) {
+    const auto key = cell_key(cell_index(landmarks_.at(i).x), cell_index(landmarks_.at(i).y));
+    grid_[key].push_back(static_cast<int>(i));
+  }
+}
+
+void PoseEKF::reset(const RobotState & state, const std::array<double, 9> & covariance)
+{
+  state_ = state;
+  covariance_ = covariance;
+}
+
+void PoseEKF::predict(const RobotState & state, const std::array<double, 9> & Q)
+{
+  const auto dx = state.x - state_.x;
+  const auto dy = state.y - state_.y;
+
+  /// A = I + [0 0 0; -dy 0 0; dx 0 0], so A P A' only touches the first column and row
+  const auto & P = covariance_;
+  std::array<double, 9> AP = P;
+
+  for (size_t j = 0; j < 3; ++j) {
+    AP.at(3 + j) -= dy * P.at(j);
+    AP.at(6 + j) += dx * P.at(j);
+  }
+
+  std::array<double, 9> APAt = AP;
+
+  for (size_t i = 0; i < 3; ++i) {
+    APAt.at(3 * i + 1) -= dy * AP.at(3 * i);
+    APAt.at(3 * i + 2) += dx * AP.at(3 * i);
+  }
+
+  for (size_t i = 0; i < 9; ++i) {
+    covariance_.at(i) = APAt.at(i) + Q.at(i);
+  }
+
+  state_ = state;
+}
+
+int PoseEKF::associate(Point2D point) const
+{
+  const auto ix = cell_index(point.x);
+  const auto iy = cell_index(point.y);
+
+  int best = -1;
+  double best_d2 = cell_size_ * cell_size_;
+
+  /// The gate equals the cell size, so only the neighbouring cells can hold a match
+  for (int64_t cx = ix - 1; cx <= ix + 1; ++cx) {
+    for (int64_t cy = iy - 1; cy <= iy + 1; ++cy) {
+      const auto cell = grid_.find(cell_key(cx, cy));
+
+      if (cell == grid_.end()) {
+        continue;
+      }
+
+      for (const auto index : cell->second) {
+        const auto & landmark = landmarks_.at(index);
+        const auto d2 =
+          (landmark.x - point.x) * (landmark.x - point.x) +
+          (landmark.y - point.y) * (landmark.y - point.y);
+
+        if (d2 <= best_d2) {
+          best_d2 = d2;
+          best = index;
+        }
+      }
+    }
+  }
+
+  return best;
+}
+
+Innovation PoseEKF::correct(Point2D observation, int index, double sensor_variance)
+{
+  const auto & landmark = landmarks_.at(index);
+  const auto & P = covariance_;
+
+  const auto dx = landmark.x - state_.x;
+  const auto dy = landmark.y - state_.y;
+  const auto q = dx * dx + dy * dy;
+  const auto r = std::sqrt(q);
+
+  Innovation innovation;
+  innovation.dz.at(0) = std::sqrt(
+    observation.x * observation.x + observation.y * observation.y) - r;
+  innovation.dz.at(1) = normalize_angle(
+    std::atan2(observation.y, observation.x) - (std::atan2(dy, dx) - state_.theta));
+
+  /// Jacobian with respect to the pose [theta, x, y]
+  const std::array<double, 6> H{
+    0.0, -dx / r, -dy / r,
+    -1.0, dy / q, -dx / q};
+
+  /// Jacobian with respect to the landmark, which only inflates the measurement noise
+  const std::array<double, 4> Hm{
+    dx / r, dy / r,
+    -dy / q, dx / q};
+
+  const auto & Pm = landmark.covariance;
+  std::array<double, 4> HmPm{};
+  std::array<double, 6> PHt{};
+
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      HmPm.at(2 * i + j) = Hm.at(2 * i) * Pm.at(j) + Hm.at(2 * i + 1) * Pm.at(2 + j);
+    }
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      PHt.at(2 * i + j) =
+        P.at(3 * i) * H.at(3 * j) +
+        P.at(3 * i + 1) * H.at(3 * j + 1) +
+        P.at(3 * i + 2) * H.at(3 * j + 2);
+    }
+  }
+
+  auto & S = innovation.S;
+
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      S.at(2 * i + j) =
+        H.at(3 * i) * PHt.at(j) +
+        H.at(3 * i + 1) * PHt.at(2 + j) +
+        H.at(3 * i + 2) * PHt.at(4 + j) +
+        HmPm.at(2 * i) * Hm.at(2 * j) +
+        HmPm.at(2 * i + 1) * Hm.at(2 * j + 1);
+    }
+  }
+
+  S.at(0) += sensor_variance;
+  S.at(3) += sensor_variance;
+
+  const auto det = S.at(0) * S.at(3) - S.at(1) * S.at(2);
+
+  if (std::fabs(det) < std::numeric_limits<double>::min()) {
+    return innovation;
+  }
+
+  const std::array<double, 4> S_inv{
+    S.at(3) / det, -S.at(1) / det,
+    -S.at(2) / det, S.at(0) / det};
+
+  std::array<double, 6> K{};
+
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 2; ++j) {
+      K.at(2 * i + j) = PHt.at(2 * i) * S_inv.at(j) + PHt.at(2 * i + 1) * S_inv.at(2 + j);
+    }
+  }
+
+  state_.theta = normalize_angle(
+    state_.theta + K.at(0) * innovation.dz.at(0) + K.at(1) * innovation.dz.at(1));
+  state_.x += K.at(2) * innovation.dz.at(0) + K.at(3) * innovation.dz.at(1);
+  state_.y += K.at(4) * innovation.dz.at(0) + K.at(5) * innovation.dz.at(1);
+
+  /// P = P - K H P, with H P = (P H')' as P is symmetric
+  std::array<double, 9> P_new{};
+
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      P_new.at(3 * i + j) = P.at(3 * i + j) -
+        K.at(2 * i) * PHt.at(2 * j) - K.at(2 * i + 1) * PHt.at(2 * j + 1);
+    }
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      covariance_.at(3 * i + j) = 0.5 * (P_new.at(3 * i + j) + P_new.at(3 * j + i));
+    }
+  }
+
+  return innovation;
+}
+
+RobotState PoseEKF::get_robot_state() const
+{
+  return state_;
+}
+
+std::array<double, 9> PoseEKF::get_covariance() const
+{
+  return covariance_;
+}
+
+const std::vector<MapLandmark> & PoseEKF::get_map() const
+{
+  return landmarks_;
+}
+} // namespace turtlelib
@@ -0,0 +1,353 @@
+/// \file relocalize.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Global relocalization by geometric hashing of landmark triplets.
+/// \version 0.1
+/// \date 2024-03-24
+///
+/// \copyright Copyright (c) 2024
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "turtlelib/relocalize.hpp"
+
+namespace turtlelib
+{
+namespace
+{
+/// \brief The number of most voted poses that are verified
+constexpr size_t MAX_CANDIDATES = 10;
+
+/// \brief The votes of a pose bin
+struct PoseVote
+{
+  /// \brief The number of votes
+  size_t count;
+
+  /// \brief The first pose voted into the bin
+  Transform2D Tmb;
+};
+
+/// \brief The distance between two points
+double distance(Point2D a, Point2D b)
+{
+  return std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y));
+}
+} // namespace
+
+Transform2D align_points(const std::vector<Point2D> & from, const std::vector<Point2D> & to)
+{
+  if (from.empty() || from.size() != to.size()) {
+    throw std::invalid_argument("Point sets must be non-empty and of equal size");
+  }
+
+  const auto n = static_cast<double>(from.size());
+  Point2D from_mean{0.0, 0.0};
+  Point2D to_mean{0.0, 0.0};
+
+  for (size_t i = 0; i < from.size(); ++i) {
+    from_mean.x += from.at(i).x / n;
+    from_mean.y += from.at(i).y / n;
+    to_mean.x += to.at(i).x / n;
+    to_mean.y += to.at(i).y / n;
+  }
+
+  double sum_cos = 0.0;
+  double sum_sin = 0.0;
+
+  for (size_t i = 0; i < from.size(); ++i) {
+    const auto ax = from.at(i).x - from_mean.x;
+    const auto ay = from.at(i).y - from_mean.y;
+    const auto bx = to.at(i).x - to_mean.x;
+    const auto by = to.at(i).y - to_mean.y;
+
+    sum_cos += ax * bx + ay * by;
+    sum_sin += ax * by - ay * bx;
+  }
+
+  const auto theta = std::atan2(sum_sin, sum_cos);
+  const auto c = std::cos(theta);
+  const auto s = std::sin(theta);
+
+  return Transform2D(
+    {to_mean.x - (c * from_mean.x - s * from_mean.y),
+      to_mean.y - (s * from_mean.x + c * from_mean.y)},
+    theta);
+}
+
+Relocalizer::Relocalizer()
+: Relocalizer(0.05, 2.0)
+{
+}
+
+Relocalizer::Relocalizer(double resolution, double max_side)
+: Relocalizer(resolution, max_side, 0.05)
+{
+}
+
+Relocalizer::Relocalizer(double resolution, double max_side, double angle_resolution)
+: resolution_(resolution), max_side_(max_side), angle_resolution_(angle_resolution),
+  num_angle_bins_(0)
+{
+  if (resolution <= 0.0 || max_side <= 0.0 || angle_resolution <= 0.0) {
+    throw std::invalid_argument("The resolutions and the maximum side must be positive");
+  }
+
+  /// Equal bins that tile the circle, so the bins at -PI and PI are the same
+  num_angle_bins_ = static_cast<int64_t>(std::ceil(2.0 * PI / angle_resolution_));
+  angle_resolution_ = 2.0 * PI / static_cast<double>(num_angle_bins_);
+}
+
+int64_t Relocalizer::triplet_key(const std::array<int64_t, 3> & q)
+{
+  return (q.at(0) & 0x1fffff) | ((q.at(1) & 0x1fffff) << 21) | ((q.at(2) & 0x1fffff) << 42);
+}
+
+std::array<double, 3> Relocalizer::canonical_triplet(
+  const std::vector<Point2D> & points,
+  std::array<int, 3> & triplet)
+{
+  std::array<std::pair<double, int>, 3> vertices;
+
+  for (size_t i = 0; i < 3; ++i) {
+    const auto & a = points.at(triplet.at((i + 1) % 3));
+    const auto & b = points.at(triplet.at((i + 2) % 3));
+    vertices.at(i) = {distance(a, b), triplet.at(i)};
+  }
+
+  std::sort(vertices.begin(), vertices.end());
+
+  std::array<double, 3> sides;
+  for (size_t i = 0; i < 3; ++i) {
+    sides.at(i) = vertices.at(i).first;
+    triplet.at(i) = vertices.at(i).second;
+  }
+
+  return sides;
+}
+
+void Relocalizer::set_map(const std::vector<Point2D> & landmarks)
+{
+  landmarks_ = landmarks;
+  table_.clear();
+
+  const auto n = landmarks_.size();
+  std::vector<std::vector<int>> neighbours(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      if (distance(landmarks_.at(i), landmarks_.at(j)) <= max_side_) {
+        neighbours.at(i).push_back(static_cast<int>(j));
+      }
+    }
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    const auto & near = neighbours.at(i);
+
+    for (size_t a = 0; a < near.size(); ++a) {
+      for (size_t b = a + 1; b < near.size(); ++b) {
+        const auto j = near.at(a);
+        const auto k = near.at(b);
+
+        if (distance(landmarks_.at(j), landmarks_.at(k)) > max_side_) {
+          continue;
+        }
+
+        std::array<int, 3> triplet{static_cast<int>(i), j, k};
+        const auto sides = canonical_triplet(landmarks_, triplet);
+
+        std::array<int64_t, 3> q;
+        for (size_t m = 0; m < 3; ++m) {
+          q.at(m) = static_cast<int64_t>(std::floor(sides.at(m) / resolution_));
+        }
+
+        table_[triplet_key(q)].push_back(triplet);
+      }
+    }
+  }
+}
+
+size_t Relocalizer::num_triplets() const
+{
+  size_t count = 0;
+
+  for (const auto & bin : table_) {
+    count += bin.second.size();
+  }
+
+  return count;
+}
+
+double Relocalizer::match(
+  const std::vector<Point2D> & observations,
+  const Transform2D & Tmb,
+  double inlier_radius,
+  std::vector<int> & matches) const
+{
+  matches.assign(observations.size(), -1);
+  double sum_squared = 0.0;
+
+  for (size_t i = 0; i < observations.size(); ++i) {
+    const auto pm = Tmb(observations.at(i));
+    double best = inlier_radius;
+
+    for (size_t j = 0; j < landmarks_.size(); ++j) {
+      const auto d = distance(pm, landmarks_.at(j));
+
+      if (d <= best) {
+        best = d;
+        matches.at(i) = static_cast<int>(j);
+      }
+    }
+
+    if (matches.at(i) != -1) {
+      sum_squared += best * best;
+    }
+  }
+
+  return sum_squared;
+}
+
+bool Relocalizer::relocalize(
+  const std::vector<Point2D> & observations,
+  double inlier_radius,
+  size_t min_inliers,
+  PoseHypothesis & hypothesis) const
+{
+  const auto k = observations.size();
+
+  if (k < 3 || table_.empty()) {
+    return false;
+  }
+
+  std::unordered_map<int64_t, PoseVote> votes;
+
+  for (size_t i = 0; i < k; ++i) {
+    for (size_t j = i + 1; j < k; ++j) {
+      for (size_t l = j + 1; l < k; ++l) {
+        std::array<int, 3> observed{
+          static_cast<int>(i), static_cast<int>(j), static_cast<int>(l)};
+        const auto sides = canonical_triplet(observations, observed);
+
+        if (sides.at(2) > max_side_ + resolution_) {
+          continue;
+        }
+
+        std::array<int64_t, 3> q;
+        for (size_t m = 0; m < 3; ++m) {
+          q.at(m) = static_cast<int64_t>(std::floor(sides.at(m) / resolution_));
+        }
+
+        /// Noisy sides may fall into a neighbouring bin
+        for (int64_t d0 = -1; d0 <= 1; ++d0) {
+          for (int64_t d1 = -1; d1 <= 1; ++d1) {
+            for (int64_t d2 = -1; d2 <= 1; ++d2) {
+              const auto bin = table_.find(
+                triplet_key({q.at(0) + d0, q.at(1) + d1, q.at(2) + d2}));
+
+              if (bin == table_.end()) {
+                continue;
+              }
+
+              for (const auto & mapped : bin->second) {
+                std::vector<Point2D> from;
+                std::vector<Point2D> to;
+
+                for (size_t m = 0; m < 3; ++m) {
+                  from.push_back(observations.at(observed.at(m)));
+                  to.push_back(landmarks_.at(mapped.at(m)));
+                }
+
+                bool similar = true;
+                for (size_t m = 0; m < 3 && similar; ++m) {
+                  const auto side = distance(to.at((m + 1) % 3), to.at((m + 2) % 3));
+                  similar = std::fabs(side - sides.at(m)) <= resolution_;
+                }
+
+                if (!similar) {
+                  continue;
+                }
+
+                const auto Tmb = align_points(from, to);
+                const auto angle_bin =
+                  static_cast<int64_t>(std::floor((Tmb.rotation() + PI) / angle_resolution_));
+                const auto key = triplet_key(
+                {
+                  static_cast<int64_t>(std::floor(Tmb.translation().x / resolution_)),
+                  static_cast<int64_t>(std::floor(Tmb.translation().y / resolution_)),
+                  (angle_bin % num_angle_bins_ + num_angle_bins_) % num_angle_bins_
+                });
+
+                auto vote = votes.find(key);
+                if (vote == votes.end()) {
+                  votes.emplace(key, PoseVote{1, Tmb});
+                } else {
+                  ++vote->second.count;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<PoseVote> candidates;
+  candidates.reserve(votes.size());
+  for (const auto & vote : votes) {
+    candidates.push_back(vote.second);
+  }
+
+  const auto num_candidates = std::min(candidates.size(), MAX_CANDIDATES);
+  std::partial_sort(
+    candidates.begin(),
+    candidates.begin() + static_cast<std::ptrdiff_t>(num_candidates),
+    candidates.end(),
+    [](const PoseVote & a, const PoseVote & b) {return a.count > b.count;});
+
+  bool found = false;
+  std::vector<int> matches;
+
+  for (size_t c = 0; c < num_candidates; ++c) {
+    auto Tmb = candidates.at(c).Tmb;
+    match(observations, Tmb, inlier_radius, matches);
+
+    /// Refine the pose with every inlier, then verify it again
+    std::vector<Point2D> from;
+    std::vector<Point2D> to;
+
+    for (size_t i = 0; i < k; ++i) {
+      if (matches.at(i) != -1) {
+        from.push_back(observations.at(i));
+        to.push_back(landmarks_.at(matches.at(i)));
+      }
+    }
+
+    if (from.size() >= 3) {
+      Tmb = align_points(from, to);
+    }
+
+    const auto sum_squared = match(observations, Tmb, inlier_radius, matches);
+    const auto inliers = static_cast<size_t>(
+      std::count_if(matches.begin(), matches.end(), [](int m) {return m != -1;}));
+
+    if (inliers == 0) {
+      continue;
+    }
+
+    const auto rms_error = std::sqrt(sum_squared / static_cast<double>(inliers));
+
+    if (
+      !found || inliers > hypothesis.inliers ||
+      (inliers == hypothesis.inliers && rms_error < hypothesis.rms_error))
+    {
+      hypothesis = {Tmb, inliers, rms_error};
+      found = true;
+    }
+  }
+
+  return found && hypothesis.inliers >= min_inliers;
+}
+} // namespace turtlelib
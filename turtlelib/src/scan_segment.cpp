@@ -0,0 +1,166 @@
+/// \file scan_segment.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Split a laser scan into clusters of neighbouring points.
+/// \version 0.1
+/// \date 2024-03-28
+///
+/// \copyright Copyright (c) 2024
+#include <cmath>
+#include <stdexcept>
+
+#include "turtlelib/scan_segment.hpp"
+
+namespace turtlelib
+{
+ScanSegmenter::ScanSegmenter()
+: ScanSegmenter(0.5, 4)
+{
+}
+
+ScanSegmenter::ScanSegmenter(double distance_threshold, size_t min_points)
+: distance_threshold_(distance_threshold), min_points_(min_points), adaptive_(false),
+  lambda_(0.0), range_sigma_(0.0), adaptive_gain_(0.0)
+{
+  if (distance_threshold <= 0.0 || min_points == 0) {
+    throw std::invalid_argument("Invalid scan segmenter configuration");
+  }
+}
+
+void ScanSegmenter::use_adaptive_threshold(double lambda, double range_sigma)
+{
+  if (lambda <= 0.0 || lambda >= PI / 2.0 || range_sigma < 0.0) {
+    throw std::invalid_argument("Invalid adaptive breakpoint configuration");
+  }
+
+  adaptive_ = true;
+  lambda_ = lambda;
+  range_sigma_ = range_sigma;
+}
+
+void ScanSegmenter::convert_(
+  const std::vector<float> & ranges, double angle_min, double angle_increment,
+  double range_min, double range_max)
+{
+  const auto n = ranges.size();
+
+  table_.update(angle_min, angle_increment, n);
+
+  beam_x_.resize(n);
+  beam_y_.resize(n);
+  beam_valid_.resize(n);
+
+  table_.to_cartesian(
+    ranges.data(), range_min, range_max,
+    beam_x_.data(), beam_y_.data(), beam_valid_.data());
+}
+
+bool ScanSegmenter::is_break_(size_t previous, size_t current) const
+{
+  if (!beam_valid_[previous] || !beam_valid_[current]) {
+    return true;
+  }
+
+  const auto dx = beam_x_[current] - beam_x_[previous];
+  const auto dy = beam_y_[current] - beam_y_[previous];
+
+  auto threshold = distance_threshold_;
+
+  if (adaptive_) {
+    const auto range = std::sqrt(
+      beam_x_[previous] * beam_x_[previous] + beam_y_[previous] * beam_y_[previous]);
+    threshold = range * adaptive_gain_ + 3.0 * range_sigma_;
+  }
+
+  return dx * dx + dy * dy >= threshold * threshold;
+}
+
+const std::vector<ScanCluster> & ScanSegmenter::segment(
+  const std::vector<float> & ranges, double angle_min, double angle_increment,
+  double range_min, double range_max)
+{
+  x_.clear();
+  y_.clear();
+  clusters_.clear();
+
+  const auto n = ranges.size();
+
+  if (n == 0) {
+    return clusters_;
+  }
+
+  if (adaptive_) {
+    const auto increment = std::fabs(angle_increment);
+
+    if (increment >= lambda_) {
+      throw std::invalid_argument("The beam increment must be smaller than lambda");
+    }
+
+    adaptive_gain_ = std::sin(increment) / std::sin(lambda_ - increment);
+  }
+
+  convert_(ranges, angle_min, angle_increment, range_min, range_max);
+
+  /// Start at a valid beam right after a break, so no cluster wraps around
+  size_t start = 0;
+  bool ring = true;
+
+  for (size_t i = 0; i < n; ++i) {
+    if (beam_valid_[i] && is_break_((i + n - 1) % n, i)) {
+      start = i;
+      ring = false;
+      break;
+    }
+  }
+
+  size_t cluster_begin = 0;
+  bool in_cluster = false;
+
+  for (size_t k = 0; k < n; ++k) {
+    const auto i = (start + k) % n;
+
+    if (!beam_valid_[i]) {
+      continue;
+    }
+
+    /// A closed ring of points is a single cluster
+    const bool split = k > 0 && !ring && is_break_((i + n - 1) % n, i);
+
+    if (in_cluster && split) {
+      if (x_.size() - cluster_begin >= min_points_) {
+        clusters_.push_back({cluster_begin, x_.size()});
+      }
+
+      in_cluster = false;
+    }
+
+    if (!in_cluster) {
+      cluster_begin = x_.size();
+      in_cluster = true;
+    }
+
+    x_.push_back(beam_x_[i]);
+    y_.push_back(beam_y_[i]);
+  }
+
+  if (in_cluster && x_.size() - cluster_begin >= min_points_) {
+    clusters_.push_back({cluster_begin, x_.size()});
+  }
+
+  return clusters_;
+}
+
+const std::vector<double> & ScanSegmenter::x() const
+{
+  return x_;
+}
+
+const std::vector<double> & ScanSegmenter::y() const
+{
+  return y_;
+}
+
+const std::vector<ScanCluster> & ScanSegmenter::clusters() const
+{
+  return clusters_;
+}
+} // namespace turtlelib
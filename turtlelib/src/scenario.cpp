@@ -0,0 +1,299 @@
+/// \file scenario.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Batches of noisy simulator runs and their result files.
+/// \version 0.1
+/// \date 2024-04-10
+///
+/// \copyright Copyright (c) 2024
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "turtlelib/scenario.hpp"
+#include "turtlelib/diff_drive.hpp"
+
+namespace turtlelib
+{
+namespace
+{
+/// \brief The fixed size header of a result file
+struct ResultFileHeader
+{
+  /// \brief The magic bytes, always RESULT_FILE_MAGIC
+  char magic[8];
+
+  /// \brief The version of the file format
+  uint32_t version;
+
+  /// \brief The size of a record, to catch files of another build
+  uint32_t record_size;
+
+  /// \brief The number of records
+  uint64_t num_results;
+};
+
+static_assert(sizeof(ResultFileHeader) == 24, "Unexpected result file header size");
+
+/// \brief Set a simulation parameter by its name
+/// \param params The parameters
+/// \param name The name of the parameter
+/// \param value The value
+/// \return Whether the parameter exists
+bool set_param(SimParams & params, const std::string & name, double value)
+{
+  if (name == "period") {
+    params.period = value;
+  } else if (name == "track_width") {
+    params.track_width = value;
+  } else if (name == "wheel_radius") {
+    params.wheel_radius = value;
+  } else if (name == "motor_cmd_per_rad_sec") {
+    params.motor_cmd_per_rad_sec = value;
+  } else if (name == "encoder_ticks_per_rad") {
+    params.encoder_ticks_per_rad = value;
+  } else if (name == "collision_radius") {
+    params.collision_radius = value;
+  } else if (name == "max_range") {
+    params.max_range = value;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+} // namespace
+
+ScenarioBatch read_scenarios(std::istream & stream)
+{
+  ScenarioBatch batch;
+  std::string line;
+  size_t line_number = 0;
+
+  while (std::getline(stream, line)) {
+    ++line_number;
+    line = line.substr(0, line.find('#'));
+
+    std::istringstream words(line);
+    std::string keyword;
+
+    if (!(words >> keyword)) {
+      continue;
+    }
+
+    auto valid = true;
+
+    if (keyword == "param") {
+      std::string name;
+      double value = 0.0;
+      valid = (words >> name >> value) && set_param(batch.params, name, value);
+    } else if (keyword == "obstacle") {
+      double x = 0.0, y = 0.0, r = 0.0;
+      valid = static_cast<bool>(words >> x >> y >> r);
+      batch.obstacles.x.push_back(x);
+      batch.obstacles.y.push_back(y);
+      batch.obstacles.r.push_back(r);
+    } else if (keyword == "wall") {
+      Segment wall{};
+      valid = static_cast<bool>(words >> wall.x1 >> wall.y1 >> wall.x2 >> wall.y2);
+      batch.walls.push_back(wall);
+    } else if (keyword == "arena") {
+      double x_length = 0.0, y_length = 0.0;
+      valid = static_cast<bool>(words >> x_length >> y_length);
+      const auto arena = arena_walls(x_length, y_length);
+      batch.walls.insert(batch.walls.end(), arena.begin(), arena.end());
+    } else if (keyword == "cell_size") {
+      valid = static_cast<bool>(words >> batch.cell_size) && batch.cell_size > 0.0;
+    } else if (keyword == "duration") {
+      valid = static_cast<bool>(words >> batch.duration);
+    } else if (keyword == "start") {
+      valid = static_cast<bool>(words >> batch.x0 >> batch.y0 >> batch.theta0);
+    } else if (keyword == "wheel_cmd") {
+      valid = static_cast<bool>(words >> batch.left_cmd >> batch.right_cmd);
+    } else if (keyword == "scenario") {
+      Scenario scenario;
+      valid = static_cast<bool>(
+        words >> scenario.seed >> scenario.input_noice >> scenario.slip_fraction >>
+          scenario.basic_sensor_variance);
+      batch.scenarios.push_back(scenario);
+    } else if (keyword == "sweep") {
+      Scenario scenario;
+      uint32_t count = 0;
+      valid = static_cast<bool>(
+        words >> scenario.seed >> count >> scenario.input_noice >> scenario.slip_fraction >>
+          scenario.basic_sensor_variance);
+
+      for (uint32_t i = 0; valid && i < count; ++i) {
+        batch.scenarios.push_back(scenario);
+        ++scenario.seed;
+      }
+    } else {
+      throw std::runtime_error(
+        "Unknown keyword " + keyword + " on line " + std::to_string(line_number));
+    }
+
+    std::string extra;
+    if (!valid || words >> extra) {
+      throw std::runtime_error("Malformed line " + std::to_string(line_number) + ": " + line);
+    }
+  }
+
+  if (batch.params.period <= 0.0 || batch.duration < 0.0) {
+    throw std::runtime_error("The period should be positive and the duration not negative");
+  }
+
+  return batch;
+}
+
+std::shared_ptr<const World> build_world(const ScenarioBatch & batch)
+{
+  auto world = std::make_shared<World>();
+  world->obstacles = ObstacleGrid(batch.obstacles, batch.cell_size);
+  world->walls = SegmentBVH(batch.walls);
+
+  return world;
+}
+
+ScenarioResult run_scenario(
+  const ScenarioBatch & batch, std::shared_ptr<const World> world, const Scenario & scenario)
+{
+  auto params = batch.params;
+  params.input_noice = scenario.input_noice;
+  params.slip_fraction = scenario.slip_fraction;
+  params.basic_sensor_variance = scenario.basic_sensor_variance;
+
+  const auto & obstacles = world->obstacles.obstacles();
+  WorldSim sim(params, std::move(world), scenario.seed);
+  sim.add_robot(batch.x0, batch.y0, batch.theta0);
+
+  /// The odometry integrates the encoders like the odometry node
+  DiffDrive odometry(params.track_width, params.wheel_radius);
+  odometry.update_config(batch.x0, batch.y0, batch.theta0);
+
+  const std::vector<double> left_cmd{batch.left_cmd};
+  const std::vector<double> right_cmd{batch.right_cmd};
+  const auto num_steps = static_cast<uint64_t>(std::llround(batch.duration / params.period));
+  const auto sensor_steps = std::max<uint64_t>(
+    1, static_cast<uint64_t>(batch.sensor_period / params.period));
+
+  ScenarioResult result{};
+  result.seed = scenario.seed;
+  result.input_noice = scenario.input_noice;
+  result.slip_fraction = scenario.slip_fraction;
+  result.basic_sensor_variance = scenario.basic_sensor_variance;
+
+  std::vector<Point2D> positions;
+  std::vector<size_t> indices;
+  auto squared_error = 0.0;
+
+  for (uint64_t n = 1; n <= num_steps; ++n) {
+    /// The sensor sees the robot before it moves, like in nusim
+    if (n % sensor_steps == 0) {
+      sim.sense_obstacles(0, positions, indices);
+
+      for (size_t k = 0; k < indices.size(); ++k) {
+        const auto dx = positions.at(k).x - obstacles.x.at(indices.at(k));
+        const auto dy = positions.at(k).y - obstacles.y.at(indices.at(k));
+        squared_error += dx * dx + dy * dy;
+      }
+
+      result.measurements += indices.size();
+    }
+
+    sim.step(left_cmd, right_cmd);
+
+    odometry.compute_fk(
+      sim.left_encoder(0) / params.encoder_ticks_per_rad,
+      sim.right_encoder(0) / params.encoder_ticks_per_rad);
+
+    const auto error = std::hypot(
+      odometry.config_x() - sim.fleet().x.at(0), odometry.config_y() - sim.fleet().y.at(0));
+    result.max_error = std::max(result.max_error, error);
+  }
+
+  result.collisions = static_cast<uint32_t>(sim.collisions());
+  result.truth[0] = sim.fleet().x.at(0);
+  result.truth[1] = sim.fleet().y.at(0);
+  result.truth[2] = sim.fleet().theta.at(0);
+  result.odometry[0] = odometry.config_x();
+  result.odometry[1] = odometry.config_y();
+  result.odometry[2] = odometry.config_theta();
+  result.final_error = std::hypot(
+    result.odometry[0] - result.truth[0], result.odometry[1] - result.truth[1]);
+
+  if (result.measurements > 0) {
+    result.sensor_rmse = std::sqrt(squared_error / static_cast<double>(result.measurements));
+  }
+
+  return result;
+}
+
+void save_results(const std::string & filename, const std::vector<ScenarioResult> & results)
+{
+  ResultFileHeader header;
+  std::memcpy(header.magic, RESULT_FILE_MAGIC, sizeof(header.magic));
+  header.version = RESULT_FILE_VERSION;
+  header.record_size = sizeof(ScenarioResult);
+  header.num_results = results.size();
+
+  /// Write to a temporary file first so that a crash never leaves half the results
+  const std::string tmp_filename = filename + ".tmp";
+  std::ofstream file(tmp_filename, std::ios::binary | std::ios::trunc);
+
+  if (!file) {
+    throw std::runtime_error("Failed to open " + tmp_filename + " for writing");
+  }
+
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(
+    reinterpret_cast<const char *>(results.data()),
+    static_cast<std::streamsize>(results.size() * sizeof(ScenarioResult)));
+  file.close();
+
+  if (!file) {
+    throw std::runtime_error("Failed to write " + tmp_filename);
+  }
+
+  if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    throw std::runtime_error("Failed to move " + tmp_filename + " to " + filename);
+  }
+}
+
+std::vector<ScenarioResult> load_results(const std::string & filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+
+  if (!file) {
+    throw std::runtime_error("Failed to open " + filename);
+  }
+
+  ResultFileHeader header;
+
+  if (!file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    throw std::runtime_error(filename + " is too small to be a result file");
+  }
+
+  if (std::memcmp(header.magic, RESULT_FILE_MAGIC, sizeof(header.magic)) != 0) {
+    throw std::runtime_error(filename + " is not a result file");
+  }
+
+  if (header.version != RESULT_FILE_VERSION || header.record_size != sizeof(ScenarioResult)) {
+    throw std::runtime_error("Unsupported result file version " + std::to_string(header.version));
+  }
+
+  std::vector<ScenarioResult> results(header.num_results);
+
+  if (
+    !file.read(
+      reinterpret_cast<char *>(results.data()),
+      static_cast<std::streamsize>(results.size() * sizeof(ScenarioResult))))
+  {
+    throw std::runtime_error("Truncated result file " + filename);
+  }
+
+  return results;
+}
+} // namespace turtlelib
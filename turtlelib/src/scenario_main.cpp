@@ -0,0 +1,87 @@
+///
+/// \file scenario_main.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief Run a batch of noisy simulator scenarios on all cores and save their results
+/// \version 0.1
+/// \date 2024-04-10
+///
+/// \copyright Copyright (c) 2024
+///
+///
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "turtlelib/scenario.hpp"
+#include "turtlelib/worker_pool.hpp"
+
+using namespace turtlelib;
+
+/// \brief Runs every scenario of a batch file in parallel and writes the result file
+/// \param argc number of arguments
+/// \param argv the batch file, the result file and optionally the number of threads
+/// \return result code
+int main(int argc, char ** argv)
+{
+  if (argc < 3 || argc > 4) {
+    std::cerr << "Usage: " << argv[0] << " <scenario_file> <result_file> [threads]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  try {
+    std::ifstream scenario_file(argv[1]);
+
+    if (!scenario_file) {
+      throw std::runtime_error(std::string("Failed to open ") + argv[1]);
+    }
+
+    const auto batch = read_scenarios(scenario_file);
+    const auto world = build_world(batch);
+
+    /// The calling thread runs scenarios too
+    size_t threads = std::thread::hardware_concurrency();
+    if (argc == 4) {
+      threads = std::stoul(argv[3]);
+    }
+
+    WorkerPool pool(threads > 1 ? threads - 1 : 0);
+    std::vector<ScenarioResult> results(batch.scenarios.size());
+
+    const auto start = std::chrono::steady_clock::now();
+
+    pool.parallel_for(
+      batch.scenarios.size(), [&](size_t i, size_t) {
+        results[i] = run_scenario(batch, world, batch.scenarios[i]);
+      });
+
+    const auto wall_time = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+
+    save_results(argv[2], results);
+
+    std::cout << "seed input_noice slip_fraction basic_sensor_variance final_error max_error "
+              << "sensor_rmse collisions" << std::endl;
+
+    for (const auto & result : results) {
+      std::cout << result.seed << " " << result.input_noice << " " << result.slip_fraction
+                << " " << result.basic_sensor_variance << " " << result.final_error << " "
+                << result.max_error << " " << result.sensor_rmse << " " << result.collisions
+                << std::endl;
+    }
+
+    std::cerr << "Ran " << results.size() << " scenarios of " << batch.duration
+              << " s on " << pool.num_workers() << " threads in " << wall_time << " s"
+              << std::endl;
+  } catch (const std::exception & e) {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,331 @@
+/// \file segment_bvh.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A bounding volume hierarchy over line segment walls.
+/// \version 0.1
+/// \date 2024-04-05
+///
+/// \copyright Copyright (c) 2024
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "turtlelib/segment_bvh.hpp"
+
+namespace turtlelib
+{
+namespace
+{
+/// \brief The deepest hierarchy a ray can walk, far more than median splits produce
+constexpr size_t MAX_DEPTH = 64;
+
+/// \brief Find where a ray enters a box
+/// \param x The x coordinate of the origin of the ray
+/// \param y The y coordinate of the origin of the ray
+/// \param inv_dx The inverse of the x component of the direction
+/// \param inv_dy The inverse of the y component of the direction
+/// \param min_x The smallest x coordinate of the box
+/// \param min_y The smallest y coordinate of the box
+/// \param max_x The largest x coordinate of the box
+/// \param max_y The largest y coordinate of the box
+/// \param t_max The length of the ray
+/// \return The distance to the entry, 0 inside the box, infinity when the ray misses
+double enter_box(
+  double x, double y, double inv_dx, double inv_dy, double min_x, double min_y, double max_x,
+  double max_y, double t_max)
+{
+  /// Infinite inverses of axis aligned rays give infinite slabs. A ray running exactly
+  /// along a side gives NaN and misses the box, and it could only graze its segments.
+  const auto tx0 = (min_x - x) * inv_dx;
+  const auto tx1 = (max_x - x) * inv_dx;
+  const auto ty0 = (min_y - y) * inv_dy;
+  const auto ty1 = (max_y - y) * inv_dy;
+
+  const auto t_enter = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), 0.0);
+  const auto t_leave = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), t_max);
+
+  return t_enter <= t_leave ? t_enter : std::numeric_limits<double>::infinity();
+}
+
+/// \brief Find the distance from a point to a box
+/// \param x The x coordinate of the point
+/// \param y The y coordinate of the point
+/// \param min_x The smallest x coordinate of the box
+/// \param min_y The smallest y coordinate of the box
+/// \param max_x The largest x coordinate of the box
+/// \param max_y The largest y coordinate of the box
+/// \return The distance to the box, 0 inside the box
+double box_distance(
+  double x, double y, double min_x, double min_y, double max_x, double max_y)
+{
+  const auto dx = std::max({min_x - x, 0.0, x - max_x});
+  const auto dy = std::max({min_y - y, 0.0, y - max_y});
+  return std::sqrt(dx * dx + dy * dy);
+}
+} // namespace
+
+double raycast_segment(double x, double y, double dx, double dy, const Segment & segment)
+{
+  const auto ex = segment.x2 - segment.x1;
+  const auto ey = segment.y2 - segment.y1;
+  const auto px = segment.x1 - x;
+  const auto py = segment.y1 - y;
+
+  /// Solve origin + t direction = start + u (end - start)
+  const auto denom = dx * ey - dy * ex;
+
+  if (std::fabs(denom) < 1e-12) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  const auto t = (px * ey - py * ex) / denom;
+  const auto u = (px * dy - py * dx) / denom;
+
+  if (t < 0.0 || u < 0.0 || u > 1.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+
+  return t;
+}
+
+double distance_segment(double x, double y, const Segment & segment)
+{
+  const auto ex = segment.x2 - segment.x1;
+  const auto ey = segment.y2 - segment.y1;
+  const auto length_sq = ex * ex + ey * ey;
+
+  /// The closest point is the projection of the point, clamped to the segment
+  auto u = 0.0;
+  if (length_sq > 0.0) {
+    u = std::clamp(((x - segment.x1) * ex + (y - segment.y1) * ey) / length_sq, 0.0, 1.0);
+  }
+
+  return std::hypot(segment.x1 + u * ex - x, segment.y1 + u * ey - y);
+}
+
+SegmentBVH::SegmentBVH()
+: leaf_size_(4)
+{
+}
+
+SegmentBVH::SegmentBVH(std::vector<Segment> segments, size_t leaf_size)
+: segments_(std::move(segments)), leaf_size_(leaf_size)
+{
+  if (leaf_size == 0) {
+    throw std::invalid_argument("Invalid segment BVH leaf size");
+  }
+
+  if (segments_.size() > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument("Too many segments for a segment BVH");
+  }
+
+  if (!segments_.empty()) {
+    nodes_.reserve(2 * segments_.size() / leaf_size_ + 1);
+    build_(0, segments_.size());
+  }
+}
+
+void SegmentBVH::build_(size_t begin, size_t end)
+{
+  Node node{
+    std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+    -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+    static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin)};
+
+  auto center_min_x = std::numeric_limits<double>::infinity();
+  auto center_min_y = std::numeric_limits<double>::infinity();
+  auto center_max_x = -std::numeric_limits<double>::infinity();
+  auto center_max_y = -std::numeric_limits<double>::infinity();
+
+  for (auto i = begin; i < end; ++i) {
+    const auto & s = segments_[i];
+    node.min_x = std::min({node.min_x, s.x1, s.x2});
+    node.min_y = std::min({node.min_y, s.y1, s.y2});
+    node.max_x = std::max({node.max_x, s.x1, s.x2});
+    node.max_y = std::max({node.max_y, s.y1, s.y2});
+
+    center_min_x = std::min(center_min_x, s.x1 + s.x2);
+    center_min_y = std::min(center_min_y, s.y1 + s.y2);
+    center_max_x = std::max(center_max_x, s.x1 + s.x2);
+    center_max_y = std::max(center_max_y, s.y1 + s.y2);
+  }
+
+  const auto index = nodes_.size();
+  nodes_.push_back(node);
+
+  if (end - begin <= leaf_size_) {
+    return;
+  }
+
+  /// Split at the median center along the longer side
+  const auto split_x = center_max_x - center_min_x >= center_max_y - center_min_y;
+  const auto middle = begin + (end - begin) / 2;
+
+  std::nth_element(
+    segments_.begin() + begin, segments_.begin() + middle, segments_.begin() + end,
+    [split_x](const Segment & a, const Segment & b) {
+      return split_x ? a.x1 + a.x2 < b.x1 + b.x2 : a.y1 + a.y2 < b.y1 + b.y2;
+    });
+
+  build_(begin, middle);
+  nodes_[index].index = static_cast<uint32_t>(nodes_.size());
+  nodes_[index].count = 0;
+  build_(middle, end);
+}
+
+double SegmentBVH::raycast(double x, double y, double dx, double dy, double max_range) const
+{
+  auto best = std::numeric_limits<double>::infinity();
+
+  if (nodes_.empty()) {
+    return best;
+  }
+
+  /// A single leaf is cheaper to test directly than through its box
+  if (nodes_.size() == 1) {
+    for (const auto & segment : segments_) {
+      best = std::min(best, raycast_segment(x, y, dx, dy, segment));
+    }
+
+    return best <= max_range ? best : std::numeric_limits<double>::infinity();
+  }
+
+  const auto inv_dx = 1.0 / dx;
+  const auto inv_dy = 1.0 / dy;
+
+  /// The nodes still to visit, with the distance at which the ray enters them
+  std::array<std::pair<size_t, double>, MAX_DEPTH> stack;
+  size_t top = 0;
+
+  const auto & root = nodes_.front();
+  const auto t_root = enter_box(
+    x, y, inv_dx, inv_dy, root.min_x, root.min_y, root.max_x, root.max_y, max_range);
+
+  if (t_root <= max_range) {
+    stack[top++] = {0, t_root};
+  }
+
+  while (top > 0) {
+    const auto [index, t_node] = stack[--top];
+
+    if (t_node > best) {
+      continue;
+    }
+
+    const auto & node = nodes_[index];
+
+    if (node.count > 0) {
+      for (auto i = node.index; i < node.index + node.count; ++i) {
+        best = std::min(best, raycast_segment(x, y, dx, dy, segments_[i]));
+      }
+      continue;
+    }
+
+    const auto limit = std::min(best, max_range);
+    const auto & left = nodes_[index + 1];
+    const auto & right = nodes_[node.index];
+    const auto t_left = enter_box(
+      x, y, inv_dx, inv_dy, left.min_x, left.min_y, left.max_x, left.max_y, limit);
+    const auto t_right = enter_box(
+      x, y, inv_dx, inv_dy, right.min_x, right.min_y, right.max_x, right.max_y, limit);
+
+    /// Push the farther child first, so the closer one is visited first
+    const std::pair<size_t, double> left_child{index + 1, t_left};
+    const std::pair<size_t, double> right_child{node.index, t_right};
+    const auto left_first = t_left <= t_right;
+
+    for (const auto & child : {left_first ? right_child : left_child,
+        left_first ? left_child : right_child})
+    {
+      if (child.second <= limit && top < MAX_DEPTH) {
+        stack[top++] = child;
+      }
+    }
+  }
+
+  return best <= max_range ? best : std::numeric_limits<double>::infinity();
+}
+
+double SegmentBVH::distance(double x, double y, double max_distance) const
+{
+  auto best = std::numeric_limits<double>::infinity();
+
+  if (nodes_.empty()) {
+    return best;
+  }
+
+  /// The nodes still to visit, with the distance to their boxes
+  std::array<std::pair<size_t, double>, MAX_DEPTH> stack;
+  size_t top = 0;
+
+  const auto & root = nodes_.front();
+  const auto d_root = box_distance(x, y, root.min_x, root.min_y, root.max_x, root.max_y);
+
+  if (d_root <= max_distance) {
+    stack[top++] = {0, d_root};
+  }
+
+  while (top > 0) {
+    const auto [index, d_node] = stack[--top];
+
+    if (d_node > best) {
+      continue;
+    }
+
+    const auto & node = nodes_[index];
+
+    if (node.count > 0) {
+      for (auto i = node.index; i < node.index + node.count; ++i) {
+        best = std::min(best, distance_segment(x, y, segments_[i]));
+      }
+      continue;
+    }
+
+    const auto limit = std::min(best, max_distance);
+    const auto & left = nodes_[index + 1];
+    const auto & right = nodes_[node.index];
+    const auto d_left = box_distance(x, y, left.min_x, left.min_y, left.max_x, left.max_y);
+    const auto d_right =
+      box_distance(x, y, right.min_x, right.min_y, right.max_x, right.max_y);
+
+    /// Push the farther child first, so the closer one is visited first
+    const std::pair<size_t, double> left_child{index + 1, d_left};
+    const std::pair<size_t, double> right_child{node.index, d_right};
+    const auto left_first = d_left <= d_right;
+
+    for (const auto & child : {left_first ? right_child : left_child,
+        left_first ? left_child : right_child})
+    {
+      if (child.second <= limit && top < MAX_DEPTH) {
+        stack[top++] = child;
+      }
+    }
+  }
+
+  return best <= max_distance ? best : std::numeric_limits<double>::infinity();
+}
+
+const std::vector<Segment> & SegmentBVH::segments() const
+{
+  return segments_;
+}
+
+size_t SegmentBVH::num_nodes() const
+{
+  return nodes_.size();
+}
+
+std::vector<Segment> arena_walls(double x_length, double y_length)
+{
+  const auto hx = x_length / 2.0;
+  const auto hy = y_length / 2.0;
+
+  return {
+    {hx, -hy, hx, hy},
+    {hx, hy, -hx, hy},
+    {-hx, hy, -hx, -hy},
+    {-hx, -hy, hx, -hy}};
+}
+} // namespace turtlelib
@@ -1,5 +1,6 @@
 #include <cmath>
-#include <iostream>
+#include <limits>
+#include <stdexcept>
 
 #include "turtlelib/trig2d.hpp"
 #include "turtlelib/se2d.hpp"
@@ -39,7 +40,6 @@ double find_distance(double alpha, Obstacle obs)
 {
   Vector2D v_AO = Vector2D{obs.x, obs.y};
   const auto alpha_prime = fabs(alpha - atan2(obs.y, obs.x));
-  std::cout << "alpha_prime = " << alpha_prime << std::endl;
   const auto a = magnitude(v_AO);
 
   if (almost_equal(alpha_prime, 0.0)) {
@@ -51,4 +51,37 @@ double find_distance(double alpha, Obstacle obs)
     return obs.r * sin(gamma) / sin(alpha_prime);
   }
 }
+
+void cast_rays(
+  const double * dir_x, const double * dir_y, size_t num_rays, const Obstacles & obstacles,
+  double * ranges)
+{
+  if (obstacles.y.size() != obstacles.x.size() || obstacles.r.size() != obstacles.x.size()) {
+    throw std::invalid_argument("Every obstacle needs x, y and r");
+  }
+
+  const auto miss = std::numeric_limits<double>::infinity();
+
+  for (size_t j = 0; j < obstacles.x.size(); ++j) {
+    const auto ox = obstacles.x[j];
+    const auto oy = obstacles.y[j];
+    const auto c = ox * ox + oy * oy - obstacles.r[j] * obstacles.r[j];
+
+    if (c <= 0.0) {
+      continue;
+    }
+
+    for (size_t i = 0; i < num_rays; ++i) {
+      const auto b = dir_x[i] * ox + dir_y[i] * oy;
+      const auto disc = b * b - c;
+
+      /// With the origin outside, both roots share the sign of b
+      const auto near = b - std::sqrt(disc > 0.0 ? disc : 0.0);
+      const auto hit = disc >= 0.0 ? near : miss;
+      const auto ahead = b > 0.0 ? hit : miss;
+
+      ranges[i] = ahead < ranges[i] ? ahead : ranges[i];
+    }
+  }
+}
 } // namespace turtlelib
@@ -0,0 +1,110 @@
+/// \file worker_pool.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief A small persistent pool of worker threads.
+/// \version 0.1
+/// \date 2024-03-30
+///
+/// \copyright Copyright (c) 2024
+#include "turtlelib/worker_pool.hpp"
+
+namespace turtlelib
+{
+WorkerPool::WorkerPool(size_t num_threads)
+: job_(nullptr), count_(0), next_(0), generation_(0), active_(0), stop_(false)
+{
+  for (size_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&WorkerPool::loop_, this, i + 1);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+
+  start_cv_.notify_all();
+
+  for (auto & thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::run_(size_t worker)
+{
+  for (auto i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1)) {
+    try {
+      (*job_)(i, worker);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+}
+
+void WorkerPool::loop_(size_t worker)
+{
+  size_t seen = 0;
+
+  while (true) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    start_cv_.wait(lock, [this, &seen]() {return stop_ || generation_ != seen;});
+
+    if (stop_) {
+      return;
+    }
+
+    seen = generation_;
+    lock.unlock();
+
+    run_(worker);
+
+    lock.lock();
+    if (--active_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+size_t WorkerPool::num_workers() const
+{
+  return threads_.size() + 1;
+}
+
+void WorkerPool::parallel_for(size_t count, const std::function<void(size_t, size_t)> & fn)
+{
+  /// Waking the threads is not worth it for a single index
+  if (threads_.empty() || count <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      fn(i, 0);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &fn;
+    count_ = count;
+    next_ = 0;
+    error_ = nullptr;
+    active_ = threads_.size();
+    ++generation_;
+  }
+
+  start_cv_.notify_all();
+
+  run_(0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() {return active_ == 0;});
+  job_ = nullptr;
+
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+} // namespace turtlelib
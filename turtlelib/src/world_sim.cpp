@@ -0,0 +1,331 @@
+/// \file world_sim.cpp
+/// \author Allen Liu (jingkunliu2025@u.northwestern.edu)
+/// \brief The physics and sensor models of the simulator, without ROS.
+/// \version 0.1
+/// \date 2024-04-10
+///
+/// \copyright Copyright (c) 2024
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "turtlelib/world_sim.hpp"
+#include "turtlelib/se2d.hpp"
+
+namespace turtlelib
+{
+namespace
+{
+/// The kinds of noise, the low bits of a stream
+constexpr uint32_t INPUT_STREAM = 0;
+constexpr uint32_t SLIP_STREAM = 1;
+constexpr uint32_t SENSOR_STREAM = 2;
+constexpr uint32_t LASER_STREAM = 3;
+
+/// The number of lidar noise samples filled at once
+constexpr size_t LASER_CHUNK = 256;
+
+/// \brief Make the stream of a kind of noise of a robot
+/// \param robot The index of the robot
+/// \param kind The kind of noise
+/// \return The stream
+uint32_t robot_stream(size_t robot, uint32_t kind)
+{
+  return static_cast<uint32_t>(robot << 2) | kind;
+}
+} // namespace
+
+WorldSim::WorldSim()
+: WorldSim(SimParams{}, std::make_shared<World>(), 0)
+{
+}
+
+WorldSim::WorldSim(
+  const SimParams & params, std::shared_ptr<const World> world, uint64_t seed)
+: params_(params), world_(std::move(world)),
+  beams_(-PI, params.lidar_resolution, static_cast<size_t>(PI * 2.0 / params.lidar_resolution)),
+  seed_(seed), tick_(0), collisions_(0)
+{
+  if (!world_) {
+    throw std::invalid_argument("The simulation needs a world");
+  }
+}
+
+size_t WorldSim::add_robot(double x, double y, double theta)
+{
+  delta_left_.push_back(0.0);
+  delta_right_.push_back(0.0);
+  pre_x_.push_back(x);
+  pre_y_.push_back(y);
+  input_noice_.resize(2 * delta_left_.size());
+  slip_noice_.resize(2 * delta_left_.size());
+
+  return turtlelib::add_robot(fleet_, x, y, theta);
+}
+
+void WorldSim::place_robot(size_t i, double x, double y, double theta)
+{
+  fleet_.x.at(i) = x;
+  fleet_.y.at(i) = y;
+  fleet_.theta.at(i) = theta;
+}
+
+void WorldSim::reset_robot(size_t i, double x, double y, double theta)
+{
+  place_robot(i, x, y, theta);
+  fleet_.left_wheel.at(i) = 0.0;
+  fleet_.right_wheel.at(i) = 0.0;
+}
+
+void WorldSim::step(const std::vector<double> & left_cmd, const std::vector<double> & right_cmd)
+{
+  const auto num = fleet_.x.size();
+
+  if (left_cmd.size() != num || right_cmd.size() != num) {
+    throw std::invalid_argument("Every robot needs its wheel commands");
+  }
+
+  const auto period = params_.period;
+  const auto input_stddev = std::sqrt(params_.input_noice);
+  const auto slip_fraction = params_.slip_fraction;
+
+  /// Samples 2i and 2i + 1 are the left and right wheel of robot i
+  fill_normal({seed_, tick_, INPUT_STREAM}, 0, 2 * num, input_noice_.data());
+  fill_uniform({seed_, tick_, SLIP_STREAM}, 0, 2 * num, slip_noice_.data());
+
+  for (size_t i = 0; i < num; ++i) {
+    auto left_wheel_speed = left_cmd[i] * params_.motor_cmd_per_rad_sec;
+    auto right_wheel_speed = right_cmd[i] * params_.motor_cmd_per_rad_sec;
+
+    const auto left_wheel_noice = input_stddev * input_noice_[2 * i];
+    const auto right_wheel_noice = input_stddev * input_noice_[2 * i + 1];
+
+    if (
+      !almost_equal(left_wheel_speed, 0.0, 1e-2) ||
+      !almost_equal(right_wheel_speed, 0.0, 1e-2))
+    {
+      left_wheel_speed += left_wheel_noice;
+      right_wheel_speed += right_wheel_noice;
+    }
+
+    const auto ita_left = slip_fraction * (2.0 * slip_noice_[2 * i] - 1.0);
+    const auto ita_right = slip_fraction * (2.0 * slip_noice_[2 * i + 1] - 1.0);
+
+    delta_left_[i] = left_wheel_speed * period * (1.0 + ita_left);
+    delta_right_[i] = right_wheel_speed * period * (1.0 + ita_right);
+    fleet_.left_wheel[i] += left_wheel_speed * period;
+    fleet_.right_wheel[i] += right_wheel_speed * period;
+
+    pre_x_[i] = fleet_.x[i];
+    pre_y_[i] = fleet_.y[i];
+  }
+
+  drive_fleet(fleet_, params_.track_width, params_.wheel_radius, delta_left_, delta_right_);
+
+  for (size_t i = 0; i < num; ++i) {
+    check_collision_(i);
+  }
+
+  ++tick_;
+}
+
+void WorldSim::check_collision_(size_t i)
+{
+  const auto robot_x = fleet_.x[i];
+  const auto robot_y = fleet_.y[i];
+  const auto & obstacles = world_->obstacles.obstacles();
+
+  /// The obstacles overlapping the robot, in increasing order
+  world_->obstacles.query(robot_x, robot_y, params_.collision_radius, nearby_);
+
+  /// The robot turns towards the first obstacle it hits
+  if (!nearby_.empty()) {
+    const auto k = nearby_.front();
+    const auto dx = obstacles.x.at(k) - robot_x;
+    const auto dy = obstacles.y.at(k) - robot_y;
+
+    fleet_.x[i] = pre_x_[i];
+    fleet_.y[i] = pre_y_[i];
+    fleet_.theta[i] = std::atan2(dy, dx);
+    ++collisions_;
+  }
+
+  /// The walls only search the hierarchy nodes within the collision radius
+  const auto wall_distance =
+    world_->walls.distance(fleet_.x[i], fleet_.y[i], params_.collision_radius);
+
+  if (wall_distance < params_.collision_radius) {
+    fleet_.x[i] = pre_x_[i];
+    fleet_.y[i] = pre_y_[i];
+    ++collisions_;
+  }
+
+  /// The clearance to the map is a single lookup in its distance field
+  if (world_->map.distance(fleet_.x[i], fleet_.y[i]) < params_.collision_radius) {
+    fleet_.x[i] = pre_x_[i];
+    fleet_.y[i] = pre_y_[i];
+    ++collisions_;
+  }
+}
+
+void WorldSim::sense_obstacles(
+  size_t i, std::vector<Point2D> & positions, std::vector<size_t> & indices)
+{
+  positions.clear();
+  indices.clear();
+
+  const auto robot_x = fleet_.x.at(i);
+  const auto robot_y = fleet_.y.at(i);
+  const auto & obstacles = world_->obstacles.obstacles();
+  const auto stddev = std::sqrt(params_.basic_sensor_variance);
+  const NoiseKey key{seed_, tick_, robot_stream(i, SENSOR_STREAM)};
+
+  /// Only the cells around the robot are visited
+  world_->obstacles.query(robot_x, robot_y, params_.max_range, nearby_);
+
+  for (const auto k : nearby_) {
+    const auto dist = std::hypot(obstacles.x.at(k) - robot_x, obstacles.y.at(k) - robot_y);
+
+    if (dist >= params_.max_range) {
+      continue;
+    }
+
+    /// Samples 2k and 2k + 1 are the x and y noise of obstacle k
+    double noice[2];
+    fill_normal(key, 2 * k, 2, noice);
+
+    const auto obs_x = obstacles.x.at(k) + stddev * noice[0];
+    const auto obs_y = obstacles.y.at(k) + stddev * noice[1];
+
+    positions.push_back({obs_x, obs_y});
+    indices.push_back(k);
+  }
+}
+
+void WorldSim::scan(size_t i, std::vector<float> & ranges) const
+{
+  /// The lidar sits 3.2 cm behind the center of the robot
+  const Transform2D T_sb({0.032, 0.0}, 0.0);
+  const Transform2D T_wb({fleet_.x.at(i), fleet_.y.at(i)}, fleet_.theta.at(i));
+  const Transform2D T_ws = (T_sb * T_wb.inv()).inv();
+
+  const auto x_scan = T_ws.translation().x;
+  const auto y_scan = T_ws.translation().y;
+  const auto theta_scan = T_ws.rotation();
+  const auto range_max = params_.lidar_range_max;
+
+  const auto & beam_cos = beams_.cos();
+  const auto & beam_sin = beams_.sin();
+  const auto num_beams = beams_.size();
+
+  /// Rotate the cached beam directions into the world frame
+  const auto cos_scan = std::cos(theta_scan);
+  const auto sin_scan = std::sin(theta_scan);
+
+  ranges.resize(num_beams);
+
+  std::vector<double> dir_x(num_beams), dir_y(num_beams), obstacle_ranges(num_beams);
+
+  for (size_t k = 0; k < num_beams; ++k) {
+    dir_x[k] = beam_cos[k] * cos_scan - beam_sin[k] * sin_scan;
+    dir_y[k] = beam_sin[k] * cos_scan + beam_cos[k] * sin_scan;
+  }
+
+  /// All beams are cast at once against the obstacles within the lidar range
+  world_->obstacles.raycast(
+    x_scan, y_scan, dir_x.data(), dir_y.data(), num_beams, range_max, obstacle_ranges.data());
+
+  for (size_t k = 0; k < num_beams; ++k) {
+    const auto obstacle_range = obstacle_ranges[k];
+
+    /// Walls behind the closest obstacle are not searched
+    const auto wall_range = world_->walls.raycast(
+      x_scan, y_scan, dir_x[k], dir_y[k], std::min(obstacle_range, range_max));
+
+    /// The map is sphere traced through its distance field
+    const auto map_range = world_->map.raycast(
+      x_scan, y_scan, dir_x[k], dir_y[k], std::min({obstacle_range, wall_range, range_max}));
+    ranges[k] = static_cast<float>(std::min({obstacle_range, wall_range, map_range}));
+  }
+
+  /// The noise of beam k is sample k of the laser stream, filled a chunk at a time
+  const auto stddev = params_.lidar_accuracy / 6.0;
+  const NoiseKey key{seed_, tick_, robot_stream(i, LASER_STREAM)};
+  double noice[LASER_CHUNK];
+
+  for (size_t first = 0; first < num_beams; first += LASER_CHUNK) {
+    const auto count = std::min(LASER_CHUNK, num_beams - first);
+    fill_normal(key, first, count, noice);
+
+    for (size_t k = 0; k < count; ++k) {
+      const auto range = ranges[first + k];
+
+      if (range < std::numeric_limits<float>::infinity()) {
+        ranges[first + k] = static_cast<float>(range + stddev * noice[k]);
+      }
+    }
+  }
+}
+
+SimSnapshot WorldSim::snapshot() const
+{
+  return {tick_, fleet_};
+}
+
+void WorldSim::restore(const SimSnapshot & snapshot)
+{
+  const auto num = snapshot.fleet.x.size();
+
+  fleet_ = snapshot.fleet;
+  tick_ = snapshot.tick;
+
+  delta_left_.resize(num);
+  delta_right_.resize(num);
+  pre_x_.resize(num);
+  pre_y_.resize(num);
+  input_noice_.resize(2 * num);
+  slip_noice_.resize(2 * num);
+}
+
+int32_t WorldSim::left_encoder(size_t i) const
+{
+  return static_cast<int32_t>(fleet_.left_wheel.at(i) * params_.encoder_ticks_per_rad);
+}
+
+int32_t WorldSim::right_encoder(size_t i) const
+{
+  return static_cast<int32_t>(fleet_.right_wheel.at(i) * params_.encoder_ticks_per_rad);
+}
+
+size_t WorldSim::collisions() const
+{
+  return collisions_;
+}
+
+size_t WorldSim::num_beams() const
+{
+  return beams_.size();
+}
+
+uint64_t WorldSim::tick() const
+{
+  return tick_;
+}
+
+const FleetState & WorldSim::fleet() const
+{
+  return fleet_;
+}
+
+const SimParams & WorldSim::params() const
+{
+  return params_;
+}
+
+const World & WorldSim::world() const
+{
+  return *world_;
+}
+} // namespace turtlelib
@@ -0,0 +1,78 @@
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "turtlelib/beam_table.hpp"
+#include "turtlelib/geometry2d.hpp"
+
+#define TOLERANCE 1e-12
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test beam table caching", "[BeamTable]")
+{
+  BeamTable table;
+  REQUIRE(table.size() == 0);
+
+  REQUIRE(table.update(-PI, deg2rad(1.0), 360));
+  REQUIRE(table.size() == 360);
+  REQUIRE_FALSE(table.update(-PI, deg2rad(1.0), 360));
+
+  REQUIRE_THAT(table.cos().at(90), WithinAbs(std::cos(-PI + deg2rad(90.0)), TOLERANCE));
+  REQUIRE_THAT(table.sin().at(90), WithinAbs(std::sin(-PI + deg2rad(90.0)), TOLERANCE));
+
+  /// Any change of the geometry rebuilds the table
+  REQUIRE(table.update(-PI, deg2rad(1.0), 180));
+  REQUIRE(table.update(0.0, deg2rad(1.0), 180));
+  REQUIRE(table.update(0.0, deg2rad(2.0), 180));
+  REQUIRE_THAT(table.sin().at(45), WithinAbs(1.0, TOLERANCE));
+}
+
+TEST_CASE("Test beam table conversion", "[BeamTable]")
+{
+  const BeamTable table(0.0, PI / 2.0, 4);
+  const std::vector<float> ranges{
+    1.0f, 2.0f, 0.05f, std::numeric_limits<float>::quiet_NaN()};
+
+  std::vector<double> x(4), y(4);
+  std::vector<uint8_t> valid(4);
+  table.to_cartesian(ranges.data(), 0.1, 3.5, x.data(), y.data(), valid.data());
+
+  REQUIRE_THAT(x.at(0), WithinAbs(1.0, TOLERANCE));
+  REQUIRE_THAT(y.at(0), WithinAbs(0.0, TOLERANCE));
+  REQUIRE_THAT(x.at(1), WithinAbs(0.0, TOLERANCE));
+  REQUIRE_THAT(y.at(1), WithinAbs(2.0, TOLERANCE));
+
+  REQUIRE(valid.at(0) == 1);
+  REQUIRE(valid.at(1) == 1);
+  REQUIRE(valid.at(2) == 0);
+  REQUIRE(valid.at(3) == 0);
+}
+
+TEST_CASE("Test beam table bounds match double compares", "[BeamTable]")
+{
+  const std::vector<float> ranges{
+    0.1f, std::nextafter(0.1f, 0.0f), 3.5f, std::nextafter(3.5f, 0.0f), 0.0f, 1e30f,
+    std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+  const BeamTable table(0.0, 0.1, ranges.size());
+
+  std::vector<double> x(ranges.size()), y(ranges.size());
+  std::vector<uint8_t> valid(ranges.size());
+
+  for (const auto & bounds : std::vector<std::pair<double, double>>{
+      {0.1, 3.5}, {0.0, 1e40}, {-1e40, 0.1}, {1e-46, 3.5000000001}})
+  {
+    table.to_cartesian(
+      ranges.data(), bounds.first, bounds.second, x.data(), y.data(), valid.data());
+
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      const double range = ranges.at(i);
+      REQUIRE(valid.at(i) == ((range > bounds.first) && (range < bounds.second)));
+    }
+  }
+}
+} // namespace turtlelib
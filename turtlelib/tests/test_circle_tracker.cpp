@@ -0,0 +1,74 @@
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <vector>
+
+#include "turtlelib/circle_tracker.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+namespace
+{
+/// \brief Sample the near side of a circle as seen from the origin
+void sample_arc(const Landmark & circle, std::vector<double> & x, std::vector<double> & y)
+{
+  x.clear();
+  y.clear();
+
+  const auto facing = std::atan2(-circle.y, -circle.x);
+  for (int i = -5; i <= 5; ++i) {
+    const auto phi = facing + i * 0.25;
+    x.push_back(circle.x + circle.r * std::cos(phi));
+    y.push_back(circle.y + circle.r * std::sin(phi));
+  }
+}
+} // namespace
+
+TEST_CASE("Test circle tracking", "[CircleTracker]")
+{
+  CircleTracker tracker(0.02, 1);
+  std::vector<double> x, y;
+
+  /// Two circles in the first scan start two tracks
+  const Landmark a{1.0, 0.5, 0.05};
+  const Landmark b{0.5, -1.0, 0.05};
+  sample_arc(a, x, y);
+  REQUIRE(tracker.match(x.data(), y.data(), x.size()) == -1);
+
+  const auto ids = tracker.update({a, b}, {-1, -1});
+  REQUIRE(ids == std::vector<int>{0, 1});
+
+  /// The robot drives 0.1 m forward and turns, so the circles move in the scan frame
+  const Transform2D T_prev_curr({0.1, 0.0}, 0.2);
+  const auto T_curr_prev = T_prev_curr.inv();
+  tracker.predict(T_curr_prev);
+
+  const auto pb = T_curr_prev(Point2D{b.x, b.y});
+  const Landmark b_curr{pb.x, pb.y, 0.05};
+  sample_arc(b_curr, x, y);
+
+  const auto index = tracker.match(x.data(), y.data(), x.size());
+  REQUIRE(index == 1);
+
+  /// Warm started from the prediction, refinement recovers a perturbed circle
+  Landmark guess = tracker.tracks().at(index).circle;
+  guess.x += 0.01;
+  guess.r += 0.005;
+  const auto refined = refine_circle(x.data(), y.data(), x.size(), guess, 5);
+  REQUIRE_THAT(refined.x, WithinAbs(b_curr.x, 1e-9));
+  REQUIRE_THAT(refined.y, WithinAbs(b_curr.y, 1e-9));
+  REQUIRE_THAT(refined.r, WithinAbs(0.05, 1e-9));
+
+  /// The matched circle keeps its id, a new one gets a fresh id
+  const auto ids_next = tracker.update({refined, {2.0, 2.0, 0.05}}, {index, index});
+  REQUIRE(ids_next == std::vector<int>{1, 2});
+  REQUIRE(tracker.tracks().size() == 3);
+
+  /// Tracks missed more than once are dropped
+  tracker.update({}, {});
+  REQUIRE(tracker.tracks().size() == 2);
+
+  REQUIRE_THROWS_AS(tracker.update({a}, {}), std::invalid_argument);
+}
+} // namespace turtlelib
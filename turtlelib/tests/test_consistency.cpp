@@ -0,0 +1,72 @@
+#include <catch2/catch_all.hpp>
+
+#include "turtlelib/consistency.hpp"
+
+#define TOLERANCE 1e-10
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test NIS", "[compute_nis]")
+{
+  const std::array<double, 2> dz1{1.0, 2.0};
+  const std::array<double, 4> S1{1.0, 0.0, 0.0, 1.0};
+
+  REQUIRE_THAT(compute_nis(dz1, S1), WithinAbs(5.0, TOLERANCE));
+
+  const std::array<double, 2> dz2{0.3, -0.2};
+  const std::array<double, 4> S2{2.0, 0.5, 0.5, 1.0};
+
+  /// S^-1 = 1 / 1.75 * [1.0 -0.5; -0.5 2.0]
+  const auto expected = (0.09 + 0.06 + 0.08) / 1.75;
+  REQUIRE_THAT(compute_nis(dz2, S2), WithinAbs(expected, TOLERANCE));
+}
+
+TEST_CASE("Test NEES", "[compute_nees]")
+{
+  const std::array<double, 3> e1{0.1, 0.2, -0.3};
+  const std::array<double, 9> P1{
+    0.01, 0.0, 0.0,
+    0.0, 0.04, 0.0,
+    0.0, 0.0, 0.09};
+
+  REQUIRE_THAT(compute_nees(e1, P1), WithinAbs(3.0, TOLERANCE));
+
+  const std::array<double, 3> e2{1.0, 1.0, 1.0};
+  const std::array<double, 9> P2{
+    2.0, 1.0, 0.0,
+    1.0, 2.0, 1.0,
+    0.0, 1.0, 2.0};
+
+  /// P^-1 * [1 1 1] = [0.5 0 0.5]
+  REQUIRE_THAT(compute_nees(e2, P2), WithinAbs(1.0, TOLERANCE));
+}
+
+TEST_CASE("Test rolling statistics", "[RollingStats]")
+{
+  RollingStats stats(3, 2.0);
+
+  REQUIRE(stats.window_count() == 0);
+  REQUIRE_THAT(stats.window_mean(), WithinAbs(0.0, TOLERANCE));
+
+  stats.add(1.0);
+  stats.add(3.0);
+  REQUIRE(stats.window_count() == 2);
+  REQUIRE_THAT(stats.window_mean(), WithinAbs(2.0, TOLERANCE));
+  REQUIRE_THAT(stats.fraction_above(), WithinAbs(0.5, TOLERANCE));
+
+  stats.add(5.0);
+  stats.add(1.0);
+  REQUIRE(stats.window_count() == 3);
+  REQUIRE(stats.total_count() == 4);
+  REQUIRE_THAT(stats.window_mean(), WithinAbs(3.0, TOLERANCE));
+  REQUIRE_THAT(stats.fraction_above(), WithinAbs(2.0 / 3.0, TOLERANCE));
+  REQUIRE_THAT(stats.total_mean(), WithinAbs(2.5, TOLERANCE));
+  REQUIRE_THAT(stats.max(), WithinAbs(5.0, TOLERANCE));
+
+  stats.reset();
+  REQUIRE(stats.window_count() == 0);
+  REQUIRE(stats.total_count() == 0);
+}
+} // namespace turtlelib
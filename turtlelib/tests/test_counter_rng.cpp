@@ -0,0 +1,102 @@
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <vector>
+
+#include "turtlelib/counter_rng.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test Philox known answers", "[CounterRng]")
+{
+  /// The known answer vectors of the Random123 library
+  REQUIRE(
+    philox4x32({0, 0, 0, 0}, {0, 0}) ==
+    PhiloxBlock{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+  REQUIRE(
+    philox4x32({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}) ==
+    PhiloxBlock{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+  REQUIRE(
+    philox4x32({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}) ==
+    PhiloxBlock{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+}
+
+TEST_CASE("Test uniform samples are the Philox lanes", "[CounterRng]")
+{
+  const NoiseKey key{0x0123456789abcdef, 0x0000000500000007, 9};
+  const auto block = philox4x32({3, 9, 7, 5}, {0x89abcdef, 0x01234567});
+
+  double samples[4];
+  fill_uniform(key, 12, 4, samples);
+
+  for (size_t j = 0; j < 4; ++j) {
+    REQUIRE(samples[j] == (static_cast<double>(block[j]) + 0.5) / 4294967296.0);
+  }
+}
+
+TEST_CASE("Test sub ranges give the same samples", "[CounterRng]")
+{
+  const NoiseKey key{42, 3, 1};
+
+  /// Longer than one chunk, so chunk boundaries are crossed
+  std::vector<double> uniform(1001), normal(1001);
+  fill_uniform(key, 0, uniform.size(), uniform.data());
+  fill_normal(key, 0, normal.size(), normal.data());
+
+  for (size_t first : {0, 1, 3, 255, 257, 998}) {
+    for (size_t count : {1, 2, 5, 300}) {
+      if (first + count > uniform.size()) {
+        continue;
+      }
+
+      std::vector<double> part(count);
+      fill_uniform(key, first, count, part.data());
+
+      for (size_t j = 0; j < count; ++j) {
+        REQUIRE(part[j] == uniform[first + j]);
+      }
+
+      fill_normal(key, first, count, part.data());
+
+      for (size_t j = 0; j < count; ++j) {
+        REQUIRE(part[j] == normal[first + j]);
+      }
+    }
+  }
+
+  /// Any change of the key gives other samples
+  for (const auto & other : {NoiseKey{43, 3, 1}, NoiseKey{42, 4, 1}, NoiseKey{42, 3, 2}}) {
+    double sample = 0.0;
+    fill_uniform(other, 0, 1, &sample);
+    REQUIRE(sample != uniform[0]);
+  }
+}
+
+TEST_CASE("Test sample moments", "[CounterRng]")
+{
+  const size_t count = 200000;
+  std::vector<double> uniform(count), normal(count);
+  fill_uniform({5, 0, 0}, 0, count, uniform.data());
+  fill_normal({5, 0, 0}, 0, count, normal.data());
+
+  auto uniform_mean = 0.0, normal_mean = 0.0, normal_var = 0.0;
+  size_t outside = 0;
+
+  for (size_t j = 0; j < count; ++j) {
+    outside += uniform[j] <= 0.0 || uniform[j] >= 1.0;
+    uniform_mean += uniform[j];
+    normal_mean += normal[j];
+    normal_var += normal[j] * normal[j];
+  }
+
+  uniform_mean /= count;
+  normal_mean /= count;
+  normal_var = normal_var / count - normal_mean * normal_mean;
+
+  REQUIRE(outside == 0);
+  REQUIRE_THAT(uniform_mean, WithinAbs(0.5, 0.005));
+  REQUIRE_THAT(normal_mean, WithinAbs(0.0, 0.01));
+  REQUIRE_THAT(normal_var, WithinAbs(1.0, 0.02));
+}
+} // namespace turtlelib
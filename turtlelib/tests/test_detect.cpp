@@ -257,7 +257,7 @@ TEST_CASE("Test Circle Detection", "[detect_circle]")
     {-1.0, 0.0},
     {-0.3, -0.06},
     {0.3, 0.1},
-    {1.0, 1.0}
+    {1.0, 0.0}
   };
 
   CircleDetect detet;
@@ -277,4 +277,163 @@ TEST_CASE("Test Circle Detection", "[detect_circle]")
   REQUIRE_THAT(lm2.r, WithinAbs(22.17979, 1e-4));
   // std::cout << lm1.x << " " << lm1.y << " " << lm1.r << std::endl;
 }
+
+TEST_CASE("Test circle fit far from the origin", "[fit_circle]")
+{
+  /// A third of a small obstacle, as seen by the lidar a few meters away
+  std::vector<Point2D> data;
+  for (int i = 0; i < 12; ++i) {
+    const auto phi = 2.0 + i * 0.18;
+    data.push_back({3.2 + 0.05 * cos(phi), -1.5 + 0.05 * sin(phi)});
+  }
+
+  const Landmark lm = fit_circle(data);
+
+  REQUIRE_THAT(lm.x, WithinAbs(3.2, 1e-8));
+  REQUIRE_THAT(lm.y, WithinAbs(-1.5, 1e-8));
+  REQUIRE_THAT(lm.r, WithinAbs(0.05, 1e-8));
+
+  REQUIRE_THROWS_AS(fit_circle({{0.0, 0.0}, {1.0, 1.0}}), std::invalid_argument);
+}
+
+TEST_CASE("Test inscribed angles", "[inscribed_angles]")
+{
+  /// A half circle sees its diameter at 90 degrees from every point
+  std::vector<double> x, y;
+  for (int i = 0; i <= 10; ++i) {
+    const auto phi = -PI / 2.0 + i * PI / 10.0;
+    x.push_back(1.0 + 0.05 * cos(phi));
+    y.push_back(0.05 * sin(phi));
+  }
+
+  const auto arc = inscribed_angles(x.data(), y.data(), x.size());
+  REQUIRE_THAT(arc.mean, WithinAbs(PI / 2.0, 1e-12));
+  REQUIRE_THAT(arc.stddev, WithinAbs(0.0, 1e-12));
+
+  /// A straight wall is seen at 180 degrees
+  std::vector<double> wall_x{1.0, 1.0, 1.0, 1.0, 1.0};
+  std::vector<double> wall_y{-0.2, -0.1, 0.0, 0.1, 0.2};
+  const auto wall = inscribed_angles(wall_x.data(), wall_y.data(), wall_x.size());
+  REQUIRE_THAT(wall.mean, WithinAbs(PI, 1e-12));
+
+  REQUIRE_THROWS_AS(inscribed_angles(x.data(), y.data(), 2), std::invalid_argument);
+}
+
+TEST_CASE("Test circle classification", "[CircleClassifier]")
+{
+  const CircleClassifier classifier;
+
+  /// The near side of an obstacle
+  std::vector<double> x, y;
+  for (int i = 0; i < 12; ++i) {
+    const auto phi = 2.0 + i * 0.25;
+    x.push_back(1.5 + 0.05 * cos(phi));
+    y.push_back(-0.5 + 0.05 * sin(phi));
+  }
+
+  const auto obstacle = classifier.fit(x.data(), y.data(), x.size());
+  REQUIRE(obstacle.is_circle);
+  REQUIRE_THAT(obstacle.circle.r, WithinAbs(0.05, 1e-8));
+
+  /// A corner of the arena spreads the inscribed angles
+  std::vector<double> corner_x{1.0, 1.0, 1.0, 1.0, 0.9, 0.8, 0.7};
+  std::vector<double> corner_y{0.7, 0.8, 0.9, 1.0, 1.0, 1.0, 1.0};
+  const auto corner = classifier.fit(corner_x.data(), corner_y.data(), corner_x.size());
+  REQUIRE_FALSE(corner.is_circle);
+
+  /// A slightly bent wall passes as an arc but fails the radius gate
+  std::vector<double> bent_x, bent_y;
+  for (int i = 0; i < 12; ++i) {
+    const auto phi = -0.5 + i * 0.09;
+    bent_x.push_back(-1.0 + 2.0 * cos(phi));
+    bent_y.push_back(2.0 * sin(phi));
+  }
+
+  REQUIRE_FALSE(classifier.is_arc(inscribed_angles(bent_x.data(), bent_y.data(), bent_x.size())));
+
+  const CircleClassifier permissive(deg2rad(90.0), PI, 0.15, 0.01, 0.1);
+  const auto bent = permissive.fit(bent_x.data(), bent_y.data(), bent_x.size());
+  REQUIRE_THAT(bent.circle.r, WithinAbs(2.0, 1e-8));
+  REQUIRE_FALSE(bent.is_circle);
+}
+
+TEST_CASE("Test RANSAC circle fit", "[RansacCircleFit]")
+{
+  /// An obstacle next to a wall, in the same cluster
+  std::vector<double> x, y;
+  for (int i = 0; i < 12; ++i) {
+    const auto phi = 2.0 + i * 0.2;
+    x.push_back(1.5 + 0.05 * cos(phi));
+    y.push_back(0.05 * sin(phi));
+  }
+  for (int i = 1; i <= 8; ++i) {
+    x.push_back(1.55);
+    y.push_back(-0.05 - i * 0.03);
+  }
+
+  const auto skewed = fit_circle(x.data(), y.data(), x.size());
+  REQUIRE(std::fabs(skewed.r - 0.05) > 0.01);
+
+  RansacCircleFit ransac(0.005, 200, 0.99);
+  const auto robust = ransac.fit(x.data(), y.data(), x.size(), 3);
+  REQUIRE_THAT(robust.x, WithinAbs(1.5, 1e-8));
+  REQUIRE_THAT(robust.y, WithinAbs(0.0, 1e-8));
+  REQUIRE_THAT(robust.r, WithinAbs(0.05, 1e-8));
+  REQUIRE(ransac.inlier_x().size() >= 12);
+  REQUIRE(ransac.inlier_x().size() <= 13);
+
+  /// The same seed gives the same circle
+  const auto again = ransac.fit(x.data(), y.data(), x.size(), 3);
+  REQUIRE(again.x == robust.x);
+  REQUIRE(again.r == robust.r);
+
+  /// The whole cluster is not an arc, but its consensus set is
+  const CircleClassifier classifier;
+  REQUIRE_FALSE(classifier.fit(x.data(), y.data(), x.size()).is_circle);
+  const auto cluster_fit = classifier.fit(x.data(), y.data(), x.size(), ransac, 3);
+  REQUIRE(cluster_fit.is_circle);
+  REQUIRE_THAT(cluster_fit.circle.r, WithinAbs(0.05, 1e-8));
+
+  REQUIRE_THROWS_AS(ransac.fit(x.data(), y.data(), 2, 0), std::invalid_argument);
+}
+
+TEST_CASE("Test fit quality", "[fit_quality]")
+{
+  /// Two thirds of a circle, every other point pushed out by 1 cm
+  std::vector<double> x, y;
+  for (int i = 0; i <= 20; ++i) {
+    const auto phi = 0.5 + i * (4.0 * PI / 3.0) / 20.0;
+    const auto r = i % 2 == 0 ? 0.05 : 0.06;
+    x.push_back(1.0 + r * cos(phi));
+    y.push_back(-2.0 + r * sin(phi));
+  }
+
+  const auto quality = fit_quality(x.data(), y.data(), x.size(), {1.0, -2.0, 0.05});
+  REQUIRE(quality.num_points == 21);
+  REQUIRE_THAT(quality.residual, WithinAbs(0.01 * std::sqrt(10.0 / 21.0), 1e-12));
+  REQUIRE_THAT(quality.angular_span, WithinAbs(4.0 * PI / 3.0, 1e-12));
+}
+
+TEST_CASE("Test fit quality gate", "[FitQualityGate]")
+{
+  const FitQualityGate gate;
+
+  /// Unknown quality passes unscaled
+  REQUIRE(gate.accept({0.0, 0, 0.0}));
+  REQUIRE_THAT(gate.noise_scale({0.0, 0, 0.0}), WithinAbs(1.0, 1e-12));
+
+  /// A good fit is not inflated
+  REQUIRE(gate.accept({0.005, 10, 2.0}));
+  REQUIRE_THAT(gate.noise_scale({0.005, 10, 2.0}), WithinAbs(1.0, 1e-12));
+
+  /// Twice the reference residual and half the reference span
+  REQUIRE(gate.accept({0.02, 10, PI / 4.0}));
+  REQUIRE_THAT(gate.noise_scale({0.02, 10, PI / 4.0}), WithinAbs(16.0, 1e-9));
+
+  REQUIRE_FALSE(gate.accept({0.03, 10, 2.0}));
+  REQUIRE_FALSE(gate.accept({0.005, 3, 2.0}));
+  REQUIRE_FALSE(gate.accept({0.005, 10, 0.2}));
+
+  REQUIRE_THROWS_AS(FitQualityGate(0.0, 4, 0.3, 0.01, 1.0), std::invalid_argument);
+}
 } /// namespace turtlelib
@@ -0,0 +1,186 @@
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "turtlelib/distance_field.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+namespace
+{
+/// \brief Build a random map with a border wall and scattered occupied cells
+/// \param width The number of columns
+/// \param height The number of rows
+/// \return The map
+OccupancyMap random_map(size_t width, size_t height)
+{
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+  OccupancyMap map;
+  map.width = width;
+  map.height = height;
+  map.resolution = 0.1;
+  map.origin_x = -2.0;
+  map.origin_y = -1.0;
+  map.data.assign(width * height, CELL_FREE);
+
+  for (size_t row = 0; row < height; ++row) {
+    for (size_t col = 0; col < width; ++col) {
+      const auto border = row == 0 || col == 0 || row + 1 == height || col + 1 == width;
+      const auto sample = uniform(generator);
+
+      if (border || sample < 0.02) {
+        map.data[row * width + col] = CELL_OCCUPIED;
+      } else if (sample < 0.05) {
+        map.data[row * width + col] = CELL_UNKNOWN;
+      }
+    }
+  }
+
+  return map;
+}
+} // namespace
+
+TEST_CASE("Test one dimensional distance transform", "[distance_transform_1d]")
+{
+  const auto far = 1e20;
+  const std::vector<double> f{far, 0.0, far, far, far, far, 0.0, far};
+  std::vector<double> d;
+
+  distance_transform_1d(f, d);
+
+  const std::vector<double> expected{1.0, 0.0, 1.0, 4.0, 4.0, 1.0, 0.0, 1.0};
+  REQUIRE(d == expected);
+}
+
+TEST_CASE("Test distance field against brute force", "[DistanceField]")
+{
+  const auto map = random_map(60, 45);
+  const DistanceField field(map);
+
+  REQUIRE(field.width() == 60);
+  REQUIRE(field.height() == 45);
+
+  bool same = true;
+  for (size_t row = 0; row < map.height; ++row) {
+    for (size_t col = 0; col < map.width; ++col) {
+      auto best = std::numeric_limits<double>::infinity();
+
+      for (size_t i = 0; i < map.data.size(); ++i) {
+        if (map.data[i] == CELL_OCCUPIED) {
+          const auto dc = static_cast<double>(i % map.width) - static_cast<double>(col);
+          const auto dr = static_cast<double>(i / map.width) - static_cast<double>(row);
+          best = std::min(best, std::hypot(dc, dr) * map.resolution);
+        }
+      }
+
+      const auto x = map.origin_x + (static_cast<double>(col) + 0.3) * map.resolution;
+      const auto y = map.origin_y + (static_cast<double>(row) + 0.6) * map.resolution;
+      same = same && std::fabs(field.distance(x, y) - best) < 1e-5;
+    }
+  }
+
+  REQUIRE(same);
+  REQUIRE(field.distance(-2.05, 0.0) == std::numeric_limits<double>::infinity());
+  REQUIRE(DistanceField().distance(0.0, 0.0) == std::numeric_limits<double>::infinity());
+}
+
+TEST_CASE("Test distance field raycast against brute force", "[DistanceField]")
+{
+  const auto map = random_map(60, 45);
+  const DistanceField field(map);
+
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<double> angle(-3.14159, 3.14159);
+  std::uniform_real_distribution<double> position(0.0, 1.0);
+
+  bool same = true;
+  size_t hits = 0;
+
+  for (int k = 0; k < 500; ++k) {
+    const auto x = map.origin_x + (0.1 + 0.8 * position(generator)) * 6.0;
+    const auto y = map.origin_y + (0.1 + 0.8 * position(generator)) * 4.5;
+    const auto a = angle(generator);
+    const auto dx = std::cos(a);
+    const auto dy = std::sin(a);
+    const auto max_range = 3.0;
+
+    /// The first occupied cell box along the ray
+    auto expected = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < map.data.size(); ++i) {
+      if (map.data[i] != CELL_OCCUPIED) {
+        continue;
+      }
+
+      const auto min_x = map.origin_x + static_cast<double>(i % map.width) * map.resolution;
+      const auto min_y = map.origin_y + static_cast<double>(i / map.width) * map.resolution;
+      const auto tx0 = (min_x - x) / dx;
+      const auto tx1 = (min_x + map.resolution - x) / dx;
+      const auto ty0 = (min_y - y) / dy;
+      const auto ty1 = (min_y + map.resolution - y) / dy;
+      const auto t_enter = std::max({std::min(tx0, tx1), std::min(ty0, ty1), 0.0});
+      const auto t_leave = std::min(std::max(tx0, tx1), std::max(ty0, ty1));
+
+      if (t_enter <= t_leave) {
+        expected = std::min(expected, t_enter);
+      }
+    }
+
+    if (expected > max_range) {
+      expected = std::numeric_limits<double>::infinity();
+    }
+
+    const auto range = field.raycast(x, y, dx, dy, max_range);
+    hits += range < max_range;
+
+    if (expected == std::numeric_limits<double>::infinity()) {
+      same = same && range == expected;
+    } else {
+      same = same && std::fabs(range - expected) < 1e-5;
+    }
+  }
+
+  REQUIRE(same);
+  REQUIRE(hits > 400);
+}
+
+TEST_CASE("Test distance field raycast from outside the map", "[DistanceField]")
+{
+  OccupancyMap map;
+  map.width = 10;
+  map.height = 10;
+  map.resolution = 0.5;
+  map.data.assign(100, CELL_FREE);
+  map.data[5 * 10 + 4] = CELL_OCCUPIED;
+
+  const DistanceField field(map);
+
+  /// The occupied cell spans x in [2, 2.5] and y in [2.5, 3]
+  REQUIRE_THAT(field.raycast(-1.0, 2.75, 1.0, 0.0, 10.0), WithinAbs(3.0, 1e-5));
+  REQUIRE_THAT(field.raycast(2.25, 10.0, 0.0, -1.0, 10.0), WithinAbs(7.0, 1e-5));
+  REQUIRE(field.raycast(-1.0, 2.75, 1.0, 0.0, 2.5) == std::numeric_limits<double>::infinity());
+  REQUIRE(field.raycast(-1.0, 2.75, -1.0, 0.0, 10.0) == std::numeric_limits<double>::infinity());
+  REQUIRE(field.raycast(2.25, 2.75, 1.0, 0.0, 10.0) == 0.0);
+}
+
+TEST_CASE("Test distance field of a map without occupied cells", "[DistanceField]")
+{
+  OccupancyMap map;
+  map.width = 4;
+  map.height = 3;
+  map.data.assign(12, CELL_UNKNOWN);
+
+  const DistanceField field(map);
+
+  REQUIRE(field.distance(1.5, 1.5) == std::numeric_limits<double>::infinity());
+  REQUIRE(field.raycast(0.5, 0.5, 1.0, 0.0, 10.0) == std::numeric_limits<double>::infinity());
+
+  map.data.pop_back();
+  REQUIRE_THROWS_AS(DistanceField(map), std::invalid_argument);
+}
+} // namespace turtlelib
@@ -0,0 +1,56 @@
+#include <catch2/catch_all.hpp>
+
+#include "turtlelib/ekf_slam.hpp"
+
+#define TOLERANCE 1e-4
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test landmark merge", "[EKF]")
+{
+  EKF ekf(4);
+
+  arma::vec state = ekf.get_state_vec();
+  state.at(3) = 1.0;
+  state.at(4) = 0.0;
+  state.at(5) = 0.0;
+  state.at(6) = 1.0;
+  state.at(7) = 1.2;
+  state.at(8) = 0.1;
+  ekf.update_landmark_pos(state);
+
+  arma::mat Sigma(11, 11, arma::fill::eye);
+  Sigma *= 0.01;
+  Sigma.at(9, 9) = 1e10;
+  Sigma.at(10, 10) = 1e10;
+  ekf.update_covariance(Sigma);
+
+  ekf.merge_landmarks(0, 2);
+
+  const auto landmarks = ekf.get_all_landmarks();
+  REQUIRE(landmarks.size() == 4);
+
+  /// Equal uncertainty, so the merged landmark lies halfway
+  REQUIRE_THAT(landmarks.at(0).x, WithinAbs(1.1, TOLERANCE));
+  REQUIRE_THAT(landmarks.at(0).y, WithinAbs(0.05, TOLERANCE));
+  REQUIRE(landmarks.at(0).uid == 0);
+
+  /// The landmark after the dropped one moves down
+  REQUIRE_THAT(landmarks.at(1).x, WithinAbs(0.0, TOLERANCE));
+  REQUIRE_THAT(landmarks.at(1).y, WithinAbs(1.0, TOLERANCE));
+  REQUIRE(landmarks.at(1).uid == 1);
+  REQUIRE(landmarks.at(2).uid == -1);
+  REQUIRE(landmarks.at(3).uid == -1);
+
+  const auto Sigma_new = ekf.get_covariance_mat();
+  REQUIRE(Sigma_new.n_rows == 11);
+  REQUIRE(Sigma_new.n_cols == 11);
+  REQUIRE_THAT(Sigma_new.at(3, 3), WithinAbs(0.005, TOLERANCE));
+  REQUIRE_THAT(Sigma_new.at(5, 5), WithinAbs(0.01, TOLERANCE));
+  REQUIRE_THAT(Sigma_new.at(7, 7), WithinAbs(1e10, TOLERANCE));
+  REQUIRE_THAT(Sigma_new.at(10, 10), WithinAbs(1e10, TOLERANCE));
+  REQUIRE_THAT(Sigma_new.at(7, 3), WithinAbs(0.0, TOLERANCE));
+}
+} // namespace turtlelib
@@ -0,0 +1,68 @@
+#include <catch2/catch_all.hpp>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "turtlelib/diff_drive.hpp"
+#include "turtlelib/fleet.hpp"
+
+#define TOLERANCE 1e-12
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test fleet against diff drive", "[drive_fleet]")
+{
+  const auto track_width = 0.16;
+  const auto wheel_radius = 0.033;
+
+  std::mt19937 generator(2);
+  std::uniform_real_distribution<double> position(-3.0, 3.0);
+  std::uniform_real_distribution<double> heading(-PI, PI);
+  std::uniform_real_distribution<double> rotation(-0.5, 0.5);
+
+  FleetState fleet;
+  std::vector<DiffDrive> robots;
+
+  for (size_t i = 0; i < 20; ++i) {
+    const auto x = position(generator);
+    const auto y = position(generator);
+    const auto theta = heading(generator);
+
+    REQUIRE(add_robot(fleet, x, y, theta) == i);
+    robots.emplace_back(track_width, wheel_radius);
+    robots.back().update_config(x, y, theta);
+  }
+
+  std::vector<double> delta_left(20), delta_right(20);
+
+  for (int step = 0; step < 50; ++step) {
+    for (size_t i = 0; i < 20; ++i) {
+      delta_left[i] = rotation(generator);
+
+      /// Some robots drive straight
+      delta_right[i] = i % 4 == 0 ? delta_left[i] : rotation(generator);
+
+      robots[i].compute_fk(
+        robots[i].left_wheel() + delta_left[i], robots[i].right_wheel() + delta_right[i]);
+    }
+
+    drive_fleet(fleet, track_width, wheel_radius, delta_left, delta_right);
+  }
+
+  for (size_t i = 0; i < 20; ++i) {
+    REQUIRE_THAT(fleet.x[i], WithinAbs(robots[i].config_x(), TOLERANCE));
+    REQUIRE_THAT(fleet.y[i], WithinAbs(robots[i].config_y(), TOLERANCE));
+    REQUIRE_THAT(
+      normalize_angle(fleet.theta[i] - robots[i].config_theta()), WithinAbs(0.0, TOLERANCE));
+    REQUIRE(fleet.left_wheel[i] == 0.0);
+    REQUIRE(fleet.right_wheel[i] == 0.0);
+  }
+
+  delta_left.pop_back();
+  REQUIRE_THROWS_AS(
+    drive_fleet(fleet, track_width, wheel_radius, delta_left, delta_right),
+    std::invalid_argument);
+}
+} // namespace turtlelib
@@ -0,0 +1,51 @@
+#include <catch2/catch_all.hpp>
+
+#include "turtlelib/loop_closure.hpp"
+
+#define TOLERANCE 1e-10
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test landmark descriptor", "[LoopClosure]")
+{
+  const LoopClosure loop_closure(2, 0.05, 0.3, 3.0);
+  const std::vector<Point2D> landmarks{
+    {0.0, 0.0}, {2.0, 0.0}, {0.0, 1.0}, {0.1, 0.1}, {4.0, 0.0}};
+
+  const auto descriptor = loop_closure.describe(landmarks, 0);
+  REQUIRE(descriptor.size() == 2);
+  REQUIRE_THAT(descriptor.at(0), WithinAbs(1.0, TOLERANCE));
+  REQUIRE_THAT(descriptor.at(1), WithinAbs(2.0, TOLERANCE));
+}
+
+TEST_CASE("Test duplicate landmarks", "[LoopClosure]")
+{
+  LoopClosure loop_closure(2, 0.05, 0.3, 3.0);
+
+  /// The last three landmarks duplicate the first three after a drift of (0.1, 0.08)
+  const std::vector<Point2D> landmarks{
+    {-0.5, -0.7},
+    {0.8, -0.8},
+    {0.4, 0.8},
+    {-1.5, 1.2},
+    {-0.4, -0.62},
+    {0.9, -0.72},
+    {0.5, 0.88}
+  };
+
+  const auto matches = loop_closure.find_duplicates(landmarks);
+  REQUIRE(matches.size() == 3);
+  REQUIRE(matches.at(0).keep == 2);
+  REQUIRE(matches.at(0).drop == 6);
+  REQUIRE(matches.at(1).keep == 1);
+  REQUIRE(matches.at(1).drop == 5);
+  REQUIRE(matches.at(2).keep == 0);
+  REQUIRE(matches.at(2).drop == 4);
+
+  /// A single landmark near another one is not enough evidence
+  const std::vector<Point2D> lonely{{-0.5, -0.7}, {0.8, -0.8}, {0.4, 0.8}, {-0.4, -0.62}};
+  REQUIRE(loop_closure.find_duplicates(lonely).empty());
+}
+} // namespace turtlelib
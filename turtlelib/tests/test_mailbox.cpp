@@ -0,0 +1,59 @@
+#include <catch2/catch_all.hpp>
+#include <memory>
+#include <thread>
+
+#include "turtlelib/mailbox.hpp"
+
+namespace turtlelib
+{
+TEST_CASE("Test latest mailbox", "[LatestMailbox]")
+{
+  LatestMailbox<int> mailbox;
+  REQUIRE(mailbox.empty());
+  REQUIRE_FALSE(mailbox.take());
+
+  REQUIRE_FALSE(mailbox.put(std::make_unique<int>(1)));
+  REQUIRE(mailbox.put(std::make_unique<int>(2)));
+  REQUIRE(mailbox.put(std::make_unique<int>(3)));
+  REQUIRE(mailbox.dropped() == 2);
+
+  /// Only the newest item is delivered
+  const auto item = mailbox.take();
+  REQUIRE(item);
+  REQUIRE(*item == 3);
+  REQUIRE(mailbox.empty());
+
+  /// An item left in the mailbox is deleted with it
+  mailbox.put(std::make_unique<int>(4));
+}
+
+TEST_CASE("Test latest mailbox across threads", "[LatestMailbox]")
+{
+  LatestMailbox<int> mailbox;
+  const int count = 100000;
+
+  std::thread producer([&mailbox]() {
+      for (int i = 1; i <= count; ++i) {
+        mailbox.put(std::make_unique<int>(i));
+      }
+    });
+
+  /// The consumer sees increasing items and ends with the last one
+  int last = 0;
+  uint64_t taken = 0;
+  bool increasing = true;
+
+  while (last != count) {
+    if (const auto item = mailbox.take()) {
+      increasing = increasing && *item > last;
+      last = *item;
+      ++taken;
+    }
+  }
+
+  producer.join();
+
+  REQUIRE(increasing);
+  REQUIRE(taken + mailbox.dropped() == static_cast<uint64_t>(count));
+}
+} // namespace turtlelib
@@ -0,0 +1,88 @@
+#include <catch2/catch_all.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "turtlelib/map_io.hpp"
+
+#define TOLERANCE 1e-12
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test save and load map", "[map_io]")
+{
+  const std::string filename = "test_map_io.map";
+
+  arma::vec state(3 + 2 * 3, arma::fill::zeros);
+  arma::mat covariance(3 + 2 * 3, 3 + 2 * 3, arma::fill::zeros);
+
+  for (size_t i = 0; i < state.n_elem; ++i) {
+    state(i) = 0.5 * i - 1.0;
+
+    for (size_t j = 0; j < state.n_elem; ++j) {
+      covariance(i, j) = 0.01 * i + 0.1 * j;
+    }
+  }
+
+  const SlamMap map_out{Transform2D({1.2, -3.4}, 0.7), {-0.3, 2.5, 1.5}, state, covariance};
+  save_map(filename, map_out);
+
+  const SlamMap map_in = load_map(filename);
+  std::remove(filename.c_str());
+
+  REQUIRE_THAT(map_in.Tmo.translation().x, WithinAbs(1.2, TOLERANCE));
+  REQUIRE_THAT(map_in.Tmo.translation().y, WithinAbs(-3.4, TOLERANCE));
+  REQUIRE_THAT(map_in.Tmo.rotation(), WithinAbs(0.7, TOLERANCE));
+  REQUIRE_THAT(map_in.robot.theta, WithinAbs(-0.3, TOLERANCE));
+  REQUIRE_THAT(map_in.robot.x, WithinAbs(2.5, TOLERANCE));
+  REQUIRE_THAT(map_in.robot.y, WithinAbs(1.5, TOLERANCE));
+
+  REQUIRE(map_in.state.n_elem == state.n_elem);
+  REQUIRE(map_in.covariance.n_rows == covariance.n_rows);
+  REQUIRE(map_in.covariance.n_cols == covariance.n_cols);
+
+  for (size_t i = 0; i < state.n_elem; ++i) {
+    REQUIRE_THAT(map_in.state(i), WithinAbs(state(i), TOLERANCE));
+
+    for (size_t j = 0; j < state.n_elem; ++j) {
+      REQUIRE_THAT(map_in.covariance(i, j), WithinAbs(covariance(i, j), TOLERANCE));
+    }
+  }
+}
+
+TEST_CASE("Test load invalid map", "[map_io]")
+{
+  const std::string filename = "test_map_io_invalid.map";
+
+  std::ofstream file(filename, std::ios::binary);
+  file << "this is not a map file, but it is long enough to hold a header......";
+  file.close();
+
+  REQUIRE_THROWS_AS(load_map(filename), std::runtime_error);
+  std::remove(filename.c_str());
+
+  REQUIRE_THROWS_AS(load_map("does_not_exist.map"), std::runtime_error);
+}
+
+TEST_CASE("Test load map with a corrupt landmark count", "[map_io]")
+{
+  const std::string filename = "test_map_io_corrupt.map";
+
+  /// A consistent header whose covariance size overflows 64 bits
+  MapFileHeader header{};
+  std::memcpy(header.magic, MAP_FILE_MAGIC, sizeof(header.magic));
+  header.version = MAP_FILE_VERSION;
+  header.num_landmarks = 0xFFFFFFFF;
+  header.state_size = 3 + 2 * static_cast<uint64_t>(header.num_landmarks);
+
+  std::ofstream file(filename, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.close();
+
+  REQUIRE_THROWS_AS(load_map(filename), std::runtime_error);
+  std::remove(filename.c_str());
+}
+} // namespace turtlelib
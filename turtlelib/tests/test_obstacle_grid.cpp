@@ -0,0 +1,165 @@
+#include <catch2/catch_all.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "turtlelib/obstacle_grid.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test obstacle grid queries", "[ObstacleGrid]")
+{
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> position(-20.0, 20.0);
+  std::uniform_real_distribution<double> radius(0.02, 0.8);
+
+  Obstacles obstacles;
+  for (int i = 0; i < 2000; ++i) {
+    obstacles.x.push_back(position(generator));
+    obstacles.y.push_back(position(generator));
+    obstacles.r.push_back(radius(generator));
+  }
+
+  const ObstacleGrid grid(obstacles, 0.5);
+  REQUIRE(grid.num_cells() > 1000);
+
+  std::vector<size_t> found;
+  bool same = true;
+
+  for (int k = 0; k < 200; ++k) {
+    const auto x = position(generator) * 1.2;
+    const auto y = position(generator) * 1.2;
+    const auto r = radius(generator) * 4.0;
+
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < obstacles.x.size(); ++i) {
+      if (std::hypot(obstacles.x[i] - x, obstacles.y[i] - y) < r + obstacles.r[i]) {
+        expected.push_back(i);
+      }
+    }
+
+    grid.query(x, y, r, found);
+    same = same && found == expected;
+  }
+
+  REQUIRE(same);
+}
+
+TEST_CASE("Test obstacle grid raycast", "[ObstacleGrid]")
+{
+  std::mt19937 generator(4);
+  std::uniform_real_distribution<double> position(-10.0, 10.0);
+  std::uniform_real_distribution<double> angle(-PI, PI);
+
+  Obstacles obstacles;
+  for (int i = 0; i < 500; ++i) {
+    obstacles.x.push_back(position(generator));
+    obstacles.y.push_back(position(generator));
+    obstacles.r.push_back(0.1);
+  }
+
+  const ObstacleGrid grid(obstacles, 0.7);
+  const auto miss = std::numeric_limits<double>::infinity();
+
+  /// The same ranges as casting against every obstacle, from inside and outside the grid
+  size_t hits = 0;
+  double max_error = 0.0;
+
+  for (int k = 0; k < 2000; ++k) {
+    const auto x = position(generator) * 1.5;
+    const auto y = position(generator) * 1.5;
+    const auto theta = angle(generator);
+    double dx = cos(theta), dy = sin(theta);
+
+    if (k % 100 == 0) {
+      dx = k % 200 == 0 ? 1.0 : 0.0;
+      dy = k % 200 == 0 ? 0.0 : -1.0;
+    }
+
+    Obstacles shifted = obstacles;
+    for (size_t i = 0; i < shifted.x.size(); ++i) {
+      shifted.x[i] -= x;
+      shifted.y[i] -= y;
+    }
+
+    double expected = miss;
+    cast_rays(&dx, &dy, 1, shifted, &expected);
+    expected = expected <= 8.0 ? expected : miss;
+
+    const auto range = grid.raycast(x, y, dx, dy, 8.0);
+
+    if (expected < miss) {
+      ++hits;
+      max_error = std::max(max_error, std::fabs(range - expected));
+    } else {
+      max_error = std::max(max_error, range < miss ? 1.0 : 0.0);
+    }
+  }
+
+  REQUIRE(hits > 100);
+  REQUIRE_THAT(max_error, WithinAbs(0.0, 1e-9));
+
+  const ObstacleGrid empty;
+  REQUIRE(empty.raycast(0.0, 0.0, 1.0, 0.0, 10.0) == miss);
+
+  obstacles.r.pop_back();
+  REQUIRE_THROWS_AS(ObstacleGrid(obstacles, 0.5), std::invalid_argument);
+}
+
+TEST_CASE("Test obstacle grid fan raycast", "[ObstacleGrid]")
+{
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> position(-10.0, 10.0);
+  std::uniform_real_distribution<double> radius(0.02, 0.5);
+
+  Obstacles obstacles;
+  for (int i = 0; i < 500; ++i) {
+    obstacles.x.push_back(position(generator));
+    obstacles.y.push_back(position(generator));
+    obstacles.r.push_back(radius(generator));
+  }
+
+  const ObstacleGrid grid(obstacles, 0.7);
+  const auto miss = std::numeric_limits<double>::infinity();
+
+  const size_t num_rays = 360;
+  std::vector<double> dir_x(num_rays), dir_y(num_rays), ranges(num_rays);
+  for (size_t k = 0; k < num_rays; ++k) {
+    dir_x[k] = cos(2.0 * PI * static_cast<double>(k) / num_rays);
+    dir_y[k] = sin(2.0 * PI * static_cast<double>(k) / num_rays);
+  }
+
+  /// The same ranges as walking the cells of every ray alone
+  size_t hits = 0;
+  double max_error = 0.0;
+
+  for (int k = 0; k < 50; ++k) {
+    const auto x = position(generator) * 1.5;
+    const auto y = position(generator) * 1.5;
+
+    grid.raycast(x, y, dir_x.data(), dir_y.data(), num_rays, 3.5, ranges.data());
+
+    for (size_t j = 0; j < num_rays; ++j) {
+      const auto expected = grid.raycast(x, y, dir_x[j], dir_y[j], 3.5);
+
+      if (expected < miss) {
+        ++hits;
+        max_error = std::max(max_error, std::fabs(ranges[j] - expected));
+      } else {
+        max_error = std::max(max_error, ranges[j] < miss ? 1.0 : 0.0);
+      }
+    }
+  }
+
+  REQUIRE(hits > 1000);
+  REQUIRE_THAT(max_error, WithinAbs(0.0, 1e-9));
+
+  const ObstacleGrid empty;
+  empty.raycast(0.0, 0.0, dir_x.data(), dir_y.data(), num_rays, 10.0, ranges.data());
+  REQUIRE(ranges[0] == miss);
+}
+} // namespace turtlelib
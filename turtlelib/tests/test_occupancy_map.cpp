@@ -0,0 +1,85 @@
+#include <catch2/catch_all.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "turtlelib/occupancy_map.hpp"
+
+#define TOLERANCE 1e-12
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test read plain pgm", "[read_pgm]")
+{
+  /// Top row: occupied, unknown, free. Bottom row: free, free, occupied
+  std::istringstream image("P2\n# a comment\n3 2\n255\n0 128 255\n254 250 10\n");
+
+  const auto map = read_pgm(image, 0.05, -1.0, 2.0);
+
+  REQUIRE(map.width == 3);
+  REQUIRE(map.height == 2);
+  REQUIRE_THAT(map.resolution, WithinAbs(0.05, TOLERANCE));
+  REQUIRE_THAT(map.origin_x, WithinAbs(-1.0, TOLERANCE));
+  REQUIRE_THAT(map.origin_y, WithinAbs(2.0, TOLERANCE));
+
+  const std::vector<int8_t> expected{
+    CELL_FREE, CELL_FREE, CELL_OCCUPIED,
+    CELL_OCCUPIED, CELL_UNKNOWN, CELL_FREE};
+  REQUIRE(map.data == expected);
+
+  std::istringstream negated("P2 3 2 255 0 128 255 254 250 10");
+  const auto inverse = read_pgm(negated, 0.05, 0.0, 0.0, true);
+  REQUIRE(inverse.data.at(0) == CELL_OCCUPIED);
+  REQUIRE(inverse.data.at(3) == CELL_FREE);
+}
+
+TEST_CASE("Test read binary pgm", "[read_pgm]")
+{
+  std::string pixels = {static_cast<char>(0), static_cast<char>(255), static_cast<char>(205),
+    static_cast<char>(255)};
+  std::istringstream image("P5\n2 2\n255\n" + pixels);
+
+  const auto map = read_pgm(image, 1.0, 0.0, 0.0);
+  const std::vector<int8_t> expected{CELL_UNKNOWN, CELL_FREE, CELL_OCCUPIED, CELL_FREE};
+  REQUIRE(map.data == expected);
+
+  std::istringstream truncated("P5\n2 2\n255\n" + pixels.substr(0, 3));
+  REQUIRE_THROWS_AS(read_pgm(truncated, 1.0, 0.0, 0.0), std::runtime_error);
+
+  std::istringstream other("P6\n2 2\n255\n" + pixels);
+  REQUIRE_THROWS_AS(read_pgm(other, 1.0, 0.0, 0.0), std::runtime_error);
+}
+
+TEST_CASE("Test load occupancy map", "[load_occupancy_map]")
+{
+  {
+    std::ofstream image("test_occupancy_map.pgm");
+    image << "P2\n2 1\n255\n0 255\n";
+
+    std::ofstream yaml("test_occupancy_map.yaml");
+    yaml << "image: test_occupancy_map.pgm  # the image\n"
+         << "resolution: 0.1\n"
+         << "origin: [-2.5, 1.5, 0.0]\n"
+         << "negate: 0\n"
+         << "occupied_thresh: 0.65\n"
+         << "free_thresh: 0.196\n";
+  }
+
+  const auto map = load_occupancy_map("test_occupancy_map.yaml");
+
+  REQUIRE(map.width == 2);
+  REQUIRE(map.height == 1);
+  REQUIRE_THAT(map.resolution, WithinAbs(0.1, TOLERANCE));
+  REQUIRE_THAT(map.origin_x, WithinAbs(-2.5, TOLERANCE));
+  REQUIRE_THAT(map.origin_y, WithinAbs(1.5, TOLERANCE));
+  REQUIRE(map.data == std::vector<int8_t>{CELL_OCCUPIED, CELL_FREE});
+
+  std::remove("test_occupancy_map.pgm");
+  std::remove("test_occupancy_map.yaml");
+
+  REQUIRE_THROWS_AS(load_occupancy_map("does_not_exist.yaml"), std::runtime_error);
+}
+} // namespace turtlelib
@@ -0,0 +1,106 @@
+#include <catch2/catch_all.hpp>
+
+#include "turtlelib/pose_ekf.hpp"
+#include "turtlelib/se2d.hpp"
+
+#define TOLERANCE 1e-10
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test landmark association", "[PoseEKF]")
+{
+  PoseEKF ekf(0.1);
+
+  ekf.set_map(
+  {
+    {1.0, 0.0, {0.0, 0.0, 0.0, 0.0}, 0},
+    {1.05, 0.0, {0.0, 0.0, 0.0, 0.0}, 1},
+    {0.199, -1.0, {0.0, 0.0, 0.0, 0.0}, 2}
+  });
+
+  REQUIRE(ekf.associate({1.04, 0.0}) == 1);
+  REQUIRE(ekf.associate({0.98, 0.01}) == 0);
+  REQUIRE(ekf.associate({0.21, -1.0}) == 2);
+  REQUIRE(ekf.associate({0.5, 0.5}) == -1);
+  REQUIRE(ekf.associate({1.2, 0.0}) == -1);
+}
+
+TEST_CASE("Test pose prediction", "[PoseEKF]")
+{
+  PoseEKF ekf(0.1);
+  ekf.reset({0.0, 0.0, 0.0}, {0.1, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0});
+
+  const std::array<double, 9> Q{0.01, 0.0, 0.0, 0.0, 0.01, 0.0, 0.0, 0.0, 0.01};
+  ekf.predict({0.0, 1.0, 0.0}, Q);
+
+  const auto P = ekf.get_covariance();
+  REQUIRE_THAT(P.at(0), WithinAbs(0.11, TOLERANCE));
+  REQUIRE_THAT(P.at(4), WithinAbs(0.01, TOLERANCE));
+  REQUIRE_THAT(P.at(8), WithinAbs(0.11, TOLERANCE));
+  REQUIRE_THAT(P.at(2), WithinAbs(0.1, TOLERANCE));
+  REQUIRE_THAT(P.at(6), WithinAbs(0.1, TOLERANCE));
+  REQUIRE_THAT(P.at(1), WithinAbs(0.0, TOLERANCE));
+  REQUIRE_THAT(ekf.get_robot_state().x, WithinAbs(1.0, TOLERANCE));
+}
+
+TEST_CASE("Test pose correction", "[PoseEKF]")
+{
+  PoseEKF ekf(0.5);
+
+  const std::vector<MapLandmark> landmarks{
+    {1.0, 0.0, {0.0, 0.0, 0.0, 0.0}, 0},
+    {0.0, 1.0, {0.0, 0.0, 0.0, 0.0}, 1},
+    {-1.0, 0.5, {0.0, 0.0, 0.0, 0.0}, 2}
+  };
+  ekf.set_map(landmarks);
+  ekf.reset({0.0, 0.0, 0.0}, {0.01, 0.0, 0.0, 0.0, 0.01, 0.0, 0.0, 0.0, 0.01});
+
+  const Transform2D Tmb_true({0.1, -0.05}, 0.05);
+  const auto Tbm_true = Tmb_true.inv();
+  double trace_prev = 0.03;
+
+  for (int step = 0; step < 20; ++step) {
+    for (size_t i = 0; i < landmarks.size(); ++i) {
+      const auto observation = Tbm_true(Point2D{landmarks.at(i).x, landmarks.at(i).y});
+      const auto innovation = ekf.correct(observation, static_cast<int>(i), 1e-4);
+
+      REQUIRE(innovation.S.at(0) > 1e-4);
+      REQUIRE(innovation.S.at(3) > 1e-4);
+    }
+
+    const auto P = ekf.get_covariance();
+    const auto trace = P.at(0) + P.at(4) + P.at(8);
+    REQUIRE(trace < trace_prev);
+    trace_prev = trace;
+  }
+
+  const auto state = ekf.get_robot_state();
+  REQUIRE_THAT(state.theta, WithinAbs(0.05, 1e-3));
+  REQUIRE_THAT(state.x, WithinAbs(0.1, 1e-3));
+  REQUIRE_THAT(state.y, WithinAbs(-0.05, 1e-3));
+}
+
+TEST_CASE("Test landmark uncertainty inflation", "[PoseEKF]")
+{
+  PoseEKF certain(0.5);
+  PoseEKF uncertain(0.5);
+
+  certain.set_map({{1.0, 0.0, {0.0, 0.0, 0.0, 0.0}, 0}});
+  uncertain.set_map({{1.0, 0.0, {0.04, 0.0, 0.0, 0.04}, 0}});
+
+  const std::array<double, 9> P{0.01, 0.0, 0.0, 0.0, 0.01, 0.0, 0.0, 0.0, 0.01};
+  certain.reset({0.0, 0.0, 0.0}, P);
+  uncertain.reset({0.0, 0.0, 0.0}, P);
+
+  const auto innovation_certain = certain.correct({0.9, 0.0}, 0, 1e-3);
+  const auto innovation_uncertain = uncertain.correct({0.9, 0.0}, 0, 1e-3);
+
+  /// Range variance = x variance + landmark variance + sensor variance
+  REQUIRE_THAT(innovation_certain.S.at(0), WithinAbs(0.011, TOLERANCE));
+  REQUIRE_THAT(innovation_uncertain.S.at(0), WithinAbs(0.051, TOLERANCE));
+  REQUIRE(
+    std::fabs(uncertain.get_robot_state().x) < std::fabs(certain.get_robot_state().x));
+}
+} // namespace turtlelib
@@ -0,0 +1,120 @@
+#include <catch2/catch_all.hpp>
+#include <random>
+
+#include "turtlelib/relocalize.hpp"
+
+#define TOLERANCE 1e-10
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test point alignment", "[align_points]")
+{
+  const Transform2D T({0.5, -1.2}, 2.0);
+  const std::vector<Point2D> from{{0.0, 0.0}, {1.0, 0.0}, {0.3, 0.8}, {-0.4, 0.2}};
+  std::vector<Point2D> to;
+
+  for (const auto & p : from) {
+    to.push_back(T(p));
+  }
+
+  const auto T_est = align_points(from, to);
+  REQUIRE_THAT(T_est.translation().x, WithinAbs(0.5, TOLERANCE));
+  REQUIRE_THAT(T_est.translation().y, WithinAbs(-1.2, TOLERANCE));
+  REQUIRE_THAT(T_est.rotation(), WithinAbs(2.0, TOLERANCE));
+}
+
+TEST_CASE("Test relocalization", "[Relocalizer]")
+{
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> position(-5.0, 5.0);
+  std::normal_distribution<double> noise(0.0, 0.005);
+
+  std::vector<Point2D> landmarks;
+  for (int i = 0; i < 200; ++i) {
+    landmarks.push_back({position(generator), position(generator)});
+  }
+
+  Relocalizer relocalizer(0.05, 1.5);
+  relocalizer.set_map(landmarks);
+  REQUIRE(relocalizer.num_triplets() > 0);
+
+  const Transform2D Tmb_true({1.3, -0.7}, -2.5);
+  const auto Tbm_true = Tmb_true.inv();
+
+  std::vector<Point2D> observations;
+  for (const auto & landmark : landmarks) {
+    const auto pb = Tbm_true(landmark);
+
+    if (std::sqrt(pb.x * pb.x + pb.y * pb.y) < 1.2) {
+      observations.push_back({pb.x + noise(generator), pb.y + noise(generator)});
+    }
+  }
+
+  REQUIRE(observations.size() >= 4);
+
+  /// A spurious circle that is not in the map
+  observations.push_back({0.05, 0.05});
+
+  PoseHypothesis hypothesis;
+  REQUIRE(relocalizer.relocalize(observations, 0.05, 3, hypothesis));
+  REQUIRE(hypothesis.inliers == observations.size() - 1);
+  REQUIRE_THAT(hypothesis.Tmb.translation().x, WithinAbs(1.3, 0.02));
+  REQUIRE_THAT(hypothesis.Tmb.translation().y, WithinAbs(-0.7, 0.02));
+  REQUIRE_THAT(hypothesis.Tmb.rotation(), WithinAbs(-2.5, 0.02));
+}
+
+TEST_CASE("Test relocalization across the rotation wrap", "[Relocalizer]")
+{
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<double> position(-5.0, 5.0);
+  std::normal_distribution<double> noise(0.0, 0.005);
+
+  std::vector<Point2D> landmarks;
+  for (int i = 0; i < 200; ++i) {
+    landmarks.push_back({position(generator), position(generator)});
+  }
+
+  Relocalizer relocalizer(0.05, 1.5, 0.05);
+  relocalizer.set_map(landmarks);
+
+  /// The noisy votes fall on both sides of PI and must share a bin
+  const Transform2D Tmb_true({-0.4, 0.9}, PI - 0.002);
+  const auto Tbm_true = Tmb_true.inv();
+
+  std::vector<Point2D> observations;
+  for (const auto & landmark : landmarks) {
+    const auto pb = Tbm_true(landmark);
+
+    if (std::sqrt(pb.x * pb.x + pb.y * pb.y) < 1.2) {
+      observations.push_back({pb.x + noise(generator), pb.y + noise(generator)});
+    }
+  }
+
+  REQUIRE(observations.size() >= 4);
+
+  PoseHypothesis hypothesis;
+  REQUIRE(relocalizer.relocalize(observations, 0.05, 3, hypothesis));
+  REQUIRE(hypothesis.inliers == observations.size());
+  REQUIRE_THAT(hypothesis.Tmb.translation().x, WithinAbs(-0.4, 0.02));
+  REQUIRE_THAT(hypothesis.Tmb.translation().y, WithinAbs(0.9, 0.02));
+  REQUIRE_THAT(
+    normalize_angle(hypothesis.Tmb.rotation() - Tmb_true.rotation()), WithinAbs(0.0, 0.02));
+}
+
+TEST_CASE("Test relocalization failure", "[Relocalizer]")
+{
+  Relocalizer relocalizer(0.05, 2.0);
+  relocalizer.set_map({{0.0, 0.0}, {1.0, 0.0}, {0.0, 1.5}});
+
+  PoseHypothesis hypothesis;
+
+  /// Too few observations
+  REQUIRE_FALSE(relocalizer.relocalize({{1.0, 0.0}, {0.0, 1.0}}, 0.05, 2, hypothesis));
+
+  /// A triangle that does not exist in the map
+  REQUIRE_FALSE(
+    relocalizer.relocalize({{0.0, 0.0}, {0.5, 0.0}, {0.0, 0.5}}, 0.05, 3, hypothesis));
+}
+} // namespace turtlelib
@@ -0,0 +1,117 @@
+#include <catch2/catch_all.hpp>
+#include <vector>
+
+#include "turtlelib/scan_segment.hpp"
+
+#define TOLERANCE 1e-6
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test scan clusters", "[ScanSegmenter]")
+{
+  /// 36 beams of 10 degrees, two objects and invalid beams elsewhere
+  std::vector<float> ranges(36, 0.0f);
+  for (size_t i = 5; i < 10; ++i) {
+    ranges.at(i) = 1.0f;
+  }
+  for (size_t i = 20; i < 22; ++i) {
+    ranges.at(i) = 1.0f;
+  }
+
+  ScanSegmenter segmenter(0.5, 4);
+  const auto & clusters = segmenter.segment(ranges, 0.0, deg2rad(10.0), 0.1, 3.5);
+
+  /// The two point object is too small
+  REQUIRE(clusters.size() == 1);
+  REQUIRE(clusters.at(0).end - clusters.at(0).begin == 5);
+  REQUIRE(segmenter.x().size() == 7);
+
+  const auto first = clusters.at(0).begin;
+  REQUIRE_THAT(segmenter.x().at(first), WithinAbs(std::cos(deg2rad(50.0)), TOLERANCE));
+  REQUIRE_THAT(segmenter.y().at(first), WithinAbs(std::sin(deg2rad(50.0)), TOLERANCE));
+}
+
+TEST_CASE("Test scan range gaps", "[ScanSegmenter]")
+{
+  /// A jump in range splits the points into two clusters
+  std::vector<float> ranges(36, 0.0f);
+  for (size_t i = 0; i < 12; ++i) {
+    ranges.at(10 + i) = i < 6 ? 1.0f : 2.0f;
+  }
+
+  ScanSegmenter segmenter(0.5, 4);
+  const auto & clusters = segmenter.segment(ranges, 0.0, deg2rad(10.0), 0.1, 3.5);
+
+  REQUIRE(clusters.size() == 2);
+  REQUIRE(clusters.at(0).end - clusters.at(0).begin == 6);
+  REQUIRE(clusters.at(1).end - clusters.at(1).begin == 6);
+}
+
+TEST_CASE("Test scan wrap around", "[ScanSegmenter]")
+{
+  /// An object seen across the end of the scan is one cluster
+  std::vector<float> ranges(36, 0.0f);
+  for (size_t i : {33, 34, 35, 0, 1, 2}) {
+    ranges.at(i) = 1.0f;
+  }
+
+  ScanSegmenter segmenter(0.5, 4);
+  const auto & clusters = segmenter.segment(ranges, 0.0, deg2rad(10.0), 0.1, 3.5);
+
+  REQUIRE(clusters.size() == 1);
+  REQUIRE(clusters.at(0).end - clusters.at(0).begin == 6);
+
+  /// The points are stored in scan order starting from beam 33
+  const auto first = clusters.at(0).begin;
+  REQUIRE_THAT(segmenter.x().at(first), WithinAbs(std::cos(deg2rad(330.0)), TOLERANCE));
+  REQUIRE_THAT(segmenter.y().at(first + 5), WithinAbs(std::sin(deg2rad(20.0)), TOLERANCE));
+
+  /// Every beam valid and close together is a single ring
+  const std::vector<float> ring(36, 1.0f);
+  REQUIRE(segmenter.segment(ring, 0.0, deg2rad(10.0), 0.1, 3.5).size() == 1);
+  REQUIRE(segmenter.clusters().at(0).end == 36);
+
+  const std::vector<float> empty(36, 0.0f);
+  REQUIRE(segmenter.segment(empty, 0.0, deg2rad(10.0), 0.1, 3.5).empty());
+}
+
+TEST_CASE("Test adaptive breakpoints", "[ScanSegmenter]")
+{
+  /// Two near objects 0.2 m apart in range, and a far object
+  std::vector<float> ranges(180, 0.0f);
+  for (size_t i = 10; i < 20; ++i) {
+    ranges.at(i) = 0.4f;
+    ranges.at(i + 10) = 0.6f;
+  }
+  for (size_t i = 90; i < 100; ++i) {
+    ranges.at(i) = 3.0f;
+  }
+
+  /// The fixed distance merges the near objects
+  ScanSegmenter fixed(0.5, 4);
+  REQUIRE(fixed.segment(ranges, 0.0, deg2rad(2.0), 0.1, 3.5).size() == 2);
+
+  /// A fixed distance small enough to split them breaks up the far object, which is dropped
+  ScanSegmenter tight(0.1, 4);
+  REQUIRE(tight.segment(ranges, 0.0, deg2rad(2.0), 0.1, 3.5).size() == 2);
+  for (const auto & cluster : tight.clusters()) {
+    REQUIRE(std::hypot(tight.x().at(cluster.begin), tight.y().at(cluster.begin)) < 1.0);
+  }
+
+  ScanSegmenter adaptive(0.5, 4);
+  adaptive.use_adaptive_threshold(deg2rad(10.0), 0.015);
+  const auto & clusters = adaptive.segment(ranges, 0.0, deg2rad(2.0), 0.1, 3.5);
+
+  REQUIRE(clusters.size() == 3);
+  for (const auto & cluster : clusters) {
+    REQUIRE(cluster.end - cluster.begin == 10);
+  }
+
+  /// The increment must stay below the grazing angle
+  REQUIRE_THROWS_AS(
+    adaptive.segment(ranges, 0.0, deg2rad(12.0), 0.1, 3.5), std::invalid_argument);
+  REQUIRE_THROWS_AS(adaptive.use_adaptive_threshold(0.0, 0.015), std::invalid_argument);
+}
+} // namespace turtlelib
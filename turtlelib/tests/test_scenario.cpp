@@ -0,0 +1,120 @@
+#include <catch2/catch_all.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "turtlelib/scenario.hpp"
+
+#define TOLERANCE 1e-12
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test read scenarios", "[read_scenarios]")
+{
+  std::istringstream description(
+    "# the basic world\n"
+    "param track_width 0.2\n"
+    "arena 20 20\n"
+    "obstacle -0.5 -0.7 0.05   # first obstacle\n"
+    "obstacle 0.8 -0.8 0.05\n"
+    "wall 0 1 2 1\n"
+    "\n"
+    "duration 30\n"
+    "start 1 2 0.5\n"
+    "wheel_cmd 100 120\n"
+    "sweep 10 3 0.1 0.2 0.001\n"
+    "scenario 99 0 0 0\n");
+
+  const auto batch = read_scenarios(description);
+
+  REQUIRE_THAT(batch.params.track_width, WithinAbs(0.2, TOLERANCE));
+  REQUIRE(batch.obstacles.x.size() == 2);
+  REQUIRE_THAT(batch.obstacles.y.at(1), WithinAbs(-0.8, TOLERANCE));
+  REQUIRE(batch.walls.size() == 5);
+  REQUIRE_THAT(batch.duration, WithinAbs(30.0, TOLERANCE));
+  REQUIRE_THAT(batch.y0, WithinAbs(2.0, TOLERANCE));
+  REQUIRE_THAT(batch.right_cmd, WithinAbs(120.0, TOLERANCE));
+  REQUIRE(batch.scenarios.size() == 4);
+  REQUIRE(batch.scenarios.at(0).seed == 10);
+  REQUIRE(batch.scenarios.at(2).seed == 12);
+  REQUIRE_THAT(batch.scenarios.at(2).slip_fraction, WithinAbs(0.2, TOLERANCE));
+  REQUIRE(batch.scenarios.at(3).seed == 99);
+
+  std::istringstream unknown("teleport 1 2 3\n");
+  REQUIRE_THROWS_AS(read_scenarios(unknown), std::runtime_error);
+
+  std::istringstream malformed("obstacle 1 2\n");
+  REQUIRE_THROWS_AS(read_scenarios(malformed), std::runtime_error);
+
+  std::istringstream extra("wheel_cmd 1 2 3\n");
+  REQUIRE_THROWS_AS(read_scenarios(extra), std::runtime_error);
+}
+
+TEST_CASE("Test run scenario", "[run_scenario]")
+{
+  std::istringstream description(
+    "arena 10 10\n"
+    "obstacle 0.0 0.88 0.05\n"
+    "duration 20\n"
+    "wheel_cmd 100 120\n"
+    "scenario 1 0 0 0\n"
+    "scenario 2 0.1 0.1 0.0001\n");
+
+  const auto batch = read_scenarios(description);
+  const auto world = build_world(batch);
+
+  /// Without noise the odometry only drifts by the rounding of the encoders
+  const auto exact = run_scenario(batch, world, batch.scenarios.at(0));
+  REQUIRE(exact.seed == 1);
+  REQUIRE(exact.collisions == 0);
+  REQUIRE(exact.measurements > 0);
+  REQUIRE(exact.final_error < 1e-3);
+  REQUIRE_THAT(exact.sensor_rmse, WithinAbs(0.0, TOLERANCE));
+
+  /// A scenario only depends on its seed
+  const auto noisy1 = run_scenario(batch, world, batch.scenarios.at(1));
+  const auto noisy2 = run_scenario(batch, world, batch.scenarios.at(1));
+  REQUIRE(noisy1.final_error > exact.final_error);
+  REQUIRE(noisy1.sensor_rmse > 0.0);
+  REQUIRE(noisy1.truth[0] == noisy2.truth[0]);
+  REQUIRE(noisy1.odometry[1] == noisy2.odometry[1]);
+  REQUIRE(noisy1.max_error == noisy2.max_error);
+}
+
+TEST_CASE("Test save and load results", "[save_results]")
+{
+  const std::string filename = "test_scenario.bin";
+
+  std::vector<ScenarioResult> results_out(3);
+  for (size_t i = 0; i < results_out.size(); ++i) {
+    results_out[i].seed = static_cast<uint32_t>(i + 5);
+    results_out[i].measurements = 10 * i;
+    results_out[i].truth[2] = 0.5 * i;
+    results_out[i].sensor_rmse = 0.01 * i;
+  }
+
+  save_results(filename, results_out);
+  const auto results_in = load_results(filename);
+  std::remove(filename.c_str());
+
+  REQUIRE(results_in.size() == 3);
+
+  for (size_t i = 0; i < results_in.size(); ++i) {
+    REQUIRE(results_in[i].seed == results_out[i].seed);
+    REQUIRE(results_in[i].measurements == results_out[i].measurements);
+    REQUIRE_THAT(results_in[i].truth[2], WithinAbs(results_out[i].truth[2], TOLERANCE));
+    REQUIRE_THAT(results_in[i].sensor_rmse, WithinAbs(results_out[i].sensor_rmse, TOLERANCE));
+  }
+
+  const std::string invalid = "test_scenario_invalid.bin";
+  std::ofstream file(invalid, std::ios::binary);
+  file << "not a result file, but long enough";
+  file.close();
+
+  REQUIRE_THROWS_AS(load_results(invalid), std::runtime_error);
+  std::remove(invalid.c_str());
+}
+} // namespace turtlelib
@@ -0,0 +1,127 @@
+#include <catch2/catch_all.hpp>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "turtlelib/geometry2d.hpp"
+#include "turtlelib/segment_bvh.hpp"
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test ray segment intersection", "[raycast_segment]")
+{
+  const Segment wall{2.0, -1.0, 2.0, 1.0};
+
+  REQUIRE_THAT(raycast_segment(0.0, 0.0, 1.0, 0.0, wall), WithinAbs(2.0, 1e-12));
+  REQUIRE_THAT(
+    raycast_segment(0.0, 0.0, cos(PI / 8.0), sin(PI / 8.0), wall), WithinAbs(
+      2.0 / cos(PI / 8.0), 1e-12));
+  REQUIRE(std::isinf(raycast_segment(0.0, 0.0, -1.0, 0.0, wall)));
+  REQUIRE(std::isinf(raycast_segment(0.0, 0.0, 0.0, 1.0, wall)));
+  REQUIRE(std::isinf(raycast_segment(0.0, 0.0, cos(PI / 3.0), sin(PI / 3.0), wall)));
+}
+
+TEST_CASE("Test segment BVH raycast", "[SegmentBVH]")
+{
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> position(-15.0, 15.0);
+  std::uniform_real_distribution<double> offset(-1.5, 1.5);
+  std::uniform_real_distribution<double> angle(-PI, PI);
+
+  /// Short walls scattered over the world and the arena around them
+  std::vector<Segment> walls = arena_walls(32.0, 32.0);
+  for (int i = 0; i < 1000; ++i) {
+    const auto x = position(generator);
+    const auto y = position(generator);
+    walls.push_back({x, y, x + offset(generator), y + offset(generator)});
+  }
+
+  const SegmentBVH bvh(walls);
+  REQUIRE(bvh.segments().size() == walls.size());
+  REQUIRE(bvh.num_nodes() > 100);
+
+  size_t hits = 0;
+  bool same = true;
+
+  for (int k = 0; k < 2000; ++k) {
+    const auto x = position(generator);
+    const auto y = position(generator);
+    const auto theta = angle(generator);
+    const auto dx = k % 50 == 0 ? 0.0 : cos(theta);
+    const auto dy = k % 50 == 0 ? 1.0 : sin(theta);
+    const auto max_range = k % 2 == 0 ? 3.5 : 100.0;
+
+    auto expected = std::numeric_limits<double>::infinity();
+    for (const auto & wall : walls) {
+      expected = std::min(expected, raycast_segment(x, y, dx, dy, wall));
+    }
+    expected = expected <= max_range ? expected : std::numeric_limits<double>::infinity();
+
+    const auto range = bvh.raycast(x, y, dx, dy, max_range);
+    hits += range < max_range;
+    same = same && (range == expected || std::fabs(range - expected) < 1e-9);
+  }
+
+  REQUIRE(hits > 1000);
+  REQUIRE(same);
+
+  /// Every ray from inside the arena hits a wall
+  const SegmentBVH arena(arena_walls(4.0, 2.0));
+  REQUIRE_THAT(arena.raycast(0.5, 0.0, 1.0, 0.0, 10.0), WithinAbs(1.5, 1e-12));
+  REQUIRE_THAT(arena.raycast(0.5, 0.0, 0.0, -1.0, 10.0), WithinAbs(1.0, 1e-12));
+  REQUIRE(std::isinf(arena.raycast(0.5, 0.0, 1.0, 0.0, 1.0)));
+
+  REQUIRE(std::isinf(SegmentBVH().raycast(0.0, 0.0, 1.0, 0.0, 10.0)));
+  REQUIRE_THROWS_AS(SegmentBVH(walls, 0), std::invalid_argument);
+}
+
+TEST_CASE("Test segment BVH distance", "[SegmentBVH]")
+{
+  const Segment wall{2.0, -1.0, 2.0, 1.0};
+  REQUIRE_THAT(distance_segment(0.0, 0.5, wall), WithinAbs(2.0, 1e-12));
+  REQUIRE_THAT(distance_segment(5.0, 5.0, wall), WithinAbs(5.0, 1e-12));
+  REQUIRE_THAT(distance_segment(1.0, 1.0, {1.0, 2.0, 1.0, 2.0}), WithinAbs(1.0, 1e-12));
+
+  std::mt19937 generator(6);
+  std::uniform_real_distribution<double> position(-15.0, 15.0);
+  std::uniform_real_distribution<double> offset(-1.5, 1.5);
+
+  std::vector<Segment> walls = arena_walls(32.0, 32.0);
+  for (int i = 0; i < 1000; ++i) {
+    const auto x = position(generator);
+    const auto y = position(generator);
+    walls.push_back({x, y, x + offset(generator), y + offset(generator)});
+  }
+
+  const SegmentBVH bvh(walls);
+
+  /// The same distances as measuring every wall
+  size_t near = 0;
+  bool same = true;
+
+  for (int k = 0; k < 2000; ++k) {
+    const auto x = position(generator);
+    const auto y = position(generator);
+    const auto max_distance = k % 2 == 0 ? 0.2 : 100.0;
+
+    auto expected = std::numeric_limits<double>::infinity();
+    for (const auto & wall : walls) {
+      expected = std::min(expected, distance_segment(x, y, wall));
+    }
+    expected = expected <= max_distance ? expected : std::numeric_limits<double>::infinity();
+
+    const auto distance = bvh.distance(x, y, max_distance);
+    near += distance < 0.2;
+    same = same && (distance == expected || std::fabs(distance - expected) < 1e-9);
+  }
+
+  REQUIRE(near > 100);
+  REQUIRE(same);
+
+  REQUIRE_THAT(SegmentBVH(arena_walls(4.0, 2.0)).distance(0.5, 0.2, 10.0), WithinAbs(0.8, 1e-12));
+  REQUIRE(std::isinf(SegmentBVH().distance(0.0, 0.0, 10.0)));
+}
+} // namespace turtlelib
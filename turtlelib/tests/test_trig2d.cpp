@@ -61,4 +61,39 @@ TEST_CASE("Test find distance", "[distance]") /// Allen Liu
 
   REQUIRE_THAT(find_distance(theta2, obs2), WithinAbs(1.0, TOLERANCE));
 }
+
+TEST_CASE("Test cast rays", "[cast_rays]")
+{
+  Obstacles obstacles;
+  obstacles.x = {2.0, 0.0, -3.0, 0.2};
+  obstacles.y = {0.0, 1.0, 0.0, 0.0};
+  obstacles.r = {1.0, 0.5, 0.5, 0.5};
+
+  const double angles[] = {PI / 6.0, PI / 2.0, PI, -PI / 2.0, PI / 3.0};
+  double dir_x[5], dir_y[5];
+  double ranges[5];
+
+  for (int i = 0; i < 5; ++i) {
+    dir_x[i] = cos(angles[i]);
+    dir_y[i] = sin(angles[i]);
+    ranges[i] = 10.0;
+  }
+
+  cast_rays(dir_x, dir_y, 5, obstacles, ranges);
+
+  /// The same distances as find_distance, the obstacle around the origin is not seen
+  REQUIRE_THAT(ranges[0], WithinAbs(find_distance(PI / 6.0, {2.0, 0.0, 1.0}), TOLERANCE));
+  REQUIRE_THAT(ranges[1], WithinAbs(0.5, TOLERANCE));
+  REQUIRE_THAT(ranges[2], WithinAbs(2.5, TOLERANCE));
+  REQUIRE_THAT(ranges[3], WithinAbs(10.0, TOLERANCE));
+  REQUIRE_THAT(ranges[4], WithinAbs(10.0, TOLERANCE));
+
+  /// A closer range is kept
+  ranges[2] = 1.0;
+  cast_rays(dir_x, dir_y, 5, obstacles, ranges);
+  REQUIRE_THAT(ranges[2], WithinAbs(1.0, TOLERANCE));
+
+  obstacles.r.pop_back();
+  REQUIRE_THROWS_AS(cast_rays(dir_x, dir_y, 5, obstacles, ranges), std::invalid_argument);
+}
 }
@@ -0,0 +1,71 @@
+#include <catch2/catch_all.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "turtlelib/worker_pool.hpp"
+
+namespace turtlelib
+{
+TEST_CASE("Test parallel loop results", "[WorkerPool]")
+{
+  WorkerPool pool(3);
+  REQUIRE(pool.num_workers() == 4);
+
+  /// Reuse the pool for several loops, results land at their own index
+  for (size_t count : {0, 1, 7, 1000}) {
+    std::vector<size_t> squares(count, 0);
+    std::vector<std::atomic<int>> visits(count);
+    std::atomic<bool> worker_in_range{true};
+
+    pool.parallel_for(
+      count, [&](size_t i, size_t worker) {
+        squares.at(i) = i * i;
+        ++visits.at(i);
+
+        if (worker >= pool.num_workers()) {
+          worker_in_range = false;
+        }
+      });
+
+    REQUIRE(worker_in_range);
+    for (size_t i = 0; i < count; ++i) {
+      REQUIRE(squares.at(i) == i * i);
+      REQUIRE(visits.at(i) == 1);
+    }
+  }
+}
+
+TEST_CASE("Test parallel loop on the calling thread", "[WorkerPool]")
+{
+  WorkerPool pool(0);
+  REQUIRE(pool.num_workers() == 1);
+
+  size_t sum = 0;
+  pool.parallel_for(10, [&sum](size_t i, size_t worker) {sum += i + worker;});
+  REQUIRE(sum == 45);
+}
+
+TEST_CASE("Test parallel loop exceptions", "[WorkerPool]")
+{
+  WorkerPool pool(2);
+  std::atomic<int> calls{0};
+
+  REQUIRE_THROWS_AS(
+    pool.parallel_for(
+      50, [&calls](size_t i, size_t) {
+        ++calls;
+        if (i == 17) {
+          throw std::runtime_error("fit failed");
+        }
+      }),
+    std::runtime_error);
+
+  /// The other indices still run and the pool stays usable
+  REQUIRE(calls == 50);
+
+  std::atomic<int> after{0};
+  pool.parallel_for(5, [&after](size_t, size_t) {++after;});
+  REQUIRE(after == 5);
+}
+} // namespace turtlelib
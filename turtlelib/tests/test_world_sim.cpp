@@ -0,0 +1,252 @@
+#include <catch2/catch_all.hpp>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "turtlelib/world_sim.hpp"
+
+#define TOLERANCE 1e-12
+
+using Catch::Matchers::WithinAbs;
+
+namespace turtlelib
+{
+TEST_CASE("Test noise free world sim against fleet", "[WorldSim]")
+{
+  SimParams params;
+  params.basic_sensor_variance = 0.0;
+  WorldSim sim(params, std::make_shared<World>(), 3);
+
+  FleetState fleet;
+
+  for (size_t i = 0; i < 3; ++i) {
+    REQUIRE(sim.add_robot(0.5 * i, -0.2 * i, 0.3 * i) == i);
+    add_robot(fleet, 0.5 * i, -0.2 * i, 0.3 * i);
+  }
+
+  const std::vector<double> left_cmd{100.0, -50.0, 80.0};
+  const std::vector<double> right_cmd{120.0, 50.0, 80.0};
+  std::vector<double> delta_left(3), delta_right(3);
+
+  for (size_t i = 0; i < 3; ++i) {
+    delta_left[i] = left_cmd[i] * params.motor_cmd_per_rad_sec * params.period;
+    delta_right[i] = right_cmd[i] * params.motor_cmd_per_rad_sec * params.period;
+  }
+
+  for (int step = 0; step < 100; ++step) {
+    sim.step(left_cmd, right_cmd);
+    drive_fleet(fleet, params.track_width, params.wheel_radius, delta_left, delta_right);
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    REQUIRE_THAT(sim.fleet().x[i], WithinAbs(fleet.x[i], TOLERANCE));
+    REQUIRE_THAT(sim.fleet().y[i], WithinAbs(fleet.y[i], TOLERANCE));
+    REQUIRE_THAT(sim.fleet().theta[i], WithinAbs(fleet.theta[i], TOLERANCE));
+    REQUIRE_THAT(sim.fleet().left_wheel[i], WithinAbs(100.0 * delta_left[i], 1e-9));
+    REQUIRE(
+      sim.left_encoder(i) ==
+      static_cast<int32_t>(sim.fleet().left_wheel[i] * params.encoder_ticks_per_rad));
+  }
+
+  REQUIRE(sim.collisions() == 0);
+  REQUIRE(sim.tick() == 100);
+  REQUIRE_THROWS_AS(sim.step({1.0}, {1.0}), std::invalid_argument);
+}
+
+TEST_CASE("Test world sim is reproducible for a seed", "[WorldSim]")
+{
+  SimParams params;
+  params.input_noice = 0.1;
+  params.slip_fraction = 0.1;
+
+  WorldSim sim1(params, std::make_shared<World>(), 7);
+  WorldSim sim2(params, std::make_shared<World>(), 7);
+  sim1.add_robot(0.0, 0.0, 0.0);
+  sim2.add_robot(0.0, 0.0, 0.0);
+
+  for (int step = 0; step < 200; ++step) {
+    sim1.step({100.0}, {90.0});
+    sim2.step({100.0}, {90.0});
+  }
+
+  REQUIRE(sim1.fleet().x[0] == sim2.fleet().x[0]);
+  REQUIRE(sim1.fleet().y[0] == sim2.fleet().y[0]);
+  REQUIRE(sim1.fleet().theta[0] == sim2.fleet().theta[0]);
+  REQUIRE(sim1.left_encoder(0) == sim2.left_encoder(0));
+}
+
+TEST_CASE("Test world sim collision", "[WorldSim]")
+{
+  auto world = std::make_shared<World>();
+  world->obstacles = ObstacleGrid({{0.5}, {0.0}, {0.05}}, 0.5);
+
+  WorldSim sim(SimParams{}, world, 1);
+  sim.add_robot(0.0, 0.0, 0.0);
+
+  for (int step = 0; step < 500; ++step) {
+    sim.step({200.0}, {200.0});
+  }
+
+  /// The robot stops where its collision radius first touches the obstacle
+  REQUIRE(sim.collisions() > 0);
+  REQUIRE(sim.fleet().x[0] <= 0.5 - 0.25);
+  REQUIRE(sim.fleet().x[0] > 0.5 - 0.25 - 0.02);
+  REQUIRE_THAT(sim.fleet().theta[0], WithinAbs(0.0, TOLERANCE));
+}
+
+TEST_CASE("Test world sim wall collision", "[WorldSim]")
+{
+  auto world = std::make_shared<World>();
+  world->walls = SegmentBVH({{0.5, -1.0, 0.5, 1.0}});
+
+  WorldSim sim(SimParams{}, world, 1);
+  sim.add_robot(0.0, 0.0, 0.0);
+
+  for (int step = 0; step < 500; ++step) {
+    sim.step({200.0}, {200.0});
+  }
+
+  /// The robot stops where its collision radius first touches the wall
+  REQUIRE(sim.collisions() > 0);
+  REQUIRE(sim.fleet().x[0] <= 0.5 - 0.2);
+  REQUIRE(sim.fleet().x[0] > 0.5 - 0.2 - 0.02);
+}
+
+TEST_CASE("Test world sim fake sensor", "[WorldSim]")
+{
+  auto world = std::make_shared<World>();
+  world->obstacles = ObstacleGrid({{1.0, 3.0, -0.5}, {0.0, 0.0, 1.0}, {0.05, 0.05, 0.05}}, 0.5);
+
+  SimParams params;
+  params.basic_sensor_variance = 0.0;
+  WorldSim sim(params, world, 1);
+  sim.add_robot(0.0, 0.0, 0.0);
+
+  std::vector<Point2D> positions;
+  std::vector<size_t> indices;
+  sim.sense_obstacles(0, positions, indices);
+
+  REQUIRE(indices == std::vector<size_t>{0, 2});
+  REQUIRE_THAT(positions.at(0).x, WithinAbs(1.0, TOLERANCE));
+  REQUIRE_THAT(positions.at(0).y, WithinAbs(0.0, TOLERANCE));
+  REQUIRE_THAT(positions.at(1).x, WithinAbs(-0.5, TOLERANCE));
+  REQUIRE_THAT(positions.at(1).y, WithinAbs(1.0, TOLERANCE));
+}
+
+TEST_CASE("Test world sim lidar", "[WorldSim]")
+{
+  auto world = std::make_shared<World>();
+  world->walls = SegmentBVH(arena_walls(4.0, 4.0));
+
+  SimParams params;
+  params.lidar_accuracy = 0.0;
+  params.lidar_resolution = PI / 180.0;
+  WorldSim sim(params, world, 1);
+  sim.add_robot(0.0, 0.0, 0.0);
+
+  std::vector<float> ranges;
+  sim.scan(0, ranges);
+
+  /// The lidar sits 3.2 cm behind the center of the robot
+  REQUIRE(ranges.size() == 360);
+  REQUIRE(sim.num_beams() == 360);
+  REQUIRE_THAT(ranges.at(0), WithinAbs(2.0 - 0.032, 1e-5));
+  REQUIRE_THAT(ranges.at(180), WithinAbs(2.0 + 0.032, 1e-5));
+  REQUIRE_THAT(ranges.at(270), WithinAbs(2.0, 1e-5));
+}
+
+TEST_CASE("Test world sim noise does not depend on the draw order", "[WorldSim]")
+{
+  auto world = std::make_shared<World>();
+  world->walls = SegmentBVH(arena_walls(4.0, 4.0));
+  world->obstacles = ObstacleGrid({{1.0, -0.5}, {0.0, 1.0}, {0.05, 0.05}}, 0.5);
+
+  SimParams params;
+  params.basic_sensor_variance = 0.01;
+
+  WorldSim sim1(params, world, 11);
+  WorldSim sim2(params, world, 11);
+
+  for (auto * sim : {&sim1, &sim2}) {
+    sim->add_robot(0.0, 0.0, 0.0);
+    sim->add_robot(0.0, 0.0, 0.0);
+  }
+
+  /// The robots and the sensors are visited in opposite orders
+  std::vector<float> ranges1, ranges2;
+  std::vector<Point2D> positions1, positions2;
+  std::vector<size_t> indices1, indices2;
+
+  sim1.scan(0, ranges1);
+  sim1.sense_obstacles(1, positions1, indices1);
+
+  sim2.sense_obstacles(1, positions2, indices2);
+  sim2.scan(1, ranges2);
+  sim2.scan(0, ranges2);
+
+  REQUIRE(ranges1 == ranges2);
+  REQUIRE(indices1 == indices2);
+  REQUIRE(positions1.at(0).x == positions2.at(0).x);
+  REQUIRE(positions1.at(1).y == positions2.at(1).y);
+
+  /// Both robots sit at the same pose but draw their own noise
+  sim2.scan(1, ranges2);
+  REQUIRE(ranges1 != ranges2);
+
+  /// The next tick draws new noise
+  sim1.step({0.0, 0.0}, {0.0, 0.0});
+  sim1.scan(0, ranges2);
+  REQUIRE(ranges1 != ranges2);
+}
+
+TEST_CASE("Test world sim restored from a snapshot senses the same", "[WorldSim]")
+{
+  auto world = std::make_shared<World>();
+  world->walls = SegmentBVH(arena_walls(4.0, 4.0));
+  world->obstacles = ObstacleGrid({{1.0, -0.5}, {0.0, 1.0}, {0.05, 0.05}}, 0.5);
+
+  SimParams params;
+  params.input_noice = 0.1;
+  params.basic_sensor_variance = 0.01;
+
+  WorldSim sim(params, world, 5);
+  sim.add_robot(0.0, 0.0, 0.0);
+  sim.add_robot(0.2, -0.3, 1.0);
+
+  /// The sensing copy starts without robots, like one made before they were added
+  WorldSim sensors(params, world, 5);
+
+  for (int step = 0; step < 30; ++step) {
+    sim.step({100.0, 50.0}, {120.0, -50.0});
+  }
+
+  sensors.restore(sim.snapshot());
+  REQUIRE(sensors.tick() == 30);
+  REQUIRE(sensors.fleet().x == sim.fleet().x);
+  REQUIRE(sensors.fleet().theta == sim.fleet().theta);
+
+  for (size_t i = 0; i < 2; ++i) {
+    std::vector<float> ranges1, ranges2;
+    sim.scan(i, ranges1);
+    sensors.scan(i, ranges2);
+    REQUIRE(ranges1 == ranges2);
+
+    std::vector<Point2D> positions1, positions2;
+    std::vector<size_t> indices1, indices2;
+    sim.sense_obstacles(i, positions1, indices1);
+    sensors.sense_obstacles(i, positions2, indices2);
+    REQUIRE(indices1 == indices2);
+
+    for (size_t k = 0; k < indices1.size(); ++k) {
+      REQUIRE(positions1.at(k).x == positions2.at(k).x);
+      REQUIRE(positions1.at(k).y == positions2.at(k).y);
+    }
+  }
+
+  /// The restored copy steps on like the simulation
+  sim.step({100.0, 50.0}, {120.0, -50.0});
+  sensors.step({100.0, 50.0}, {120.0, -50.0});
+  REQUIRE(sensors.fleet().x == sim.fleet().x);
+  REQUIRE(sensors.left_encoder(1) == sim.left_encoder(1));
+}
+} // namespace turtlelib